@@ -0,0 +1,890 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <type_traits>
+#include <utility>
+#include <memory>
+#include <optional>
+#include <array>
+#include <string>
+#include <string_view>
+#include <span>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <print>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+export module backend.bc_cache;
+
+import runtime.value;
+import runtime.object;
+import runtime.strings;
+import runtime.callables;
+import runtime.bytecode;
+
+namespace DerkJS::Backend {
+    /// NOTE: Bump this upon any change to the cache layout, the opcodes, or what the compiler puts into the heap.
+    export constexpr uint16_t bc_cache_version = 3;
+
+    constexpr std::array<char, 4> bc_cache_magic = {'D', 'J', 'S', 'C'};
+    constexpr std::array<char, 4> prelude_snapshot_magic = {'D', 'J', 'S', 'S'};
+
+    static_assert(std::is_trivially_copyable_v<Instruction>, "Cached bytecode is copied as raw bytes.");
+    static_assert(std::is_trivially_copyable_v<ExceptionRange>, "Cached handler tables are copied as raw bytes.");
+
+    /// NOTE: The only heap item types the compiler creates after the native preloads: string constants, dud `prototype` objects, and functions.
+    enum class CachedItemKind : uint8_t {
+        string,
+        object,
+        lambda
+    };
+
+    struct CacheHeader {
+        std::array<char, 4> magic;
+        uint16_t version;
+        uint16_t opcode_count;
+        uint16_t instruction_size;
+        uint16_t builtin_count;
+        int32_t preload_item_count;
+        int32_t item_count;
+        uint32_t const_count;
+        uint32_t code_length;
+        uint32_t offset_count;
+        int16_t entry_func_id;
+        int16_t prop_cache_count;
+    };
+
+    struct CachedValue {
+        int64_t payload; // i32 / boolean / f64 bits, or a heap slot ID for objects
+        ValueTag tag;
+        uint8_t flags;
+    };
+
+    /// NOTE: Bytes of one stored `CachedValue`, whose fields are written unpadded.
+    constexpr std::size_t cached_value_length = sizeof(CachedValue::payload) + sizeof(CachedValue::tag) + sizeof(CachedValue::flags);
+
+    struct CachedItem {
+        int32_t prototype_id;
+        int32_t instance_prototype_id; // lambdas only
+        int32_t length_key_id; // strings & lambdas: key of the "length" property made by their constructors
+        int32_t arity; // lambdas only
+        uint32_t data_length; // string bytes or lambda instruction count
+        CachedItemKind kind;
+    };
+
+    /// NOTE: Fields are written one by one, so no struct padding reaches the file.
+    class CacheWriter {
+    private:
+        std::string m_buffer;
+
+    public:
+        CacheWriter()
+        : m_buffer {} {}
+
+        template <typename ... Fields> requires (std::is_trivially_copyable_v<Fields> && ...)
+        void put(const Fields& ... fields) {
+            (m_buffer.append(reinterpret_cast<const char*>(&fields), sizeof(Fields)), ...);
+        }
+
+        void put_bytes(const void* data_p, std::size_t length) {
+            m_buffer.append(static_cast<const char*>(data_p), length);
+        }
+
+        [[nodiscard]] auto view() const noexcept -> std::string_view {
+            return m_buffer;
+        }
+
+        [[nodiscard]] auto to_bytes() const -> std::vector<std::byte> {
+            const auto bytes = std::as_bytes(std::span {m_buffer});
+
+            return {bytes.begin(), bytes.end()};
+        }
+    };
+
+    /// NOTE: Bounds-checked reads from the mapped file. Everything is copied out by `memcpy`, so the mapping needs no alignment.
+    class CacheReader {
+    private:
+        std::span<const std::byte> m_bytes;
+        std::size_t m_pos;
+
+    public:
+        explicit CacheReader(std::span<const std::byte> bytes) noexcept
+        : m_bytes {bytes}, m_pos {0} {}
+
+        [[nodiscard]] auto take_bytes(void* out_p, std::size_t length) noexcept -> bool {
+            if (length > m_bytes.size() - m_pos) {
+                return false;
+            }
+
+            std::memcpy(out_p, m_bytes.data() + m_pos, length);
+            m_pos += length;
+
+            return true;
+        }
+
+        template <typename ... Fields> requires (std::is_trivially_copyable_v<Fields> && ...)
+        [[nodiscard]] auto take(Fields& ... fields) noexcept -> bool {
+            return (take_bytes(&fields, sizeof(Fields)) && ...);
+        }
+
+        [[nodiscard]] auto at_end() const noexcept -> bool {
+            return m_pos == m_bytes.size();
+        }
+
+        [[nodiscard]] auto remaining() const noexcept -> std::size_t {
+            return m_bytes.size() - m_pos;
+        }
+
+        /// NOTE: Checks a stored count against the bytes left before anything is sized by it, so corrupt counts get rejected instead of allocating huge buffers.
+        [[nodiscard]] auto has_room_for(std::size_t count, std::size_t element_length) const noexcept -> bool {
+            return count <= remaining() / element_length;
+        }
+    };
+
+    /**
+     * @brief Compiler state after the prelude's two top-level passes, which a prelude snapshot stores along with its heap & constants. The script's own passes later continue from this state.
+     */
+    export struct PreludeSnapshot {
+        std::vector<std::pair<std::string, Arg>> global_symbols;
+        std::vector<std::pair<std::string, Arg>> key_symbols;
+        std::vector<std::pair<std::string, Arg>> top_level_locals;
+        std::vector<bool> captured_key_ids;
+        std::vector<Instruction> prepass_code; // hoisted top-level vars
+        std::vector<Instruction> main_code; // the rest of the top-level code, without the implicit return
+        std::vector<ExceptionRange> main_handlers; // relative to the start of `main_code`
+        int next_local_id;
+    };
+
+    using HeapIdMap = std::unordered_map<const ObjectBase<Value>*, int32_t>;
+
+    /// NOTE: Gives -1 for null references, or nothing for pointers outside the heap.
+    [[nodiscard]] auto heap_id_of(const HeapIdMap& heap_ids, const ObjectBase<Value>* object_p) -> std::optional<int32_t> {
+        if (!object_p) {
+            return -1;
+        } else if (auto id_it = heap_ids.find(object_p); id_it != heap_ids.end()) {
+            return id_it->second;
+        }
+
+        return {};
+    }
+
+    /// NOTE: Gives `nullptr` for ID -1, or nothing for an ID that is out of range or not restored yet.
+    [[nodiscard]] auto resolve_heap_id(PolyPool<ObjectBase<Value>>& heap, int64_t id) -> std::optional<ObjectBase<Value>*> {
+        if (id == -1) {
+            return nullptr;
+        } else if (id < 0 || id >= heap.get_used_extent()) {
+            return {};
+        } else if (auto item_p = heap.get_item(static_cast<int>(id)); item_p) {
+            return item_p;
+        }
+
+        return {};
+    }
+
+    [[nodiscard]] auto encode_value(const HeapIdMap& heap_ids, Value value) -> std::optional<CachedValue> {
+        CachedValue entry {
+            .payload = 0,
+            .tag = value.get_tag(),
+            .flags = value.flags()
+        };
+
+        switch (entry.tag) {
+        case ValueTag::undefined:
+        case ValueTag::null:
+        case ValueTag::num_nan:
+        case ValueTag::proto_key:
+            break;
+        case ValueTag::boolean:
+            entry.payload = value.to_boolean() ? 1 : 0;
+            break;
+        case ValueTag::num_i32:
+            entry.payload = value.as_i32_unchecked();
+            break;
+        case ValueTag::num_f64:
+            entry.payload = std::bit_cast<int64_t>(value.as_f64_unchecked());
+            break;
+        case ValueTag::object:
+            if (const auto object_id = heap_id_of(heap_ids, value.to_object()); object_id) {
+                entry.payload = *object_id;
+                break;
+            }
+
+            return {};
+        default:
+            //? NOTE: Value references only exist at runtime.
+            return {};
+        }
+
+        return entry;
+    }
+
+    [[nodiscard]] auto decode_value(PolyPool<ObjectBase<Value>>& heap, const CachedValue& entry) -> std::optional<Value> {
+        switch (entry.tag) {
+        case ValueTag::undefined: return Value {JSUndefOpt {}, entry.flags};
+        case ValueTag::null: return Value {JSNullOpt {}, entry.flags};
+        case ValueTag::num_nan: return Value {JSNaNOpt {}, entry.flags};
+        case ValueTag::proto_key: return Value {JSProtoKeyOpt {}, entry.flags};
+        case ValueTag::boolean: return Value {entry.payload != 0, entry.flags};
+        case ValueTag::num_i32: return Value {static_cast<int>(entry.payload), entry.flags};
+        case ValueTag::num_f64: return Value {std::bit_cast<double>(entry.payload), entry.flags};
+        case ValueTag::object:
+            if (const auto object_p = resolve_heap_id(heap, entry.payload); object_p && *object_p) {
+                return Value {*object_p, entry.flags};
+            }
+
+            return {};
+        default:
+            return {};
+        }
+    }
+
+    [[nodiscard]] auto put_value(CacheWriter& writer, const HeapIdMap& heap_ids, const Value& value) -> bool {
+        if (const auto entry = encode_value(heap_ids, value); entry) {
+            writer.put(entry->payload, entry->tag, entry->flags);
+            return true;
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] auto take_value(CacheReader& reader, PolyPool<ObjectBase<Value>>& heap) -> std::optional<Value> {
+        CachedValue entry {};
+
+        if (!reader.take(entry.payload, entry.tag, entry.flags)) {
+            return {};
+        }
+
+        return decode_value(heap, entry);
+    }
+
+    [[nodiscard]] auto length_key_id_of(const HeapIdMap& heap_ids, ObjectBase<Value>* item_p) -> std::optional<int32_t> {
+        //? NOTE: Compiled strings & functions only own the "length" property from their constructors, which restoring rebuilds.
+        if (auto& own_props = item_p->get_own_prop_pool(); own_props.size() == 1) {
+            auto length_key = own_props.front().key;
+
+            return heap_id_of(heap_ids, length_key.to_object());
+        }
+
+        return {};
+    }
+
+    void put_handlers(CacheWriter& writer, std::span<const ExceptionRange> handlers) {
+        writer.put(static_cast<uint32_t>(handlers.size()));
+        writer.put_bytes(handlers.data(), handlers.size() * sizeof(ExceptionRange));
+    }
+
+    [[nodiscard]] auto take_handlers(CacheReader& reader, std::vector<ExceptionRange>& handlers) -> bool {
+        uint32_t handler_count = 0;
+
+        if (!reader.take(handler_count) || !reader.has_room_for(handler_count, sizeof(ExceptionRange))) {
+            return false;
+        }
+
+        handlers.resize(handler_count);
+
+        return reader.take_bytes(handlers.data(), handlers.size() * sizeof(ExceptionRange));
+    }
+
+    [[nodiscard]] auto put_item(CacheWriter& writer, const HeapIdMap& heap_ids, ObjectBase<Value>* item_p) -> bool {
+        const auto prototype_id = heap_id_of(heap_ids, item_p->get_prototype());
+        std::optional<int32_t> instance_prototype_id = -1;
+        std::optional<int32_t> length_key_id = -1;
+        CachedItem entry {};
+        const void* data_p = nullptr;
+
+        if (auto string_p = dynamic_cast<DynamicString*>(item_p); string_p) {
+            const auto text = string_p->as_str_view();
+
+            length_key_id = length_key_id_of(heap_ids, item_p);
+            entry.kind = CachedItemKind::string;
+            entry.data_length = text.length();
+            data_p = text.data();
+        } else if (auto lambda_p = dynamic_cast<Lambda*>(item_p); lambda_p) {
+            const auto code = lambda_p->view_code();
+
+            instance_prototype_id = heap_id_of(heap_ids, item_p->get_instance_prototype());
+            length_key_id = length_key_id_of(heap_ids, item_p);
+            entry.kind = CachedItemKind::lambda;
+            entry.arity = lambda_p->min_arity();
+            entry.data_length = code.size();
+            data_p = code.data();
+        } else if (auto object_p = dynamic_cast<Object*>(item_p); object_p && object_p->get_own_prop_pool().empty()) {
+            entry.kind = CachedItemKind::object;
+        } else {
+            return false;
+        }
+
+        if (!prototype_id || !instance_prototype_id || !length_key_id) {
+            return false;
+        }
+
+        entry.prototype_id = *prototype_id;
+        entry.instance_prototype_id = *instance_prototype_id;
+        entry.length_key_id = *length_key_id;
+
+        writer.put(entry.kind, entry.prototype_id, entry.instance_prototype_id, entry.length_key_id, entry.arity, entry.data_length);
+
+        if (entry.kind == CachedItemKind::lambda) {
+            writer.put_bytes(data_p, entry.data_length * sizeof(Instruction));
+            put_handlers(writer, dynamic_cast<Lambda*>(item_p)->view_handlers());
+        } else if (entry.kind == CachedItemKind::string) {
+            writer.put_bytes(data_p, entry.data_length);
+        }
+
+        return true;
+    }
+
+    /// NOTE: Restored items must land in their original slots, so prototypes & "length" keys can only refer back to earlier items.
+    [[nodiscard]] auto take_item(CacheReader& reader, PolyPool<ObjectBase<Value>>& heap) -> bool {
+        CachedItem entry {};
+
+        if (!reader.take(entry.kind, entry.prototype_id, entry.instance_prototype_id, entry.length_key_id, entry.arity, entry.data_length)) {
+            return false;
+        }
+
+        const auto prototype_p = resolve_heap_id(heap, entry.prototype_id);
+        const auto instance_prototype_p = resolve_heap_id(heap, entry.instance_prototype_id);
+        const auto length_key_p = resolve_heap_id(heap, entry.length_key_id);
+
+        if (!prototype_p || !instance_prototype_p || !length_key_p) {
+            return false;
+        }
+
+        switch (entry.kind) {
+        case CachedItemKind::string: {
+            if (!reader.has_room_for(entry.data_length, sizeof(char))) {
+                return false;
+            }
+
+            std::string text (entry.data_length, '\0');
+
+            if (!reader.take_bytes(text.data(), text.length())) {
+                return false;
+            }
+
+            return heap.add_item(heap.get_next_id(), std::make_unique<DynamicString>(*prototype_p, Value {*length_key_p}, std::move(text))) != nullptr;
+        }
+        case CachedItemKind::object:
+            return heap.add_item(heap.get_next_id(), std::make_unique<Object>(*prototype_p)) != nullptr;
+        case CachedItemKind::lambda: {
+            if (!reader.has_room_for(entry.data_length, sizeof(Instruction))) {
+                return false;
+            }
+
+            std::vector<Instruction> code (entry.data_length);
+            std::vector<ExceptionRange> handlers;
+
+            if (!reader.take_bytes(code.data(), code.size() * sizeof(Instruction)) || !take_handlers(reader, handlers)) {
+                return false;
+            }
+
+            return heap.add_item(heap.get_next_id(), std::make_unique<Lambda>(*instance_prototype_p, std::move(code), *prototype_p, Value {*length_key_p}, Value {static_cast<int>(entry.arity)}, std::move(handlers))) != nullptr;
+        }
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief Read-only POSIX mapping of a bytecode cache file, which is unmapped on destruction.
+     */
+    export class MappedCacheFile {
+    private:
+        const std::byte* m_data_p;
+        std::size_t m_length;
+
+    public:
+        explicit MappedCacheFile(const std::string& file_path) noexcept
+        : m_data_p {nullptr}, m_length {0} {
+            const int fd = ::open(file_path.c_str(), O_RDONLY);
+
+            if (fd < 0) {
+                return;
+            }
+
+            struct stat file_info {};
+
+            if (::fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+                if (auto mapping_p = ::mmap(nullptr, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0); mapping_p != MAP_FAILED) {
+                    m_data_p = static_cast<const std::byte*>(mapping_p);
+                    m_length = file_info.st_size;
+                }
+            }
+
+            //? NOTE: The mapping stays valid after closing its file descriptor.
+            ::close(fd);
+        }
+
+        MappedCacheFile(const MappedCacheFile&) = delete;
+        MappedCacheFile& operator=(const MappedCacheFile&) = delete;
+
+        ~MappedCacheFile() {
+            if (m_data_p) {
+                ::munmap(const_cast<std::byte*>(m_data_p), m_length);
+            }
+        }
+
+        [[nodiscard]] auto is_mapped() const noexcept -> bool {
+            return m_data_p != nullptr;
+        }
+
+        [[nodiscard]] auto view() const noexcept -> std::span<const std::byte> {
+            return {m_data_p, m_length};
+        }
+    };
+
+    [[nodiscard]] auto write_cache_file(const CacheWriter& writer, const std::string& file_path) -> bool {
+        std::ofstream cache_out {file_path, std::ios::binary | std::ios::trunc};
+        const auto cache_bytes = writer.view();
+
+        if (!cache_out.write(cache_bytes.data(), cache_bytes.length())) {
+            std::println(std::cerr, "NOTE: could not write bytecode cache: '{}'", file_path);
+            return false;
+        }
+
+        return true;
+    }
+
+    void put_symbols(CacheWriter& writer, const std::vector<std::pair<std::string, Arg>>& symbols) {
+        writer.put(static_cast<uint32_t>(symbols.size()));
+
+        for (const auto& [symbol_name, symbol_loc] : symbols) {
+            writer.put(static_cast<uint32_t>(symbol_name.length()));
+            writer.put_bytes(symbol_name.data(), symbol_name.length());
+            writer.put(symbol_loc.n, symbol_loc.tag, symbol_loc.is_str_literal, symbol_loc.from_closure);
+        }
+    }
+
+    [[nodiscard]] auto take_symbols(CacheReader& reader, std::vector<std::pair<std::string, Arg>>& symbols) -> bool {
+        uint32_t symbol_count = 0;
+
+        if (!reader.take(symbol_count)) {
+            return false;
+        }
+
+        for (uint32_t symbol_pos = 0; symbol_pos < symbol_count; symbol_pos++) {
+            uint32_t name_length = 0;
+
+            if (!reader.take(name_length) || !reader.has_room_for(name_length, sizeof(char))) {
+                return false;
+            }
+
+            std::string symbol_name (name_length, '\0');
+            Arg symbol_loc {};
+
+            if (!reader.take_bytes(symbol_name.data(), name_length) || !reader.take(symbol_loc.n, symbol_loc.tag, symbol_loc.is_str_literal, symbol_loc.from_closure)) {
+                return false;
+            }
+
+            symbols.emplace_back(std::move(symbol_name), symbol_loc);
+        }
+
+        return true;
+    }
+
+    /// NOTE: Opcodes whose 1st argument indexes the constant pool.
+    [[nodiscard]] constexpr auto takes_const_id(Opcode op) noexcept -> bool {
+        switch (op) {
+        case Opcode::djs_put_const:
+        case Opcode::djs_add_local_const:
+        case Opcode::djs_sub_local_const:
+        case Opcode::djs_get_prop_const:
+        case Opcode::djs_add_local_const_i32:
+        case Opcode::djs_sub_local_const_i32:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// NOTE: Opcodes whose 1st argument is a jump offset relative to themselves, including the fused `djs_jump_else_*` heads.
+    [[nodiscard]] constexpr auto takes_jump_offset(Opcode op) noexcept -> bool {
+        switch (op) {
+        case Opcode::djs_jump_else:
+        case Opcode::djs_jump_if:
+        case Opcode::djs_jump:
+        case Opcode::djs_jump_else_strict_eq:
+        case Opcode::djs_jump_else_strict_ne:
+        case Opcode::djs_jump_else_lt:
+        case Opcode::djs_jump_else_lte:
+        case Opcode::djs_jump_else_gt:
+        case Opcode::djs_jump_else_gte:
+        case Opcode::djs_jump_else_lt_i32:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// NOTE: Counts the kept tail instructions after a superinstruction head, which its handler reads or skips over.
+    [[nodiscard]] constexpr auto fused_tail_length(Opcode op) noexcept -> int {
+        switch (op) {
+        case Opcode::djs_add_local_const:
+        case Opcode::djs_sub_local_const:
+        case Opcode::djs_add_local_const_i32:
+        case Opcode::djs_sub_local_const_i32:
+            return 2;
+        case Opcode::djs_get_prop_const:
+        case Opcode::djs_jump_else_strict_eq:
+        case Opcode::djs_jump_else_strict_ne:
+        case Opcode::djs_jump_else_lt:
+        case Opcode::djs_jump_else_lte:
+        case Opcode::djs_jump_else_gt:
+        case Opcode::djs_jump_else_gte:
+        case Opcode::djs_jump_else_lt_i32:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    /**
+     * @brief Checks decoded bytecode before any VM runs it, as the handlers index constants & jump without bounds checks: every opcode must be known, constant IDs must be within the pool, and jump targets, fused tails, & `try` handlers must stay within the code.
+     * @param is_prefix Set for prelude snapshot code, which the script's code continues, so its jumps may also land right past its end.
+     * @return The position of the first bad instruction, or nothing if the code is fine. Bad handler tables give the code's length.
+     */
+    [[nodiscard]] auto find_bad_instruction(std::span<const Instruction> code, std::span<const ExceptionRange> handlers, std::size_t const_count, bool is_prefix = false) -> std::optional<std::size_t> {
+        const auto code_length = static_cast<int64_t>(code.size());
+        const auto jump_end = code_length + static_cast<int64_t>(is_prefix);
+
+        for (int64_t code_pos = 0; code_pos < code_length; code_pos++) {
+            const auto& [args, op, feedback] = code[code_pos];
+
+            if (op >= Opcode::last) {
+                return code_pos;
+            } else if (takes_const_id(op) && (args[0] < 0 || static_cast<std::size_t>(args[0]) >= const_count)) {
+                return code_pos;
+            } else if (takes_jump_offset(op) && (code_pos + args[0] < 0 || code_pos + args[0] >= jump_end)) {
+                return code_pos;
+            } else if (code_pos + fused_tail_length(op) >= code_length) {
+                return code_pos;
+            }
+        }
+
+        for (const auto& [try_begin, try_end, handler_pos] : handlers) {
+            if (try_begin < 0 || try_begin > try_end || try_end > code_length || handler_pos < 0 || handler_pos >= code_length || code[handler_pos].op != Opcode::djs_catch) {
+                return code.size();
+            }
+        }
+
+        return {};
+    }
+
+    /// NOTE: Validates the restored functions' code, which could only be checked once the constants were read.
+    [[nodiscard]] auto check_lambda_items(PolyPool<ObjectBase<Value>>& heap, int first_item_id, std::size_t const_count) -> bool {
+        for (int slot_id = first_item_id, slot_end = heap.get_used_extent(); slot_id < slot_end; slot_id++) {
+            if (auto lambda_p = dynamic_cast<const Lambda*>(heap.get_item(slot_id)); lambda_p) {
+                if (const auto bad_pos = find_bad_instruction(lambda_p->view_code(), lambda_p->view_handlers(), const_count); bad_pos) {
+                    std::println(std::cerr, "NOTE: bad instruction #{} in function item #{} of bytecode cache.", *bad_pos, slot_id);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /// NOTE: Writes the header, then the compiler-made heap items, built-in IDs, constants, function offsets, top-level code, and top-level variable slots.
+    [[nodiscard]] auto put_program(CacheWriter& writer, const Program& prgm, const std::array<char, 4>& magic) -> bool {
+        const auto& heap_items = prgm.heap_items.view_items();
+        const int heap_extent = prgm.heap_items.get_used_extent();
+        HeapIdMap heap_ids;
+
+        for (int slot_id = 0; slot_id < heap_extent; slot_id++) {
+            if (const auto& item_sp = heap_items[slot_id]; item_sp) {
+                heap_ids[item_sp.get()] = slot_id;
+            }
+        }
+
+        writer.put(
+            magic,
+            bc_cache_version,
+            static_cast<uint16_t>(Opcode::last),
+            static_cast<uint16_t>(sizeof(Instruction)),
+            static_cast<uint16_t>(prgm.builtins.size()),
+            static_cast<int32_t>(prgm.preload_item_count),
+            static_cast<int32_t>(heap_extent - prgm.preload_item_count),
+            static_cast<uint32_t>(prgm.consts.size()),
+            static_cast<uint32_t>(prgm.code.size()),
+            static_cast<uint32_t>(prgm.offsets.size()),
+            prgm.entry_func_id,
+            prgm.prop_cache_count
+        );
+
+        for (int slot_id = prgm.preload_item_count; slot_id < heap_extent; slot_id++) {
+            if (!heap_items[slot_id] || !put_item(writer, heap_ids, heap_items[slot_id].get())) {
+                std::println(std::cerr, "NOTE: cannot cache heap item #{}.", slot_id);
+                return false;
+            }
+        }
+
+        for (const auto builtin_p : prgm.builtins) {
+            if (const auto builtin_id = heap_id_of(heap_ids, builtin_p); builtin_id) {
+                writer.put(*builtin_id);
+            } else {
+                std::println(std::cerr, "NOTE: cannot cache a built-in object outside the heap.");
+                return false;
+            }
+        }
+
+        for (const auto& const_value : prgm.consts) {
+            if (!put_value(writer, heap_ids, const_value)) {
+                std::println(std::cerr, "NOTE: cannot cache constant of type '{}'.", const_value.get_typename());
+                return false;
+            }
+        }
+
+        for (const auto offset : prgm.offsets) {
+            writer.put(static_cast<int32_t>(offset));
+        }
+
+        writer.put_bytes(prgm.code.data(), prgm.code.size() * sizeof(Instruction));
+        put_handlers(writer, prgm.handlers);
+        put_symbols(writer, prgm.globals);
+
+        return true;
+    }
+
+    /// NOTE: Mirrors `put_program()`, where `prgm` starts with only the native preloads. Any version, opcode set, or preload layout mismatch rejects the file.
+    [[nodiscard]] auto take_program(CacheReader& reader, Program& prgm, const std::array<char, 4>& magic) -> bool {
+        CacheHeader header {};
+
+        if (!reader.take(
+            header.magic, header.version, header.opcode_count, header.instruction_size, header.builtin_count,
+            header.preload_item_count, header.item_count, header.const_count, header.code_length, header.offset_count,
+            header.entry_func_id, header.prop_cache_count
+        )) {
+            std::println(std::cerr, "NOTE: truncated bytecode cache.");
+            return false;
+        } else if (header.magic != magic || header.version != bc_cache_version || header.opcode_count != static_cast<uint16_t>(Opcode::last) || header.instruction_size != sizeof(Instruction)) {
+            std::println(std::cerr, "NOTE: bytecode cache is not from this DerkJS version.");
+            return false;
+        } else if (header.builtin_count != prgm.builtins.size() || header.preload_item_count != prgm.heap_items.get_used_extent() || header.item_count < 0) {
+            std::println(std::cerr, "NOTE: bytecode cache does not match the native preloads.");
+            return false;
+        }
+
+        auto& heap = prgm.heap_items;
+
+        for (int item_pos = 0; item_pos < header.item_count; item_pos++) {
+            if (!take_item(reader, heap)) {
+                std::println(std::cerr, "NOTE: bad heap item #{} in bytecode cache.", header.preload_item_count + item_pos);
+                return false;
+            }
+        }
+
+        for (auto& builtin_p : prgm.builtins) {
+            int32_t builtin_id = -1;
+
+            if (!reader.take(builtin_id)) {
+                return false;
+            } else if (const auto restored_p = resolve_heap_id(heap, builtin_id); restored_p) {
+                builtin_p = *restored_p;
+            } else {
+                return false;
+            }
+        }
+
+        if (!reader.has_room_for(header.const_count, cached_value_length)) {
+            std::println(std::cerr, "NOTE: truncated bytecode cache.");
+            return false;
+        }
+
+        std::vector<Value> consts;
+        consts.reserve(header.const_count);
+
+        for (uint32_t const_pos = 0; const_pos < header.const_count; const_pos++) {
+            if (auto const_value = take_value(reader, heap); const_value) {
+                consts.emplace_back(*const_value);
+            } else {
+                std::println(std::cerr, "NOTE: bad constant #{} in bytecode cache.", const_pos);
+                return false;
+            }
+        }
+
+        if (!reader.has_room_for(header.offset_count, sizeof(int32_t))) {
+            std::println(std::cerr, "NOTE: truncated bytecode cache.");
+            return false;
+        }
+
+        std::vector<int> offsets (header.offset_count);
+
+        for (auto& offset : offsets) {
+            int32_t cached_offset = 0;
+
+            if (!reader.take(cached_offset)) {
+                return false;
+            }
+
+            offset = cached_offset;
+        }
+
+        if (!reader.has_room_for(header.code_length, sizeof(Instruction))) {
+            std::println(std::cerr, "NOTE: truncated bytecode cache.");
+            return false;
+        }
+
+        std::vector<Instruction> code (header.code_length);
+
+        std::vector<ExceptionRange> handlers;
+        std::vector<std::pair<std::string, Arg>> globals;
+
+        if (!reader.take_bytes(code.data(), code.size() * sizeof(Instruction)) || !take_handlers(reader, handlers) || !take_symbols(reader, globals)) {
+            std::println(std::cerr, "NOTE: truncated bytecode cache.");
+            return false;
+        }
+
+        if (const auto bad_pos = find_bad_instruction(code, handlers, consts.size()); bad_pos) {
+            std::println(std::cerr, "NOTE: bad instruction #{} in top-level code of bytecode cache.", *bad_pos);
+            return false;
+        } else if (std::ranges::any_of(offsets, [&code](int offset) { return offset < 0 || offset >= static_cast<int>(code.size()); })) {
+            std::println(std::cerr, "NOTE: bad function offset in bytecode cache.");
+            return false;
+        } else if (!check_lambda_items(heap, header.preload_item_count, consts.size())) {
+            return false;
+        }
+
+        prgm.consts = std::move(consts);
+        prgm.code = std::move(code);
+        prgm.handlers = std::move(handlers);
+        prgm.offsets = std::move(offsets);
+        prgm.entry_func_id = header.entry_func_id;
+        prgm.prop_cache_count = header.prop_cache_count;
+        prgm.globals = std::move(globals);
+
+        return true;
+    }
+
+    void put_code(CacheWriter& writer, const std::vector<Instruction>& code) {
+        writer.put(static_cast<uint32_t>(code.size()));
+        writer.put_bytes(code.data(), code.size() * sizeof(Instruction));
+    }
+
+    [[nodiscard]] auto take_code(CacheReader& reader, std::vector<Instruction>& code) -> bool {
+        uint32_t code_length = 0;
+
+        if (!reader.take(code_length) || !reader.has_room_for(code_length, sizeof(Instruction))) {
+            return false;
+        }
+
+        code.resize(code_length);
+
+        return reader.take_bytes(code.data(), code.size() * sizeof(Instruction));
+    }
+
+    /**
+     * @brief Writes the compiled program as a versioned cache: a header, then heap items, built-in & constant references, the function offsets, and the top-level code. Native preloads are not stored since they hold C++ function pointers. Objects are stored by heap slot ID.
+     * @note This must run before a VM takes the program, as it expects the untouched compiler output.
+     */
+    export [[nodiscard]] auto write_program_cache(const Program& prgm, const std::string& file_path) -> bool {
+        CacheWriter writer;
+
+        return put_program(writer, prgm, bc_cache_magic) && write_cache_file(writer, file_path);
+    }
+
+    /**
+     * @brief Like `write_program_cache()`, but keeps the cache in memory. The bytes are never written to afterwards, so one image can be read by programs on any number of threads.
+     */
+    export [[nodiscard]] auto encode_program_cache(const Program& prgm) -> std::optional<std::vector<std::byte>> {
+        CacheWriter writer;
+
+        if (!put_program(writer, prgm, bc_cache_magic)) {
+            return {};
+        }
+
+        return writer.to_bytes();
+    }
+
+    /**
+     * @brief Fills in a program which only holds the native preloads (see `BytecodeEmitterContext::load_cached_script()`) from a cache made by `write_program_cache()`.
+     */
+    export [[nodiscard]] auto read_program_cache(Program& prgm, std::span<const std::byte> cache_bytes) -> bool {
+        CacheReader reader {cache_bytes};
+
+        if (!take_program(reader, prgm, bc_cache_magic) || !reader.at_end()) {
+            return false;
+        }
+
+        return prgm.entry_func_id >= 0 && prgm.entry_func_id < static_cast<int>(prgm.offsets.size()) && !prgm.code.empty();
+    }
+
+    /**
+     * @brief Writes a prelude snapshot: the prelude's heap items & constants in the `write_program_cache()` layout, followed by the compiler state in `PreludeSnapshot`.
+     * @param prelude Holds only the heap, built-ins, constants, and inline cache count so far. Its heap items must not have gone through the final compiler passes yet, as those run again over the whole program.
+     */
+    export [[nodiscard]] auto write_prelude_snapshot(const Program& prelude, const PreludeSnapshot& snapshot, const std::string& file_path) -> bool {
+        CacheWriter writer;
+
+        if (!put_program(writer, prelude, prelude_snapshot_magic)) {
+            return false;
+        }
+
+        put_symbols(writer, snapshot.global_symbols);
+        put_symbols(writer, snapshot.key_symbols);
+        put_symbols(writer, snapshot.top_level_locals);
+
+        writer.put(static_cast<uint32_t>(snapshot.captured_key_ids.size()));
+
+        for (const bool is_captured : snapshot.captured_key_ids) {
+            writer.put(static_cast<uint8_t>(is_captured));
+        }
+
+        writer.put(static_cast<int32_t>(snapshot.next_local_id));
+        put_code(writer, snapshot.prepass_code);
+        put_code(writer, snapshot.main_code);
+        put_handlers(writer, snapshot.main_handlers);
+
+        return write_cache_file(writer, file_path);
+    }
+
+    export [[nodiscard]] auto read_prelude_snapshot(Program& prelude, PreludeSnapshot& snapshot, std::span<const std::byte> snapshot_bytes) -> bool {
+        CacheReader reader {snapshot_bytes};
+
+        if (!take_program(reader, prelude, prelude_snapshot_magic)) {
+            return false;
+        } else if (!take_symbols(reader, snapshot.global_symbols) || !take_symbols(reader, snapshot.key_symbols) || !take_symbols(reader, snapshot.top_level_locals)) {
+            return false;
+        }
+
+        uint32_t captured_key_count = 0;
+
+        if (!reader.take(captured_key_count) || !reader.has_room_for(captured_key_count, sizeof(uint8_t))) {
+            return false;
+        }
+
+        snapshot.captured_key_ids.resize(captured_key_count);
+
+        for (uint32_t key_pos = 0; key_pos < captured_key_count; key_pos++) {
+            uint8_t is_captured = 0;
+
+            if (!reader.take(is_captured)) {
+                return false;
+            }
+
+            snapshot.captured_key_ids[key_pos] = is_captured != 0;
+        }
+
+        int32_t next_local_id = 1;
+
+        if (!reader.take(next_local_id) || !take_code(reader, snapshot.prepass_code) || !take_code(reader, snapshot.main_code) || !take_handlers(reader, snapshot.main_handlers)) {
+            return false;
+        } else if (find_bad_instruction(snapshot.prepass_code, {}, prelude.consts.size(), true) || find_bad_instruction(snapshot.main_code, snapshot.main_handlers, prelude.consts.size(), true)) {
+            std::println(std::cerr, "NOTE: bad instruction in prelude snapshot code.");
+            return false;
+        }
+
+        snapshot.next_local_id = next_local_id;
+
+        return reader.at_end();
+    }
+}
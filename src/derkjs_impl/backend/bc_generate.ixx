@@ -1,16 +1,22 @@
 module;
 
+#include <cstddef>
 #include <type_traits>
 #include <utility>
+#include <limits>
 #include <span>
 
 #include <optional>
+#include <format>
 #include <string>
+#include <string_view>
 #include <forward_list>
+#include <list>
 #include <array>
 #include <vector>
 #include <variant>
 #include <flat_map>
+#include <unordered_map>
 #include <sstream>
 #include <iostream>
 #include <print>
@@ -24,6 +30,9 @@ export import runtime.strings;
 export import runtime.callables;
 export import runtime.value;
 export import runtime.bytecode;
+import backend.bc_peephole;
+import backend.bc_optimize;
+import backend.bc_cache;
 
 namespace DerkJS::Backend {
     export struct PreloadItem {
@@ -54,6 +63,14 @@ namespace DerkJS::Backend {
         std::vector<int> repeats; // locations of any immediate, continue jumps
     };
 
+    /// NOTE: The reusable parts of a compiled `Function()` snippet, keyed by its full source text. The code is copied right after compilation, before any quickening.
+    export struct SnippetCacheEntry {
+        std::string source;
+        std::vector<Instruction> code;
+        std::vector<ExceptionRange> handlers;
+        int arity;
+    };
+
     /// NOTE: Forward declaration of bytecode compiler state.
     export class BytecodeEmitterContext;
 
@@ -113,16 +130,39 @@ namespace DerkJS::Backend {
         // stack of bytecode buffers, accounting for arbitrary nesting of lambdas
         std::forward_list<std::vector<Instruction>> m_code_blobs;
 
+        // `try` handler tables for each bytecode buffer above, pushed & popped along with them
+        std::forward_list<std::vector<ExceptionRange>> m_handler_tables;
+
+        // Locations of function objects already emitted by a hoisting pre-pass, keyed by their lambda nodes. The main pass reuses these, so each function body compiles just once.
+        std::unordered_map<const Expr*, Arg> m_hoisted_lambdas;
+
         // Track currently emitting function by name & find any self-references here.
         std::string m_callee_name;
 
         // filled with global function IDs -> absolute offsets into the bytecode blob
         std::vector<int> m_chunk_offsets;
 
+        // Flags the constant IDs of variable names ever referenced as upvalues. Stores of other names are dead within functions.
+        std::vector<bool> m_captured_key_ids;
+
         PolyPool<ObjectBase<Value>>* m_runtime_heap_ptr;
 
+        // Memory budget in bytes for cached `Function()` snippets.
+        static constexpr std::size_t snippet_cache_budget = 1024 * 1024;
+
+        // LRU cache of compiled `Function()` snippets, where the front is the most recently used. Lookups key on views of each entry's own source.
+        std::list<SnippetCacheEntry> m_snippet_cache;
+        std::unordered_map<std::string_view, std::list<SnippetCacheEntry>::iterator> m_snippet_lookup;
+        std::size_t m_snippet_cache_bytes;
+
+        // Counts inline cache IDs given to property access sites. `Function()` snippets keep counting since they share the VM's cache table.
+        int m_prop_cache_count;
+
         int m_member_depth;
 
+        // Counts the items pushed by the array literals & calls still being emitted, which must stay within `max_listed_items` for the VM's per-frame stack room.
+        int m_pending_items;
+
         // Whether AST visitation is in a callable- Used in the check for implicit returns within functions.
         bool m_in_callable;
 
@@ -296,6 +336,8 @@ namespace DerkJS::Backend {
 
                 if (auto existing_capture_key_loc = lookup_symbol(symbol, FindKeyConstOpt {}); existing_capture_key_loc) {
                     existing_capture_key_loc->from_closure = true;
+                    mark_captured_key(existing_capture_key_loc->n);
+
                     return existing_capture_key_loc;
                 } else if (auto heap_dyn_str_p = m_heap.add_item(m_heap.get_next_id(), std::make_unique<DynamicString>(
                     m_builtin_ptrs[static_cast<std::size_t>(BuiltInObjects::str)],
@@ -312,6 +354,7 @@ namespace DerkJS::Backend {
 
                     auto temp_as_capture_key = m_key_consts_map.at(symbol);
                     temp_as_capture_key.from_closure = true;
+                    mark_captured_key(next_global_ref_const_id);
 
                     return temp_as_capture_key;
                 }
@@ -320,6 +363,12 @@ namespace DerkJS::Backend {
             } else if constexpr (std::is_same_v<plain_item_type, RecordLocalOpt> && std::is_same_v<RecordOpt, FindLocalsOpt>) {
                 // 4. local variable name case
                 const int16_t next_local_id = m_local_maps.back().next_local_id;
+
+                //? NOTE: Function frames must fit the VM stack's per-frame room, but the top-level frame's variables are reserved for apart from it.
+                if (m_in_callable && next_local_id >= max_frame_locals) {
+                    std::println(std::cerr, "Compile Error: A function has more than {} locals.", max_frame_locals);
+                    return {};
+                }
                 Arg next_local_loc {
                     .n = next_local_id,
                     .tag = Location::local
@@ -380,6 +429,90 @@ namespace DerkJS::Backend {
             return {};
         }
 
+        void mark_captured_key(int16_t key_const_id) {
+            if (key_const_id >= static_cast<int>(m_captured_key_ids.size())) {
+                m_captured_key_ids.resize(key_const_id + 1);
+            }
+
+            m_captured_key_ids[key_const_id] = true;
+        }
+
+        [[nodiscard]] auto is_captured_key(int16_t key_const_id) const noexcept -> bool {
+            return key_const_id >= 0 && key_const_id < static_cast<int>(m_captured_key_ids.size()) && m_captured_key_ids[key_const_id];
+        }
+
+        /// NOTE: Escape analysis over every compiled function once all capture references are known. Top-level stores are kept since they define `globalThis` properties.
+        void elide_dead_upval_stores() {
+            for (const auto& item_sp : m_heap.view_items()) {
+                if (auto lambda_p = dynamic_cast<Lambda*>(item_sp.get()); lambda_p) {
+                    lambda_p->elide_upval_stores([this](int16_t key_const_id) noexcept {
+                        return is_captured_key(key_const_id);
+                    });
+                }
+            }
+        }
+
+        /// NOTE: Gives a constant ID for a folded number, reusing an earlier fold of the same value. These keys can't clash with literal lexemes.
+        [[nodiscard]] auto intern_folded_const(const Value& folded_value) -> std::optional<int16_t> {
+            const auto folded_key = (folded_value.get_tag() == ValueTag::num_i32)
+                ? std::format("%folded:i32:{}", folded_value.as_i32_unchecked())
+                : std::format("%folded:f64:{}", folded_value.as_f64_unchecked());
+
+            if (m_consts.size() >= static_cast<std::size_t>(std::numeric_limits<int16_t>::max()) && !lookup_symbol(folded_key, FindGlobalConstsOpt {})) {
+                return {};
+            }
+
+            return record_symbol(folded_key, folded_value, FindGlobalConstsOpt {}).transform([](const Arg& const_loc) noexcept {
+                return const_loc.n;
+            });
+        }
+
+        /// NOTE: Runs the bytecode optimizer on the top-level code & every compiled function, see `./src/derkjs_impl/backend/bc_optimize.ixx`.
+        void optimize_all_code(std::vector<Instruction>& top_level_code, std::vector<ExceptionRange>& top_level_handlers) {
+            const auto intern_const = [this](const Value& folded_value) {
+                return intern_folded_const(folded_value);
+            };
+
+            optimize_code(top_level_code, top_level_handlers, m_consts, intern_const);
+
+            for (const auto& item_sp : m_heap.view_items()) {
+                if (auto lambda_p = dynamic_cast<Lambda*>(item_sp.get()); lambda_p) {
+                    lambda_p->rewrite_code([this, &intern_const](std::vector<Instruction>& lambda_code, std::vector<ExceptionRange>& lambda_handlers) {
+                        optimize_code(lambda_code, lambda_handlers, m_consts, intern_const);
+                    });
+                }
+            }
+        }
+
+        /// NOTE: Runs the peephole pass on the top-level code & every compiled function.
+        void fuse_all_superinstructions(std::vector<Instruction>& top_level_code) {
+            fuse_superinstructions(top_level_code);
+
+            for (const auto& item_sp : m_heap.view_items()) {
+                if (auto lambda_p = dynamic_cast<Lambda*>(item_sp.get()); lambda_p) {
+                    lambda_p->rewrite_code([](std::vector<Instruction>& lambda_code) {
+                        fuse_superinstructions(lambda_code);
+                    });
+                }
+            }
+        }
+
+        /// NOTE: Gives the next inline cache ID for a property access site, or -1 once all 16-bit IDs are used.
+        [[nodiscard]] auto reserve_prop_cache_id() noexcept -> int16_t {
+            if (m_prop_cache_count >= std::numeric_limits<int16_t>::max()) {
+                return -1;
+            }
+
+            return static_cast<int16_t>(m_prop_cache_count++);
+        }
+
+        /// NOTE: Checks if the last emitted instruction pushed a constant, e.g the key string of `foo.bar`. Only such sites get inline caches because their keys are tenured.
+        [[nodiscard]] auto last_emitted_is_const() const noexcept -> bool {
+            const auto& current_code = m_code_blobs.front();
+
+            return !current_code.empty() && current_code.back().op == Opcode::djs_put_const;
+        }
+
         /// NOTE: This overload is for no-argument opcodes
         void encode_instruction(Opcode op) {
             m_code_blobs.front().emplace_back(Instruction {
@@ -405,7 +538,7 @@ namespace DerkJS::Backend {
         }
 
         BytecodeEmitterContext()
-        : m_builtin_ids {}, m_global_consts_map {}, m_key_consts_map {}, m_builtin_ptrs {}, m_local_maps {}, m_heap {}, m_consts {}, m_code_blobs {}, m_callee_name {}, m_chunk_offsets {}, m_runtime_heap_ptr {nullptr}, m_member_depth {0}, m_in_callable {false}, m_has_string_ops {false}, m_has_new_applied {false}, m_access_as_lval {false}, m_accessing_property {false}, m_pass_key_raw {false}, m_has_call {false}, m_in_try_block {false}, m_prepass_vars {true} {
+        : m_builtin_ids {}, m_global_consts_map {}, m_key_consts_map {}, m_builtin_ptrs {}, m_local_maps {}, m_heap {}, m_consts {}, m_code_blobs {}, m_handler_tables {}, m_hoisted_lambdas {}, m_callee_name {}, m_chunk_offsets {}, m_captured_key_ids {}, m_runtime_heap_ptr {nullptr}, m_snippet_cache {}, m_snippet_lookup {}, m_snippet_cache_bytes {0}, m_prop_cache_count {0}, m_member_depth {0}, m_pending_items {0}, m_in_callable {false}, m_has_string_ops {false}, m_has_new_applied {false}, m_access_as_lval {false}, m_accessing_property {false}, m_pass_key_raw {false}, m_has_call {false}, m_in_try_block {false}, m_prepass_vars {true} {
             m_builtin_ids["Boolean::prototype"] = BuiltInObjects::boolean;
             m_builtin_ids["Number::prototype"] = BuiltInObjects::number;
             m_builtin_ids["String::prototype"] = BuiltInObjects::str;
@@ -454,14 +587,78 @@ namespace DerkJS::Backend {
             return false;
         }
 
-        /// NOTE: use this for `Function()`.
+        /// NOTE: Approximate memory held by a cached snippet, counted against `snippet_cache_budget`.
+        [[nodiscard]] static auto snippet_footprint(const SnippetCacheEntry& entry) noexcept -> std::size_t {
+            return sizeof(SnippetCacheEntry) + entry.source.length() + entry.code.size() * sizeof(Instruction) + entry.handlers.size() * sizeof(ExceptionRange);
+        }
+
+        /// NOTE: Makes a fresh function object from a cached snippet, as the lambda emitter would. Each `Function()` call still gets its own object & `prototype`.
+        [[nodiscard]] auto instantiate_cached_snippet(const SnippetCacheEntry& entry, PolyPool<ObjectBase<Value>>& vm_heap) -> ObjectBase<Value>* {
+            //? NOTE: `m_heap` was moved into the Program by now, so both objects go into the running VM's heap.
+            auto dud_instance_prototype_p = vm_heap.add_item(vm_heap.get_next_id(), std::make_unique<Object>(
+                m_builtin_ptrs.at(static_cast<unsigned int>(BuiltInObjects::object))
+            ));
+
+            if (!dud_instance_prototype_p) {
+                return nullptr;
+            }
+
+            return vm_heap.add_item(vm_heap.get_next_id(), std::make_unique<Lambda>(
+                dud_instance_prototype_p,
+                entry.code,
+                m_builtin_ptrs.at(static_cast<unsigned int>(BuiltInObjects::function)),
+                m_builtin_ptrs.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key)),
+                Value {entry.arity},
+                entry.handlers
+            ));
+        }
+
+        /// NOTE: Caches a newly compiled snippet, evicting the least recently used ones to stay within `snippet_cache_budget`.
+        void remember_snippet(const std::string& snippet_code, const Lambda& snippet_lambda) {
+            const auto lambda_code = snippet_lambda.view_code();
+            const auto lambda_handlers = snippet_lambda.view_handlers();
+            SnippetCacheEntry entry {
+                .source = snippet_code,
+                .code = {lambda_code.begin(), lambda_code.end()},
+                .handlers = {lambda_handlers.begin(), lambda_handlers.end()},
+                .arity = snippet_lambda.min_arity()
+            };
+            const auto entry_footprint = snippet_footprint(entry);
+
+            if (entry_footprint > snippet_cache_budget) {
+                return;
+            }
+
+            while (!m_snippet_cache.empty() && m_snippet_cache_bytes + entry_footprint > snippet_cache_budget) {
+                const auto& stale_entry = m_snippet_cache.back();
+
+                m_snippet_cache_bytes -= snippet_footprint(stale_entry);
+                m_snippet_lookup.erase(stale_entry.source);
+                m_snippet_cache.pop_back();
+            }
+
+            m_snippet_cache.emplace_front(std::move(entry));
+            m_snippet_lookup[m_snippet_cache.front().source] = m_snippet_cache.begin();
+            m_snippet_cache_bytes += entry_footprint;
+        }
+
+        /// NOTE: use this for `Function()`. Repeated snippet sources skip compilation through the snippet cache.
         [[nodiscard]] auto compile_function_snippet(const std::string& snippet_code, Lexer& lexer, Parser& parser, PolyPool<ObjectBase<Value>>& vm_heap) -> ObjectBase<Value>* {
+            if (auto cached_it = m_snippet_lookup.find(snippet_code); cached_it != m_snippet_lookup.end()) {
+                m_snippet_cache.splice(m_snippet_cache.begin(), m_snippet_cache, cached_it->second);
+
+                return instantiate_cached_snippet(*cached_it->second, vm_heap);
+            }
+
             m_local_maps.clear();
             m_code_blobs.clear();
+            m_handler_tables.clear();
+            m_hoisted_lambdas.clear();
             m_callee_name.clear();
             m_chunk_offsets.clear();
             m_runtime_heap_ptr = &vm_heap;
             m_member_depth = 0;
+            m_pending_items = 0;
             m_in_callable = false;
             m_has_string_ops = false;
             m_has_new_applied = false;
@@ -488,6 +685,7 @@ namespace DerkJS::Backend {
                 .block_level = -1
             });
             m_code_blobs.emplace_front();
+            m_handler_tables.emplace_front();
 
             const auto& snippet_decl_variant = snippet_tu->at(0).decl->data; // StmtPtr
 
@@ -512,12 +710,20 @@ namespace DerkJS::Backend {
             }
 
             const int expected_lambda_arity = lambda_literal_p->params.size();
+            auto snippet_fn_p = m_runtime_heap_ptr->get_newest_item();
+
+            if (auto snippet_lambda_p = dynamic_cast<Lambda*>(snippet_fn_p); snippet_lambda_p) {
+                snippet_lambda_p->rewrite_code([](std::vector<Instruction>& lambda_code) {
+                    fuse_superinstructions(lambda_code);
+                });
+                remember_snippet(snippet_code, *snippet_lambda_p);
+            }
 
-            return m_runtime_heap_ptr->get_newest_item();
+            return snippet_fn_p;
         }
 
-        /// NOTE: Use this for initial compilation of the program.
-        [[nodiscard]] auto compile_script(std::vector<PreloadItem> preloadables, int heap_object_capacity, const ASTUnit& tu, const std::vector<std::string>& source_map) -> std::optional<Program> {
+        /// NOTE: Does the setup shared by compiled & cached programs: the fundamental constants & all native preloads.
+        void load_preloads(std::vector<PreloadItem> preloadables, int heap_object_capacity) {
             // 1.1: Setup heap of desired capacity for future VM use.
             m_heap = PolyPool<ObjectBase<Value>> {heap_object_capacity};
 
@@ -564,63 +770,263 @@ namespace DerkJS::Backend {
 
             const int name_key_const_id = lookup_symbol("name", FindKeyConstOpt {})->n;
             m_builtin_ptrs[static_cast<unsigned int>(BuiltInObjects::extra_name_key)] = m_consts.at(name_key_const_id).to_object();
+        }
 
+        /// NOTE: Opens the implicit top-level function. Its scope & code may continue from a prelude snapshot.
+        void begin_top_level(CodeGenScope scope, std::vector<Instruction> code) {
             // 3. Prepare initial mapping of symbols & code buffer to build.
-            m_local_maps.emplace_back(CodeGenScope {
-                .locals = {},
-                // regular locals start from offset 1, yet -1 is a thisArg & 0 is the callee
-                .next_local_id = 1,
-                .block_level = -1
-            });
-            m_code_blobs.emplace_front();
+            m_local_maps.emplace_back(std::move(scope));
+            m_code_blobs.emplace_front(std::move(code));
+            m_handler_tables.emplace_front();
+            m_hoisted_lambdas.clear();
 
             // 4.1: emit all top-level non-function statements as an implicit function that's called right away.
-            constexpr auto global_func_id = 0; // implicit main function begins at offset 0
             m_chunk_offsets.emplace_back(0);
+        }
 
-            // 4.2: emit all vars (especially function declaration syntax sugar) FIRST as per JS hoisting.
+        /// NOTE: Emits the top-level statements once, either as the hoisting pre-pass (while `m_prepass_vars` is set) or as the main pass.
+        [[nodiscard]] auto emit_top_level_pass(const ASTUnit& tu, const std::vector<std::string>& source_map) -> bool {
             for (const auto& [src_filename, decl, src_id] : tu) {
                 if (!decl) {
                     continue;
                 }
 
                 if (!emit_stmt(*decl, source_map.at(src_id))) {
-                    std::println(std::cerr, "Compile Error at source '{}' for unsupported JS construct:\nSnippet:\n'{}'\n\n", src_filename, source_map.at(src_id).substr(decl->text_begin, decl->text_length / 2));
-                    return {};
+                    std::println(std::cerr, "Compile Error at source '{}' for unsupported JS construct:\nSnippet:\n'{}'\n\n", src_filename, source_map.at(src_id).substr(decl->text_begin, (m_prepass_vars) ? decl->text_length / 2 : decl->text_length));
+                    return false;
                 }
             }
 
-            m_prepass_vars = false;
-
-            for (const auto& [src_filename, decl, src_id] : tu) {
-                if (!decl) {
-                    continue;
-                }
+            return true;
+        }
 
-                if (!emit_stmt(*decl, source_map.at(src_id))) {
-                    std::println(std::cerr, "Compile Error at source '{}' for unsupported JS construct:\nSnippet:\n{}\n\n", src_filename, source_map.at(src_id).substr(decl->text_begin, decl->text_length));
-                    return {};
-                }
-            }
+        /// NOTE: Ends the top-level function & runs the whole-program passes.
+        [[nodiscard]] auto finish_top_level(int preload_item_count) -> Program {
+            constexpr auto global_func_id = 0; // implicit main function begins at offset 0
 
             // 5: place implicit `return undefined` in top-level.
             encode_instruction(Opcode::djs_put_const, lookup_symbol("undefined", FindGlobalConstsOpt {}).value());
             encode_instruction(Opcode::djs_ret);
 
+            // 5.2: Skip capture objects & upvalue stores for locals that no function captures.
+            elide_dead_upval_stores();
+
             // 6: Place dud offset marker for bytecode dumping to properly end.
             m_chunk_offsets.emplace_back(-1);
 
             std::vector<Instruction> global_code_buffer {std::move(m_code_blobs.front())};
             m_code_blobs.pop_front();
 
+            std::vector<ExceptionRange> global_handlers {std::move(m_handler_tables.front())};
+            m_handler_tables.pop_front();
+
+            // 7.1: Fold constants, thread jumps, & strip dead code, relocating every code offset.
+            optimize_all_code(global_code_buffer, global_handlers);
+
+            // 7.2: Fuse hot instruction sequences only after all code offsets are final.
+            fuse_all_superinstructions(global_code_buffer);
+
+            // 8: Keep the top-level variables' slots for embedders calling into the script.
+            std::vector<std::pair<std::string, Arg>> global_slots;
+
+            for (const auto& [symbol_name, symbol_loc] : m_local_maps.back().locals) {
+                if (symbol_loc.tag == Location::local) {
+                    global_slots.emplace_back(symbol_name, symbol_loc);
+                }
+            }
+
             return Program {
                 .heap_items = std::move(m_heap), // PolyPool<ObjectBase<Value>>
                 .builtins = std::move(m_builtin_ptrs),
                 .consts = std::move(m_consts), // std::vector<Value>
                 .code = std::move(global_code_buffer), // std::vector<Instruction>
+                .handlers = std::move(global_handlers), // std::vector<ExceptionRange>
                 .offsets = std::move(m_chunk_offsets), // std::vector<int>
                 .entry_func_id = static_cast<int16_t>(global_func_id), // int
+                .prop_cache_count = static_cast<int16_t>(m_prop_cache_count),
+                .preload_item_count = preload_item_count,
+                .globals = std::move(global_slots)
+            };
+        }
+
+        /// NOTE: Use this for initial compilation of the program.
+        [[nodiscard]] auto compile_script(std::vector<PreloadItem> preloadables, int heap_object_capacity, const ASTUnit& tu, const std::vector<std::string>& source_map) -> std::optional<Program> {
+            // 1-2: Record constants & native preloads.
+            load_preloads(std::move(preloadables), heap_object_capacity);
+            const int preload_item_count = m_heap.get_used_extent();
+
+            // 3-4.1: regular locals start from offset 1, yet -1 is a thisArg & 0 is the callee
+            begin_top_level(CodeGenScope {.locals = {}, .next_local_id = 1, .block_level = -1}, {});
+
+            // 4.2: emit all vars (especially function declaration syntax sugar) FIRST as per JS hoisting.
+            if (!emit_top_level_pass(tu, source_map)) {
+                return {};
+            }
+
+            m_prepass_vars = false;
+
+            if (!emit_top_level_pass(tu, source_map)) {
+                return {};
+            }
+
+            return finish_top_level(preload_item_count);
+        }
+
+        /**
+         * @brief Compiles only the prelude (the polyfills) and saves it as a prelude snapshot, see `./src/derkjs_impl/backend/bc_cache.ixx`. Both top-level passes are kept apart, so a script compiled on top still gets all hoisted vars before any other top-level code.
+         * @note The final passes (upvalue store elision & superinstructions) are left for the whole program, as a script may capture prelude variables.
+         */
+        [[nodiscard]] auto snapshot_prelude(std::vector<PreloadItem> preloadables, int heap_object_capacity, const ASTUnit& tu, const std::vector<std::string>& source_map, const std::string& snapshot_path) -> bool {
+            load_preloads(std::move(preloadables), heap_object_capacity);
+            const int preload_item_count = m_heap.get_used_extent();
+
+            begin_top_level(CodeGenScope {.locals = {}, .next_local_id = 1, .block_level = -1}, {});
+
+            if (!emit_top_level_pass(tu, source_map)) {
+                return false;
+            }
+
+            std::vector<Instruction> prepass_code {std::move(m_code_blobs.front())};
+            m_code_blobs.front().clear();
+            m_prepass_vars = false;
+
+            if (!emit_top_level_pass(tu, source_map)) {
+                return false;
+            }
+
+            PreludeSnapshot snapshot {
+                .global_symbols = {},
+                .key_symbols = {},
+                .top_level_locals = {},
+                .captured_key_ids = m_captured_key_ids,
+                .prepass_code = std::move(prepass_code),
+                .main_code = std::move(m_code_blobs.front()),
+                .main_handlers = std::move(m_handler_tables.front()),
+                .next_local_id = m_local_maps.back().next_local_id
+            };
+
+            for (const auto& [symbol_name, symbol_loc] : m_global_consts_map) {
+                snapshot.global_symbols.emplace_back(symbol_name, symbol_loc);
+            }
+
+            for (const auto& [symbol_name, symbol_loc] : m_key_consts_map) {
+                snapshot.key_symbols.emplace_back(symbol_name, symbol_loc);
+            }
+
+            for (const auto& [symbol_name, symbol_loc] : m_local_maps.back().locals) {
+                snapshot.top_level_locals.emplace_back(symbol_name, symbol_loc);
+            }
+
+            const Program prelude {
+                .heap_items = std::move(m_heap),
+                .builtins = m_builtin_ptrs,
+                .consts = std::move(m_consts),
+                .code = {},
+                .offsets = {},
+                .entry_func_id = 0,
+                .prop_cache_count = static_cast<int16_t>(m_prop_cache_count),
+                .preload_item_count = preload_item_count
+            };
+
+            return write_prelude_snapshot(prelude, snapshot, snapshot_path);
+        }
+
+        /// NOTE: Like `compile_script()`, but the prelude comes compiled from a snapshot made by `snapshot_prelude()`. Only the native preloads are rebuilt, and their heap slots must match the snapshot's.
+        [[nodiscard]] auto compile_script_on_prelude(std::vector<PreloadItem> preloadables, int heap_object_capacity, std::span<const std::byte> snapshot_bytes, const ASTUnit& tu, const std::vector<std::string>& source_map) -> std::optional<Program> {
+            load_preloads(std::move(preloadables), heap_object_capacity);
+            const int preload_item_count = m_heap.get_used_extent();
+
+            Program prelude {
+                .heap_items = std::move(m_heap),
+                .builtins = m_builtin_ptrs,
+                .consts = std::move(m_consts),
+                .code = {},
+                .offsets = {},
+                .entry_func_id = 0,
+                .prop_cache_count = 0,
+                .preload_item_count = preload_item_count
+            };
+            PreludeSnapshot snapshot {};
+
+            if (!read_prelude_snapshot(prelude, snapshot, snapshot_bytes)) {
+                return {};
+            }
+
+            m_heap = std::move(prelude.heap_items);
+            m_builtin_ptrs = prelude.builtins;
+            m_consts = std::move(prelude.consts);
+            m_prop_cache_count = prelude.prop_cache_count;
+            m_captured_key_ids = std::move(snapshot.captured_key_ids);
+            m_global_consts_map.clear();
+            m_key_consts_map.clear();
+
+            for (auto& [symbol_name, symbol_loc] : snapshot.global_symbols) {
+                m_global_consts_map[std::move(symbol_name)] = symbol_loc;
+            }
+
+            for (auto& [symbol_name, symbol_loc] : snapshot.key_symbols) {
+                m_key_consts_map[std::move(symbol_name)] = symbol_loc;
+            }
+
+            CodeGenScope top_level_scope {.locals = {}, .next_local_id = snapshot.next_local_id, .block_level = -1};
+
+            for (auto& [symbol_name, symbol_loc] : snapshot.top_level_locals) {
+                top_level_scope.locals[std::move(symbol_name)] = symbol_loc;
+            }
+
+            begin_top_level(std::move(top_level_scope), std::move(snapshot.prepass_code));
+
+            // 4.2: The script's hoisted vars follow the prelude's, then its other code follows the prelude's, as when compiling both as one source.
+            if (!emit_top_level_pass(tu, source_map)) {
+                return {};
+            }
+
+            //? NOTE: The prelude's handlers were relative to its main code, which now starts after all hoisted vars.
+            const int prelude_main_pos = m_code_blobs.front().size();
+
+            for (const auto& [try_begin, try_end, handler_pos] : snapshot.main_handlers) {
+                m_handler_tables.front().emplace_back(ExceptionRange {
+                    .try_begin = try_begin + prelude_main_pos,
+                    .try_end = try_end + prelude_main_pos,
+                    .handler_pos = handler_pos + prelude_main_pos
+                });
+            }
+
+            m_code_blobs.front().insert(m_code_blobs.front().end(), snapshot.main_code.begin(), snapshot.main_code.end());
+            m_prepass_vars = false;
+
+            if (!emit_top_level_pass(tu, source_map)) {
+                return {};
+            }
+
+            return finish_top_level(preload_item_count);
+        }
+
+        /// NOTE: Use this instead of `compile_script()` for a program from a bytecode cache. Only the native preloads are rebuilt here, and their heap slots must match those of the cached program.
+        [[nodiscard]] auto load_cached_script(std::vector<PreloadItem> preloadables, int heap_object_capacity, std::span<const std::byte> cache_bytes) -> std::optional<Program> {
+            load_preloads(std::move(preloadables), heap_object_capacity);
+            const int preload_item_count = m_heap.get_used_extent();
+
+            Program prgm {
+                .heap_items = std::move(m_heap),
+                .builtins = std::move(m_builtin_ptrs),
+                .consts = std::move(m_consts),
+                .code = {},
+                .offsets = {},
+                .entry_func_id = 0,
+                .prop_cache_count = 0,
+                .preload_item_count = preload_item_count
             };
+
+            if (!read_program_cache(prgm, cache_bytes)) {
+                return {};
+            }
+
+            //? NOTE: `Function()` snippets may still need the cached built-ins, e.g polyfilled Error constructors.
+            m_builtin_ptrs = prgm.builtins;
+            m_prop_cache_count = prgm.prop_cache_count;
+
+            return prgm;
         }
     };
 
@@ -0,0 +1,311 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+export module backend.bc_optimize;
+
+import runtime.value;
+import runtime.bytecode;
+
+namespace DerkJS::Backend {
+    /// NOTE: Limits how many `djs_jump`s one jump is threaded through, which also stops on jump cycles.
+    constexpr int max_thread_hops = 16;
+
+    [[nodiscard]] constexpr auto is_relative_jump(Opcode op) noexcept -> bool {
+        return op == Opcode::djs_jump || op == Opcode::djs_jump_if || op == Opcode::djs_jump_else;
+    }
+
+    /// NOTE: Opcodes which never continue to the next instruction: `djs_throw` only resumes at a handler.
+    [[nodiscard]] constexpr auto ends_flow(Opcode op) noexcept -> bool {
+        return op == Opcode::djs_jump || op == Opcode::djs_ret || op == Opcode::djs_throw || op == Opcode::djs_halt;
+    }
+
+    [[nodiscard]] constexpr auto is_foldable_number(const Value& value) noexcept -> bool {
+        const auto value_tag = value.get_tag();
+
+        return value_tag == ValueTag::num_i32 || value_tag == ValueTag::num_f64;
+    }
+
+    /// NOTE: Evaluates `RHS LHS <op>` for constant numbers, exactly as each handler does with its accumulator slot. Both operands were pushed RHS first.
+    [[nodiscard]] inline auto fold_arithmetic(Opcode op, const Value& rhs, const Value& lhs) -> std::optional<Value> {
+        Value result {};
+
+        switch (op) {
+            case Opcode::djs_add: result = rhs; result += lhs; break;
+            case Opcode::djs_mul: result = rhs; result *= lhs; break;
+            case Opcode::djs_sub: result = lhs; result -= rhs; break;
+            case Opcode::djs_div: result = lhs; result /= rhs; break;
+            case Opcode::djs_mod: result = lhs; result %= rhs; break;
+            default: return {};
+        }
+
+        if (!is_foldable_number(result)) {
+            return {};
+        }
+
+        return result;
+    }
+
+    /// NOTE: Marks each code offset which something lands on besides falling through: jump targets and `try` handlers.
+    [[nodiscard]] inline auto find_landing_sites(const std::vector<Instruction>& code, const std::vector<ExceptionRange>& handlers) -> std::vector<bool> {
+        const int code_length = code.size();
+        std::vector<bool> landing_sites (code_length + 1, false);
+
+        for (int code_pos = 0; code_pos < code_length; code_pos++) {
+            if (is_relative_jump(code[code_pos].op)) {
+                if (const int target_pos = code_pos + code[code_pos].args[0]; target_pos >= 0 && target_pos <= code_length) {
+                    landing_sites[target_pos] = true;
+                }
+            }
+        }
+
+        for (const auto& [try_begin, try_end, handler_pos] : handlers) {
+            landing_sites[handler_pos] = true;
+        }
+
+        return landing_sites;
+    }
+
+    /// NOTE: Gives the closest offset before `code_pos` holding a real instruction, or -1.
+    [[nodiscard]] inline auto previous_kept(const std::vector<Instruction>& code, int code_pos) noexcept -> int {
+        do {
+            --code_pos;
+        } while (code_pos >= 0 && code[code_pos].op == Opcode::djs_nop);
+
+        return code_pos;
+    }
+
+    [[nodiscard]] inline auto any_landing_in(const std::vector<bool>& landing_sites, int first_pos, int last_pos) noexcept -> bool {
+        for (int code_pos = first_pos; code_pos <= last_pos; code_pos++) {
+            if (landing_sites[code_pos]) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// NOTE: Turns `put_const <number>, put_const <number>, <arithmetic>` into one `put_const` of the result. Folded results become operands of later folds, e.g `1 + 2 * 3` folds fully.
+    template <typename InternConst>
+    void fold_constants(std::vector<Instruction>& code, const std::vector<Value>& consts, const std::vector<bool>& landing_sites, InternConst&& intern_const) {
+        const int code_length = code.size();
+
+        for (int code_pos = 0; code_pos < code_length; code_pos++) {
+            const auto arith_op = code[code_pos].op;
+
+            if (arith_op != Opcode::djs_add && arith_op != Opcode::djs_sub && arith_op != Opcode::djs_mul && arith_op != Opcode::djs_div && arith_op != Opcode::djs_mod) {
+                continue;
+            }
+
+            const int lhs_pos = previous_kept(code, code_pos);
+            const int rhs_pos = (lhs_pos >= 0) ? previous_kept(code, lhs_pos) : -1;
+
+            //? NOTE: Either operand could have come from elsewhere if control lands between the pushes and the operator.
+            if (rhs_pos < 0 || code[lhs_pos].op != Opcode::djs_put_const || code[rhs_pos].op != Opcode::djs_put_const || any_landing_in(landing_sites, rhs_pos + 1, code_pos)) {
+                continue;
+            }
+
+            //? NOTE: Copies, since interning may grow the constants & move them.
+            const Value rhs = consts.at(code[rhs_pos].args[0]);
+            const Value lhs = consts.at(code[lhs_pos].args[0]);
+
+            if (!is_foldable_number(rhs) || !is_foldable_number(lhs)) {
+                continue;
+            }
+
+            if (auto folded_value = fold_arithmetic(arith_op, rhs, lhs); folded_value) {
+                if (const std::optional<int16_t> folded_const_id = intern_const(*folded_value); folded_const_id) {
+                    code[rhs_pos] = Instruction {.args = {*folded_const_id, 0}, .op = Opcode::djs_put_const};
+                    code[lhs_pos] = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+                    code[code_pos] = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+                }
+            }
+        }
+    }
+
+    /// NOTE: Drops `dup, pop` pairs and repeated `deref`s, since a cloned value clones to itself.
+    inline void drop_redundant_ops(std::vector<Instruction>& code, const std::vector<bool>& landing_sites) {
+        const int code_length = code.size();
+
+        for (int code_pos = 1; code_pos < code_length; code_pos++) {
+            const int prev_pos = previous_kept(code, code_pos);
+            auto& instr = code[code_pos];
+
+            if (prev_pos < 0 || any_landing_in(landing_sites, prev_pos + 1, code_pos)) {
+                continue;
+            }
+
+            if (code[prev_pos].op == Opcode::djs_dup && instr.op == Opcode::djs_pop && instr.args[0] >= 1) {
+                code[prev_pos] = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+
+                if (--instr.args[0] == 0) {
+                    instr = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+                }
+            } else if (code[prev_pos].op == Opcode::djs_deref && instr.op == Opcode::djs_deref) {
+                instr = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+            }
+        }
+    }
+
+    /// NOTE: Retargets jumps landing on a `djs_jump` (maybe past `djs_nop`s) to that jump's own target. No jump changes direction: backward jumps are the loops' safepoints, so a forward jump threaded backward would skip the loop's one, e.g an `if` ending a `while` body.
+    inline void thread_jumps(std::vector<Instruction>& code) {
+        const int code_length = code.size();
+
+        for (int code_pos = 0; code_pos < code_length; code_pos++) {
+            auto& jump = code[code_pos];
+
+            if (!is_relative_jump(jump.op)) {
+                continue;
+            }
+
+            int target_pos = code_pos + jump.args[0];
+
+            for (int hop = 0; hop < max_thread_hops; hop++) {
+                while (target_pos >= 0 && target_pos < code_length && code[target_pos].op == Opcode::djs_nop) {
+                    ++target_pos;
+                }
+
+                if (target_pos < 0 || target_pos >= code_length || target_pos == code_pos || code[target_pos].op != Opcode::djs_jump) {
+                    break;
+                }
+
+                target_pos += code[target_pos].args[0];
+            }
+
+            if (target_pos < 0 || target_pos >= code_length) {
+                continue;
+            }
+
+            if (const int threaded_offset = target_pos - code_pos; (jump.args[0] < 0) == (threaded_offset < 0) && threaded_offset != 0) {
+                jump.args[0] = static_cast<int16_t>(threaded_offset);
+            }
+        }
+    }
+
+    /// NOTE: Replaces code that no path reaches with `djs_nop`s, e.g statements after a `return`, `throw`, or `break`. Paths start at offset 0 and at each `try` handler.
+    inline void drop_unreachable(std::vector<Instruction>& code, const std::vector<ExceptionRange>& handlers) {
+        const int code_length = code.size();
+        std::vector<bool> reached (code_length, false);
+        std::vector<int> pending_sites {0};
+
+        for (const auto& [try_begin, try_end, handler_pos] : handlers) {
+            pending_sites.push_back(handler_pos);
+        }
+
+        while (!pending_sites.empty()) {
+            int code_pos = pending_sites.back();
+            pending_sites.pop_back();
+
+            while (code_pos >= 0 && code_pos < code_length && !reached[code_pos]) {
+                reached[code_pos] = true;
+
+                const auto& instr = code[code_pos];
+
+                if (is_relative_jump(instr.op)) {
+                    pending_sites.push_back(code_pos + instr.args[0]);
+                }
+
+                if (ends_flow(instr.op)) {
+                    break;
+                }
+
+                ++code_pos;
+            }
+        }
+
+        for (int code_pos = 0; code_pos < code_length; code_pos++) {
+            if (!reached[code_pos]) {
+                code[code_pos] = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+            }
+        }
+    }
+
+    /**
+     * @brief Removes all `djs_nop`s, relocating jump offsets and the `try` handler table. Landings on a removed `djs_nop` move to the next kept instruction, which is where running the `djs_nop` would have gone.
+     * @return Whether any instruction was removed.
+     */
+    inline auto compact_code(std::vector<Instruction>& code, std::vector<ExceptionRange>& handlers) -> bool {
+        const int code_length = code.size();
+        std::vector<int> new_positions (code_length + 1, 0);
+        int kept_count = 0;
+
+        for (int code_pos = 0; code_pos < code_length; code_pos++) {
+            new_positions[code_pos] = kept_count;
+
+            if (code[code_pos].op != Opcode::djs_nop) {
+                ++kept_count;
+            }
+        }
+
+        new_positions[code_length] = kept_count;
+
+        if (kept_count == code_length) {
+            return false;
+        }
+
+        std::vector<Instruction> compacted_code;
+        compacted_code.reserve(kept_count);
+
+        for (int code_pos = 0; code_pos < code_length; code_pos++) {
+            auto instr = code[code_pos];
+
+            if (instr.op == Opcode::djs_nop) {
+                continue;
+            }
+
+            if (is_relative_jump(instr.op)) {
+                instr.args[0] = static_cast<int16_t>(new_positions[code_pos + instr.args[0]] - new_positions[code_pos]);
+            }
+
+            compacted_code.push_back(instr);
+        }
+
+        for (auto& [try_begin, try_end, handler_pos] : handlers) {
+            try_begin = new_positions[try_begin];
+            try_end = new_positions[try_end];
+            handler_pos = new_positions[handler_pos];
+        }
+
+        code = std::move(compacted_code);
+
+        return true;
+    }
+
+    /**
+     * @brief Optimizes one function's finished bytecode: folds constant arithmetic, drops redundant `dup` / `pop` / `deref`s, threads jumps through jumps, removes unreachable code, and finally removes all `djs_nop`s.
+     * @note Runs before superinstruction fusion, which keeps fused tails in place and so must see the final offsets. Every code offset is relocated, so this may reorder nothing but can shrink everything.
+     * @param intern_const Takes a folded number constant, returning its constant ID if one is available.
+     */
+    export template <typename InternConst>
+    void optimize_code(std::vector<Instruction>& code, std::vector<ExceptionRange>& handlers, const std::vector<Value>& consts, InternConst&& intern_const) {
+        if (code.empty()) {
+            return;
+        }
+
+        const auto landing_sites = find_landing_sites(code, handlers);
+
+        fold_constants(code, consts, landing_sites, intern_const);
+        drop_redundant_ops(code, landing_sites);
+        thread_jumps(code);
+        drop_unreachable(code, handlers);
+
+        //? NOTE: Compaction can leave `djs_jump`s to the very next instruction, which are then removable too.
+        while (compact_code(code, handlers)) {
+            bool dropped_any_jump = false;
+
+            for (auto& instr : code) {
+                if (instr.op == Opcode::djs_jump && instr.args[0] == 1) {
+                    instr = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+                    dropped_any_jump = true;
+                }
+            }
+
+            if (!dropped_any_jump) {
+                break;
+            }
+        }
+    }
+}
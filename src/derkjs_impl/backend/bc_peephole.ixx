@@ -0,0 +1,55 @@
+module;
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+export module backend.bc_peephole;
+
+import runtime.bytecode;
+
+namespace DerkJS::Backend {
+    [[nodiscard]] constexpr auto fused_jump_else_of(Opcode test_op) noexcept -> std::optional<Opcode> {
+        switch (test_op) {
+            case Opcode::djs_test_strict_eq: return Opcode::djs_jump_else_strict_eq;
+            case Opcode::djs_test_strict_ne: return Opcode::djs_jump_else_strict_ne;
+            case Opcode::djs_test_lt: return Opcode::djs_jump_else_lt;
+            case Opcode::djs_test_lte: return Opcode::djs_jump_else_lte;
+            case Opcode::djs_test_gt: return Opcode::djs_jump_else_gt;
+            case Opcode::djs_test_gte: return Opcode::djs_jump_else_gte;
+            default: return {};
+        }
+    }
+
+    /**
+     * @brief Fuses common instruction sequences into superinstructions to save dispatches. Only the head of each sequence is rewritten: the tail instructions are kept in place, so code offsets & any jumps into tails stay valid while the fused head just skips past them.
+     * @note Patterns: `put_const, dup_local, add / sub` (local & constant arithmetic), `put_const, get_prop` (constant key access), and `test_*, jump_else` (compare & branch).
+     */
+    export void fuse_superinstructions(std::vector<Instruction>& code) {
+        const std::size_t code_length = code.size();
+
+        for (std::size_t code_pos = 0; code_pos + 1 < code_length; code_pos++) {
+            auto& head = code[code_pos];
+            const auto& next = code[code_pos + 1];
+
+            if (head.op == Opcode::djs_put_const && next.op == Opcode::djs_get_prop) {
+                head.op = Opcode::djs_get_prop_const;
+            } else if (head.op == Opcode::djs_put_const && next.op == Opcode::djs_dup_local && code_pos + 2 < code_length) {
+                if (const auto arith_op = code[code_pos + 2].op; arith_op == Opcode::djs_add || arith_op == Opcode::djs_sub) {
+                    head = Instruction {
+                        .args = {head.args[0], next.args[0]},
+                        .op = (arith_op == Opcode::djs_add) ? Opcode::djs_add_local_const : Opcode::djs_sub_local_const
+                    };
+                }
+            } else if (next.op == Opcode::djs_jump_else) {
+                if (const auto fused_op = fused_jump_else_of(head.op); fused_op) {
+                    //? NOTE: The jump was relative to the tail, which is 1 after this head.
+                    head = Instruction {
+                        .args = {static_cast<int16_t>(next.args[0] + 1), next.args[1]},
+                        .op = *fused_op
+                    };
+                }
+            }
+        }
+    }
+}
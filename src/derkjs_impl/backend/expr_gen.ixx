@@ -211,7 +211,15 @@ namespace DerkJS::Backend {
                     return false;
                 }
 
-                context.encode_instruction(Opcode::djs_put_prop);
+                context.encode_instruction(
+                    Opcode::djs_put_prop,
+                    Arg {
+                        .n = context.reserve_prop_cache_id(),
+                        .tag = Location::immediate,
+                        .is_str_literal = false,
+                        .from_closure = false
+                    }
+                );
             }
 
             return true;
@@ -225,8 +233,17 @@ namespace DerkJS::Backend {
         [[nodiscard]] auto emit(BytecodeEmitterContext& context, const Expr& node, const std::string& source) -> bool override {
             const auto& [items] = std::get<ArrayLiteral>(node.data);
 
+            //? NOTE: Nested literals & calls count together, as their items are all on the stack at once.
+            const int listed_count = items.size();
+
+            if (context.m_pending_items + listed_count > max_listed_items) {
+                std::println(std::cerr, "Compile Error: Array literal needs {} pending items, but at most {} are supported.", context.m_pending_items + listed_count, max_listed_items);
+                return false;
+            }
+
             // 1. Push each JS array item via evaluation.
             int item_count = 0;
+            context.m_pending_items += listed_count;
 
             for (const auto& item_expr : items) {
                 if (!context.emit_expr(*item_expr, source)) {
@@ -236,6 +253,8 @@ namespace DerkJS::Backend {
                 ++item_count;
             }
 
+            context.m_pending_items -= listed_count;
+
             // 2. Invoke this special opcode. Now there's a new array for use. :)
             context.encode_instruction(
                 Opcode::djs_make_arr,
@@ -258,6 +277,15 @@ namespace DerkJS::Backend {
         [[nodiscard]] auto emit(BytecodeEmitterContext& context, const Expr& node, const std::string& source) -> bool override {
             const auto& [lambda_params, lambda_body] = std::get<LambdaLiteral>(node.data);
             context.m_accessing_property = false;
+
+            //? NOTE: Hoisted declarations get emitted again by the main pass, but the function object from the pre-pass is just as good. Without this, nested functions would compile 2x per nesting level.
+            if (auto hoisted_lambda_it = context.m_hoisted_lambdas.find(&node); !context.m_prepass_vars && hoisted_lambda_it != context.m_hoisted_lambdas.end()) {
+                context.m_callee_name.clear();
+                context.encode_instruction(Opcode::djs_put_const, hoisted_lambda_it->second);
+
+                return true;
+            }
+
             std::string lambda_name {context.m_callee_name};
             int lambda_arity = lambda_params.size(); // named argument count
 
@@ -268,6 +296,7 @@ namespace DerkJS::Backend {
                 .block_level = 0
             });
             context.m_code_blobs.emplace_front();
+            context.m_handler_tables.emplace_front();
 
             for (const auto& [param_token, param_is_pack] : lambda_params) {
                 std::string param_name = param_token.as_string(source);
@@ -309,7 +338,9 @@ namespace DerkJS::Backend {
             const int16_t next_global_ref_const_id = context.m_consts.size();
             Arg next_global_ref_loc;
 
-            auto dud_instance_prototype_p = context.m_heap.add_item(context.m_heap.get_next_id(), std::make_unique<Object>(
+            //? NOTE: Snippets compile after `m_heap` was moved into the Program, so their prototypes go into the running VM's heap like the lambda itself.
+            auto& prototype_heap = (context.m_runtime_heap_ptr) ? *context.m_runtime_heap_ptr : context.m_heap;
+            auto dud_instance_prototype_p = prototype_heap.add_item(prototype_heap.get_next_id(), std::make_unique<Object>(
                 context.m_builtin_ptrs.at(static_cast<unsigned int>(BuiltInObjects::object))
             ));
 
@@ -318,7 +349,8 @@ namespace DerkJS::Backend {
                 std::move(context.m_code_blobs.front()),
                 context.m_builtin_ptrs.at(static_cast<unsigned int>(BuiltInObjects::function)),
                 context.m_builtin_ptrs.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key)),
-                Value {lambda_arity}
+                Value {lambda_arity},
+                std::move(context.m_handler_tables.front())
             );
 
             //? NOTE: despite std::unique_ptr<Lambda>::release(), the raw pointer is quickly re-owned in the preloaded "heap" before recording into Program.builtins later. The pre_record_object method handles this task on argument `true`.
@@ -351,9 +383,15 @@ namespace DerkJS::Backend {
             }
 
             context.m_code_blobs.pop_front();
+            context.m_handler_tables.pop_front();
             context.m_local_maps.pop_back();
             context.m_prepass_vars = old_prepass_vars_flag;
             context.m_callee_name.clear();
+
+            if (old_prepass_vars_flag) {
+                context.m_hoisted_lambdas[&node] = next_global_ref_loc;
+            }
+
             context.encode_instruction(
                 Opcode::djs_put_const,
                 next_global_ref_loc
@@ -395,19 +433,31 @@ namespace DerkJS::Backend {
             context.m_member_depth--;
             context.m_pass_key_raw = false;
 
-            /// NOTE: If assignment (lvalues apply) pass `1` for defaulting flag so the RHS goes somewhere legitimate.
+            const int16_t access_cache_id = (context.last_emitted_is_const())
+                ? context.reserve_prop_cache_id()
+                : -1;
+
+            /// NOTE: If assignment (lvalues apply) pass the defaulting flag so the RHS goes somewhere legitimate.
+            uint8_t access_flags = std::to_underlying(PropAccessFlags::none);
+
+            if (!context.m_has_call && context.m_access_as_lval) {
+                access_flags |= std::to_underlying(PropAccessFlags::should_default);
+            }
+
+            if (context.m_in_try_block) {
+                access_flags |= std::to_underlying(PropAccessFlags::in_try);
+            }
+
             context.encode_instruction(
                 Opcode::djs_get_prop,
                 Arg {
-                    .n = static_cast<int16_t>(
-                        !context.m_has_call && context.m_access_as_lval
-                    ),
+                    .n = access_cache_id,
                     .tag = Location::immediate,
                     .is_str_literal = false,
                     .from_closure = false
                 },
                 Arg {
-                    .n = static_cast<int16_t>(context.m_in_try_block),
+                    .n = static_cast<int16_t>(access_flags),
                     .tag = Location::immediate,
                     .is_str_literal = false,
                     .from_closure = false
@@ -725,6 +775,11 @@ namespace DerkJS::Backend {
             const auto& [expr_args, expr_callee] = std::get<Call>(node.data);
             const int call_argc = expr_args.size();
 
+            if (context.m_pending_items + call_argc > max_listed_items) {
+                std::println(std::cerr, "Compile Error: Call needs {} pending arguments, but at most {} are supported.", context.m_pending_items + call_argc, max_listed_items);
+                return false;
+            }
+
             context.m_has_call = true;
             context.m_access_as_lval = true;
 
@@ -744,12 +799,16 @@ namespace DerkJS::Backend {
             context.m_member_depth = 0;
             context.m_has_call = false;
 
+            context.m_pending_items += call_argc;
+
             for (const auto& arg_p : expr_args) {
                 if (!context.emit_expr(*arg_p, source)) {
                     return false;
                 }
             }
 
+            context.m_pending_items -= call_argc;
+
             if (!context.m_has_new_applied) {
                 context.encode_instruction(
                     Opcode::djs_object_call,
@@ -173,6 +173,11 @@ namespace DerkJS::Backend {
                 return false;
             }
 
+            //? NOTE: A call right before the return is in tail position, so it may reuse this frame. The VM still checks for enclosing `try` blocks, since `m_in_try_block` misses outer ones.
+            if (auto& current_code = context.m_code_blobs.front(); context.m_in_callable && !context.m_in_try_block && !current_code.empty() && current_code.back().op == Opcode::djs_object_call) {
+                current_code.back().op = Opcode::djs_tail_call;
+            }
+
             context.encode_instruction(Opcode::djs_ret);
 
             return true;
@@ -498,6 +503,7 @@ namespace DerkJS::Backend {
                 return false;
             }
 
+            const int try_begin_pos = context.m_code_blobs.front().size();
             context.m_in_try_block = true;
 
             if (!context.emit_stmt(*block_try, source)) {
@@ -509,6 +515,13 @@ namespace DerkJS::Backend {
             const int skip_catch_jump_pos = context.m_code_blobs.front().size();
             context.encode_instruction(Opcode::djs_jump);
 
+            // 2. Record the try block's handler: any nested tries were recorded first, so they still take priority.
+            context.m_handler_tables.front().emplace_back(ExceptionRange {
+                .try_begin = try_begin_pos,
+                .try_end = skip_catch_jump_pos,
+                .handler_pos = skip_catch_jump_pos + 1
+            });
+
             // 3. Emit catch block (error name 1st)...
             context.m_local_maps.back().locals[error_name_prepassed] = Arg {
                 .n = 0,
@@ -5,10 +5,13 @@ module;
 #include <memory>
 #include <string_view>
 #include <string>
+#include <cstddef>
 #include <optional>
+#include <span>
 #include <variant>
 #include <vector>
 #include <flat_map>
+#include <thread>
 
 #include <print>
 #include <iostream>
@@ -19,8 +22,10 @@ export module core.driver;
 
 export import frontend.ast;
 import frontend.parse;
+import runtime.callables;
 import runtime.vm;
 import backend.bc_generate;
+import backend.bc_cache;
 import core.polyfills;
 
 export namespace DerkJS::Core {
@@ -60,17 +65,51 @@ export namespace DerkJS::Core {
         );
     }
 
+    /**
+     * @brief A compiled script kept loaded in one VM. Once warmed up, embedders can repeatedly call its top-level functions (see `VM::run_persistent()` & `VM::call()`), or else a host can run it by time slices (see `VM::run_slice()`).
+     * @note This must not outlive the `Driver` which made it, since `Function()` snippets still use the driver's lexer, parser, & compiler.
+     */
+    class WarmScript {
+    private:
+        Program m_program;
+        VM m_vm;
+
+    public:
+        WarmScript(Program prgm, std::size_t stack_length_limit, std::size_t call_frame_limit, std::size_t gc_threshold, void* lexer_ptr, void* parser_ptr, void* compile_state_ptr)
+        : m_program (std::move(prgm)), m_vm {m_program, stack_length_limit, call_frame_limit, gc_threshold, lexer_ptr, parser_ptr, compile_state_ptr, Backend::compile_snippet_helper} {}
+
+        WarmScript(const WarmScript&) = delete;
+        WarmScript& operator=(const WarmScript&) = delete;
+
+        [[nodiscard]] auto get_vm() noexcept -> VM& {
+            return m_vm;
+        }
+
+        [[nodiscard]] auto call(std::string_view function_name, std::span<const Value> args) -> std::optional<Value> {
+            return m_vm.call(function_name, args);
+        }
+
+        [[nodiscard]] auto run_slice() -> SliceStatus {
+            return m_vm.run_slice();
+        }
+    };
+
     class Driver {
     public:
-        static constexpr std::size_t default_stack_size = 8192;
-        static constexpr std::size_t default_call_depth_limit = 384;
+        /// NOTE: The VM stack's limit in slots, as a soft memory limit: it's only reserved as address space, and it grows by segments as calls go deeper.
+        static constexpr std::size_t default_stack_limit = 1048576;
+
+        /// NOTE: Call frames reserved up front. Deeper calls just grow the frame list, since only stack slots limit the depth.
+        static constexpr std::size_t default_frame_reserve = 384;
         static constexpr std::array<std::string_view, static_cast<std::size_t>(VMErrcode::last)> error_code_msgs = {
             "",
             "ERROR: cannot access undefined property.",
             "ERROR: bad Function call or assignment operation.",
             "ERROR: heap allocation failed.",
             "ERROR: VM aborted via halt.",
+            "ERROR: stack overflow, since a call exceeded the VM stack's limit.",
             "ERROR: Uncaught error:\n\n",
+            "ERROR: VM suspended mid-script.",
             "OK",
         };
 
@@ -82,14 +121,19 @@ export namespace DerkJS::Core {
         std::flat_map<std::string_view, TokenTag> m_js_lexicals;
         std::vector<Backend::PreloadItem> m_preloads;
         std::vector<std::string> m_src_map;
+        std::string m_snapshot_path; // prelude snapshot to compile scripts on, if any
         std::string_view m_app_name;
         std::string_view m_app_author;
         ObjectBase<Value>* m_length_str_length_key_p;
         int m_version_major;
         int m_version_minor;
         int m_version_patch;
+        std::size_t m_output_flush_threshold;
         int m_max_heap_object_n;
+        FlushPolicy m_output_policy;
         bool m_allow_bytecode_dump;
+        bool m_allow_profile_report;
+        bool m_allow_gc_report;
 
         [[nodiscard]] auto read_script(const std::string& file_path) -> std::string {
             std::ifstream reader {file_path};
@@ -111,27 +155,137 @@ export namespace DerkJS::Core {
             return src_buffer.str();
         }
 
+        [[nodiscard]] auto parse_source(std::string source, const std::string& file_path) -> std::optional<ASTUnit> {
+            m_src_map.emplace_back(std::move(source));
+
+            m_lexer = Lexer {m_src_map.at(0), std::move(m_js_lexicals)};
+
+            return m_parser(m_lexer, file_path, m_src_map.at(0));
+        }
+
         [[nodiscard]] auto parse_script(const std::string& file_path) -> std::optional<ASTUnit> {
             std::string source_with_prelude;
 
-            //? SEE core/polyfills.ixx for embedded JS polyfill code.
-            source_with_prelude.append_range(polyfill_code);
+            //? SEE core/polyfills.ixx for embedded JS polyfill code. A prelude snapshot already has it compiled.
+            if (m_snapshot_path.empty()) {
+                source_with_prelude.append_range(polyfill_code);
+            }
+
             source_with_prelude.append_range(read_script(file_path));
 
-            m_src_map.emplace_back(std::move(source_with_prelude));
+            return parse_source(std::move(source_with_prelude), file_path);
+        }
 
-            m_lexer = Lexer {m_src_map.at(0), std::move(m_js_lexicals)};
+        [[nodiscard]] auto compile_script(const ASTUnit& ast) -> std::optional<Program> {
+            if (m_snapshot_path.empty()) {
+                return m_compile_state.compile_script(std::move(m_preloads), m_max_heap_object_n, ast, m_src_map);
+            }
 
-            return m_parser(m_lexer, file_path, m_src_map.at(0));
+            Backend::MappedCacheFile snapshot_file {m_snapshot_path};
+
+            if (!snapshot_file.is_mapped()) {
+                std::println(std::cerr, "NOTE: could not map prelude snapshot: '{}'", m_snapshot_path);
+                return {};
+            }
+
+            auto prgm = m_compile_state.compile_script_on_prelude(std::move(m_preloads), m_max_heap_object_n, snapshot_file.view(), ast, m_src_map);
+
+            if (!prgm) {
+                std::println(std::cerr, "NOTE: could not load prelude snapshot: '{}', so please remake it with `-s`.", m_snapshot_path);
+            }
+
+            return prgm;
         }
 
-        [[nodiscard]] auto compile_script(const ASTUnit& ast) -> std::optional<Program> {
-            return m_compile_state.compile_script(std::move(m_preloads), m_max_heap_object_n, ast, m_src_map);
+        [[nodiscard]] auto execute(Program& prgm, std::size_t gc_threshold) -> int {
+            if (m_allow_bytecode_dump) {
+                disassemble_program(prgm);
+            }
+
+            DerkJS::VM vm {
+                prgm,
+                default_stack_limit, default_frame_reserve, gc_threshold,
+                &m_lexer, &m_parser, &m_compile_state, Backend::compile_snippet_helper
+            };
+            vm.set_output_policy(m_output_policy, m_output_flush_threshold);
+
+            //? NOTE: Without a time slice, the first slice runs the top-level code through. Later slices only run the queued jobs, sleeping while just timers are left.
+            for (auto slice_status = vm.run_slice(); slice_status != SliceStatus::done && slice_status != SliceStatus::failed; slice_status = vm.run_slice()) {
+                if (const auto wake_time = vm.next_wake_time(); slice_status == SliceStatus::waiting && wake_time) {
+                    std::this_thread::sleep_until(*wake_time);
+                }
+            }
+
+            if (m_allow_profile_report) {
+                report_profile(prgm, vm);
+            }
+
+            if (m_allow_gc_report) {
+                vm.dump_gc_stats();
+            }
+
+            return report_status(vm);
+        }
+
+        /// NOTE: Prints the profiler's hot opcodes, functions, & sites, labeling functions by their heap slot. `DERKJS_JIT` builds also label them with their tier-up call counts.
+        void report_profile(const Program& prgm, VM& vm) {
+            if constexpr (!profiling_built_in) {
+                std::println(std::cerr, "NOTE: profiling needs a build configured with -DDERKJS_PROFILE=ON.");
+                return;
+            }
+
+            auto& profiler = vm.get_profiler();
+            profiler.stop();
+            vm.flush_output();
+
+            std::flat_map<const Instruction*, std::string> fn_names;
+            fn_names[prgm.code.data()] = "top-level";
+
+            for (int heap_id = 0; const auto& heap_cell : vm.m_ctx.heap.view_items()) {
+                if (auto lambda_p = dynamic_cast<const Lambda*>(heap_cell.get()); lambda_p) {
+                    if constexpr (jit_counters_built_in) {
+                        fn_names[lambda_p->view_code().data()] = std::format("function@heap-cell:{} (calls: {}{})", heap_id, lambda_p->get_call_count(), lambda_p->is_hot() ? ", hot" : "");
+                    } else {
+                        fn_names[lambda_p->view_code().data()] = std::format("function@heap-cell:{}", heap_id);
+                    }
+                }
+
+                ++heap_id;
+            }
+
+            profiler.print_report(fn_names);
         }
 
     public:
+        /// NOTE: Prints any VM failure after the script's own output, giving the script's exit status.
+        [[nodiscard]] auto report_status(VM& vm) -> int {
+            vm.flush_output();
+
+            switch (const auto vm_status = vm.peek_status(); vm_status) {
+            case VMErrcode::pending:
+            case VMErrcode::suspended:
+            case VMErrcode::bad_property_access:
+            case VMErrcode::bad_operation:
+            case VMErrcode::bad_heap_alloc:
+            case VMErrcode::vm_abort:
+            case VMErrcode::stack_overflow:
+                std::println(std::cerr, "{}", error_code_msgs.at(static_cast<int>(vm_status)));
+                return 1;
+            case VMErrcode::uncaught_error:
+                std::println(
+                    std::cerr, "{}\n{}",
+                    error_code_msgs.at(static_cast<int>(vm_status)),
+                    stringify_uncaught_error(vm.peek_leftover_error().to_object())
+                );
+                return 1;
+            case VMErrcode::ok:
+            default:
+                return 0;
+            }
+        }
+
         Driver(DriverInfo info, int max_heap_object_count)
-        : m_compile_state {}, m_parser {}, m_lexer {}, m_js_lexicals {}, m_src_map {}, m_app_name {info.name}, m_app_author {info.author}, m_length_str_length_key_p {}, m_version_major {info.version_major}, m_version_minor {info.version_minor}, m_version_patch {info.version_patch}, m_max_heap_object_n {max_heap_object_count}, m_allow_bytecode_dump {false} {
+        : m_compile_state {}, m_parser {}, m_lexer {}, m_js_lexicals {}, m_src_map {}, m_snapshot_path {}, m_app_name {info.name}, m_app_author {info.author}, m_length_str_length_key_p {}, m_version_major {info.version_major}, m_version_minor {info.version_minor}, m_version_patch {info.version_patch}, m_output_flush_threshold {ConsoleIO::default_flush_threshold}, m_max_heap_object_n {max_heap_object_count}, m_output_policy {default_flush_policy()}, m_allow_bytecode_dump {false}, m_allow_profile_report {false}, m_allow_gc_report {false} {
             // 1.1: hack in "length" here as a special key that could be used for strings (but also arrays).
             auto length_str_length_key_p = std::make_unique<DynamicString>(nullptr, Value {nullptr}, std::string {"length"}); // the property name value string itself- only to check against!
             m_length_str_length_key_p = length_str_length_key_p.get();
@@ -249,10 +403,31 @@ export namespace DerkJS::Core {
             });
         }
 
+        /// NOTE: Sets how later VMs flush console output. See `ConsoleIO`.
+        void set_output_policy(FlushPolicy policy, std::size_t flush_threshold = ConsoleIO::default_flush_threshold) noexcept {
+            m_output_policy = policy;
+            m_output_flush_threshold = flush_threshold;
+        }
+
         void enable_bc_dump(bool flag) noexcept {
             m_allow_bytecode_dump = flag;
         }
 
+        /// NOTE: Makes later runs print the GC's stats after the script, see `GC::print_report()`.
+        void enable_gc_report(bool flag) noexcept {
+            m_allow_gc_report = flag;
+        }
+
+        /// NOTE: Makes later runs print a profile report after the script, see `OpProfiler`.
+        void enable_profile_report(bool flag) noexcept {
+            m_allow_profile_report = flag;
+        }
+
+        /// NOTE: Makes later `run()` & `emit_cache()` calls compile scripts on a prelude snapshot from `emit_prelude_snapshot()`, instead of re-compiling the polyfills.
+        void use_prelude_snapshot(std::string snapshot_path) {
+            m_snapshot_path = std::move(snapshot_path);
+        }
+
         [[nodiscard]] auto get_info() const noexcept -> DriverInfo {
             return DriverInfo {m_app_name, m_app_author, m_version_major, m_version_minor, m_version_patch};
         }
@@ -271,38 +446,130 @@ export namespace DerkJS::Core {
                 return 1;
             }
 
-            if (m_allow_bytecode_dump) {
-                disassemble_program(prgm.value());
+            return execute(prgm.value(), gc_threshold);
+        }
+
+        /// NOTE: Compiles the script as usual, but saves the program to a bytecode cache instead of running it. See `./src/derkjs_impl/backend/bc_cache.ixx`.
+        [[nodiscard]] auto emit_cache(const std::string& file_path, const std::string& cache_path) -> int {
+            auto script_ast = parse_script(file_path);
+
+            if (!script_ast) {
+                return 1;
             }
 
-            auto& prgm_ref = prgm.value();
-            DerkJS::VM vm {
-                prgm_ref,
-                default_stack_size, default_call_depth_limit, gc_threshold,
-                &m_lexer, &m_parser, &m_compile_state, Backend::compile_snippet_helper
-            };
+            auto prgm = compile_script(script_ast.value());
 
-            vm.run();
+            if (!prgm) {
+                return 1;
+            }
 
-            switch (const auto vm_status = vm.peek_status(); vm_status) {
-            case VMErrcode::pending:
-            case VMErrcode::bad_property_access:
-            case VMErrcode::bad_operation:
-            case VMErrcode::bad_heap_alloc:
-            case VMErrcode::vm_abort:
-                std::println(std::cerr, "{}", error_code_msgs.at(static_cast<int>(vm_status)));
+            return (Backend::write_program_cache(prgm.value(), cache_path)) ? 0 : 1;
+        }
+
+        /// NOTE: Compiles just the built-in polyfills on top of the native preloads, saving the compiler state as a prelude snapshot.
+        [[nodiscard]] auto emit_prelude_snapshot(const std::string& snapshot_path) -> int {
+            std::string prelude_source;
+            prelude_source.append_range(polyfill_code);
+
+            auto prelude_ast = parse_source(std::move(prelude_source), "prelude");
+
+            if (!prelude_ast) {
                 return 1;
-            case VMErrcode::uncaught_error:
-                std::println(
-                    std::cerr, "{}\n{}",
-                    error_code_msgs.at(static_cast<int>(vm_status)),
-                    stringify_uncaught_error(vm.peek_leftover_error().to_object())
-                );
+            }
+
+            return (m_compile_state.snapshot_prelude(std::move(m_preloads), m_max_heap_object_n, prelude_ast.value(), m_src_map, snapshot_path)) ? 0 : 1;
+        }
+
+        /**
+         * @brief Compiles & runs the script's top-level code once, then keeps the VM warm for calls into the script from C++. Setup costs are only paid here instead of per call.
+         * @return The warm script, or `nullptr` if it failed to compile or its top-level code failed.
+         */
+        [[nodiscard]] auto load_warm(const std::string& file_path, std::size_t gc_threshold) -> std::unique_ptr<WarmScript> {
+            auto warm_script = load_script(file_path, gc_threshold);
+
+            if (!warm_script) {
+                return {};
+            }
+
+            if (!warm_script->get_vm().run_persistent()) {
+                [[maybe_unused]] const auto status = report_status(warm_script->get_vm());
+                return {};
+            }
+
+            return warm_script;
+        }
+
+        /// NOTE: Compiles the script into a loaded VM without running anything yet, e.g for a host to run it by `WarmScript::run_slice()`.
+        [[nodiscard]] auto load_script(const std::string& file_path, std::size_t gc_threshold) -> std::unique_ptr<WarmScript> {
+            auto script_ast = parse_script(file_path);
+
+            if (!script_ast) {
+                return {};
+            }
+
+            auto prgm = compile_script(script_ast.value());
+
+            if (!prgm) {
+                return {};
+            }
+
+            auto script = std::make_unique<WarmScript>(
+                std::move(prgm.value()),
+                default_stack_limit, default_frame_reserve, gc_threshold,
+                &m_lexer, &m_parser, &m_compile_state
+            );
+            script->get_vm().set_output_policy(m_output_policy, m_output_flush_threshold);
+
+            return script;
+        }
+
+        /// NOTE: Compiles the script into an in-memory bytecode cache. This image is immutable, so isolates on other threads can each run it via `run_image()`.
+        [[nodiscard]] auto compile_image(const std::string& file_path) -> std::optional<std::vector<std::byte>> {
+            auto script_ast = parse_script(file_path);
+
+            if (!script_ast) {
+                return {};
+            }
+
+            auto prgm = compile_script(script_ast.value());
+
+            if (!prgm) {
+                return {};
+            }
+
+            return Backend::encode_program_cache(prgm.value());
+        }
+
+        /// NOTE: Runs a program from bytecode cache bytes, giving no status if they don't load. This skips lexing, parsing, & compiling the prelude & script. Only the native preloads get rebuilt, so this driver's VM, heap, & GC share nothing with other drivers.
+        [[nodiscard]] auto run_image(std::span<const std::byte> image_bytes, std::size_t gc_threshold) -> std::optional<int> {
+            //? NOTE: `Function()` snippets still need a configured lexer.
+            m_src_map.emplace_back();
+            m_lexer = Lexer {m_src_map.at(0), std::move(m_js_lexicals)};
+
+            auto prgm = m_compile_state.load_cached_script(std::move(m_preloads), m_max_heap_object_n, image_bytes);
+
+            if (!prgm) {
+                return {};
+            }
+
+            return execute(prgm.value(), gc_threshold);
+        }
+
+        /// NOTE: Runs a program from a bytecode cache file. See `run_image()`.
+        [[nodiscard]] auto run_cached(const std::string& cache_path, std::size_t gc_threshold) -> int {
+            Backend::MappedCacheFile cache_file {cache_path};
+
+            if (!cache_file.is_mapped()) {
+                std::println(std::cerr, "NOTE: could not map bytecode cache: '{}'", cache_path);
                 return 1;
-            case VMErrcode::ok:
-            default:
-                return 0;
             }
+
+            if (const auto status = run_image(cache_file.view(), gc_threshold); status) {
+                return *status;
+            }
+
+            std::println(std::cerr, "NOTE: could not load bytecode cache: '{}'", cache_path);
+            return 1;
         }
     };
 }
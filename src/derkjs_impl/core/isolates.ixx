@@ -0,0 +1,180 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <thread>
+#include <print>
+#include <iostream>
+
+export module core.isolates;
+
+import runtime.vm;
+import core.driver;
+
+export namespace DerkJS::Core {
+    /// NOTE: Configures a fresh driver with its lexicals, emitters, & natives. Every isolate calls this on its own thread, so it must make new native objects per call.
+    using DriverSetup = void(*)(Driver&);
+
+    /// NOTE: A compiled script as bytecode cache bytes. It's never written after `IsolatePool::compile()`, so all isolates just share it.
+    using SharedImage = std::shared_ptr<const std::vector<std::byte>>;
+
+    /**
+     * @brief Runs scripts in isolates over a pool of worker threads. Each isolate is a `Driver` owning its VM, `ExternVMCtx`, heap, GC, and `Function()` compiler state, which are only touched by the thread running it.
+     * @note Heap objects must not cross isolates: the slab arenas & property shapes behind them are per-thread.
+     */
+    class IsolatePool {
+    private:
+        DriverInfo m_info;
+        DriverSetup m_setup;
+        std::size_t m_thread_count;
+        int m_max_heap_object_n;
+
+    public:
+        IsolatePool(DriverInfo info, DriverSetup setup, int max_heap_object_count, std::size_t thread_count = std::thread::hardware_concurrency())
+        : m_info {info}, m_setup {setup}, m_thread_count {std::max(thread_count, std::size_t {1})}, m_max_heap_object_n {max_heap_object_count} {}
+
+        [[nodiscard]] auto get_thread_count() const noexcept -> std::size_t {
+            return m_thread_count;
+        }
+
+        /// NOTE: Compiles the script once on the calling thread for sharing by later `run()` calls.
+        [[nodiscard]] auto compile(const std::string& file_path) -> SharedImage {
+            Driver driver {m_info, m_max_heap_object_n};
+            m_setup(driver);
+
+            if (auto image = driver.compile_image(file_path); image) {
+                return std::make_shared<const std::vector<std::byte>>(std::move(*image));
+            }
+
+            return {};
+        }
+
+        /**
+         * @brief Runs the image `run_count` times, with each run in a new isolate. Workers claim runs until none are left.
+         * @return The exit status of each run by order.
+         */
+        [[nodiscard]] auto run(SharedImage image, std::size_t run_count, std::size_t gc_threshold) -> std::vector<int> {
+            std::vector<int> statuses (run_count, 1);
+
+            if (!image) {
+                return statuses;
+            }
+
+            std::atomic<std::size_t> next_run_id {0};
+
+            {
+                std::vector<std::jthread> workers;
+                const auto worker_count = std::min(m_thread_count, run_count);
+
+                for (std::size_t worker_id = 0; worker_id < worker_count; worker_id++) {
+                    workers.emplace_back([&, this]() {
+                        for (auto run_id = next_run_id.fetch_add(1); run_id < run_count; run_id = next_run_id.fetch_add(1)) {
+                            Driver isolate {m_info, m_max_heap_object_n};
+                            m_setup(isolate);
+
+                            if (const auto status = isolate.run_image(*image, gc_threshold); status) {
+                                statuses[run_id] = *status;
+                            } else {
+                                std::println(std::cerr, "NOTE: isolate {} could not load the shared program.", run_id);
+                            }
+                        }
+                    });
+                }
+            } // workers join here
+
+            return statuses;
+        }
+    };
+
+    /**
+     * @brief Multiplexes many isolates on the calling thread by time slices: each `run_all()` round gives every unfinished script one `VM::run_slice()`. While all scripts only wait on timers, the thread sleeps until the earliest one is due, so their waits overlap.
+     * @note Blocking natives like `nativeReadLine()` still stall every script here.
+     */
+    class IsolateScheduler {
+    private:
+        struct SlicedTask {
+            std::unique_ptr<Driver> driver; // must outlive its script, which uses the driver's compiler for `Function()`
+            std::unique_ptr<WarmScript> script;
+        };
+
+        DriverInfo m_info;
+        DriverSetup m_setup;
+        std::vector<SlicedTask> m_tasks;
+        int m_max_heap_object_n;
+        int32_t m_slice_budget;
+
+    public:
+        static constexpr int32_t default_slice_budget = 1000;
+
+        IsolateScheduler(DriverInfo info, DriverSetup setup, int max_heap_object_count, int32_t slice_budget = default_slice_budget)
+        : m_info {info}, m_setup {setup}, m_tasks {}, m_max_heap_object_n {max_heap_object_count}, m_slice_budget {slice_budget} {}
+
+        /// NOTE: Compiles the script into a new isolate, which only starts running in `run_all()`.
+        [[nodiscard]] auto add(const std::string& file_path, std::size_t gc_threshold) -> bool {
+            auto driver = std::make_unique<Driver>(m_info, m_max_heap_object_n);
+            m_setup(*driver);
+
+            auto script = driver->load_script(file_path, gc_threshold);
+
+            if (!script) {
+                return false;
+            }
+
+            script->get_vm().set_time_slice(m_slice_budget);
+            m_tasks.emplace_back(SlicedTask {std::move(driver), std::move(script)});
+
+            return true;
+        }
+
+        /// @return The exit status of each script by order of `add()` calls.
+        [[nodiscard]] auto run_all() -> std::vector<int> {
+            std::vector<int> statuses (m_tasks.size(), 0);
+            std::vector<bool> finished (m_tasks.size(), false);
+            std::size_t finished_count = 0;
+
+            while (finished_count < m_tasks.size()) {
+                std::optional<std::chrono::steady_clock::time_point> earliest_wake;
+                bool any_ran = false;
+
+                for (std::size_t task_id = 0; task_id < m_tasks.size(); task_id++) {
+                    if (finished[task_id]) {
+                        continue;
+                    }
+
+                    auto& [driver, script] = m_tasks[task_id];
+
+                    switch (script->run_slice()) {
+                    case SliceStatus::running:
+                        any_ran = true;
+                        break;
+                    case SliceStatus::waiting:
+                        if (const auto wake_time = script->get_vm().next_wake_time(); wake_time && (!earliest_wake || *wake_time < *earliest_wake)) {
+                            earliest_wake = wake_time;
+                        }
+                        break;
+                    case SliceStatus::done:
+                    case SliceStatus::failed:
+                    default:
+                        statuses[task_id] = driver->report_status(script->get_vm());
+                        finished[task_id] = true;
+                        finished_count++;
+                        break;
+                    }
+                }
+
+                if (!any_ran && earliest_wake) {
+                    std::this_thread::sleep_until(*earliest_wake);
+                }
+            }
+
+            return statuses;
+        }
+    };
+}
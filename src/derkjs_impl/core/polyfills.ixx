@@ -151,22 +151,6 @@ namespace DerkJS::Core {
         "this.length = this.length - 1;\n"
         "return old;\n"
     "};\n"
-    "Array.prototype.indexOf = function (item, fromIndex) {\n"
-        "var pos = fromIndex;\n"
-        "var end = this.length;\n"
-        "var result = -1;\n"
-        "if (!pos || pos < 0) {\n"
-            "pos = 0;\n"
-        "}\n"
-        "while (pos < end) {\n"
-            "if (this.at(pos) === item) {\n"
-                "result = pos;\n"
-                "break;\n"
-            "}\n"
-            "++pos;\n"
-        "}\n"
-        "return result;\n"
-    "};\n"
     "Array.prototype.lastIndexOf = function (item, fromIndex) {\n"
         "var pos;\n"
         "var end = -1;\n"
@@ -203,21 +187,6 @@ namespace DerkJS::Core {
         "}\n"
         "return this;\n"
     "};\n"
-    "Array.prototype.forEach = function (callbackFn, thisArg) {\n"
-        "for (var i = 0, end = this.length; i < end; ++i) {\n"
-            "var discard = callbackFn.call(thisArg, this[i], i, this);\n"
-        "}\n"
-        "return undefined;\n"
-    "};\n"
-    "Array.prototype.some = function(callbackFn, thisArg) {\n"
-    "for (var i = 0, end = this.length; i < end; ++i) {\n"
-        "var temp = this[i];\n"
-        "if (temp !== undefined) {\n"
-            "if (callbackFn.call(thisArg, temp, i, this)) return true;\n"
-        "}\n"
-    "}\n"
-    "return false;\n"
-    "};\n"
     "Array.prototype.every = function(callbackFn, thisArg) {\n"
     "for (var i = 0, end = this.length; i < end; ++i) {\n"
         "var temp = this[i];\n"
@@ -227,26 +196,6 @@ namespace DerkJS::Core {
     "}\n"
     "return true;\n"
     "};\n"
-    "Array.prototype.map = function (callbackFn, thisArg) {\n"
-        "var a = [];\n"
-        "for (var i = 0, end = this.length; i < end; ++i) {\n"
-            "var temp = this[i];\n"
-            "if (temp !== undefined) {\n"
-                "var discard = a.push(callbackFn.call(thisArg, this[i], i , this));\n"
-            "}\n"
-        "}\n"
-        "return a;\n"
-    "};\n"
-    "Array.prototype.filter = function (predicateFn, thisArg) {\n"
-        "var a = [];\n"
-        "for (var i = 0, end = this.length; i < end; ++i) {\n"
-            "var item = this[i];\n"
-            "if (item !== undefined) {\n"
-                "if (predicateFn.call(thisArg, item, i, this)) a.push(item);\n"
-            "}\n"
-        "}\n"
-        "return a;\n"
-    "};\n"
     "Array.prototype.toString = function () {\n"
         "if (typeof this.join === 'function') {\n"
             "return this.join();\n"
@@ -276,6 +225,7 @@ namespace DerkJS::Core {
         "return discard; // undefined\n"
     "};\n"
     "console.readln = nativeReadLine;\n"
+    "console.flush = nativeFlush;\n"
     "Object.freeze(Object);\n"
     "Object.freeze(Boolean);\n"
     "Object.freeze(Number);\n"
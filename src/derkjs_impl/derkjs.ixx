@@ -3,6 +3,7 @@ export module derkjs_impl;
 export import runtime.value;
 export import runtime.object;
 export import runtime.callables;
+export import runtime.console_io;
 export import runtime.intrinsics.routines;
 export import runtime.intrinsics.boolean_natives;
 export import runtime.intrinsics.number_natives;
@@ -14,3 +15,4 @@ export import runtime.intrinsics.conversions;
 export import backend.expr_gen;
 export import backend.stmt_gen;
 export import core.driver;
+export import core.isolates;
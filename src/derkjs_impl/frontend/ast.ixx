@@ -1,8 +1,11 @@
 module;
 
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <variant>
+#include <string>
 
 export module frontend.ast;
 
@@ -62,6 +65,20 @@ export namespace DerkJS {
         ast_op_minus_assign,
     };
 
+    /// BEGIN ARENA SUPPORT ///
+
+    /// NOTE: AST nodes are placed into their `ASTUnit`'s arena, so "deleting" one only runs its destructor. The arena itself releases all node memory in bulk.
+    struct AstNodeDeleter {
+        template <typename T>
+        void operator()(T* node_p) const noexcept {
+            std::destroy_at(node_p);
+        }
+    };
+
+    /// NOTE: child lists of AST nodes, which the parser also backs by the unit's arena.
+    template <typename T>
+    using AstList = std::pmr::vector<T>;
+
     /// BEGIN FORWARD DECLS ///
 
     template <typename ... StmtKind>
@@ -93,7 +110,7 @@ export namespace DerkJS {
     struct TryCatch;
 
     using Stmt = StmtNode<ExprStmt, Variables, If, Return, While, ForStepped, Break, Continue, Block, Throw, TryCatch>;
-    using StmtPtr = std::unique_ptr<Stmt>;
+    using StmtPtr = std::unique_ptr<Stmt, AstNodeDeleter>;
 
     template <typename ... ExprKind>
     struct ExprNode {
@@ -115,7 +132,7 @@ export namespace DerkJS {
     struct Call;
 
     using Expr = ExprNode<Primitive, ObjectLiteral, ArrayLiteral, LambdaLiteral, MemberAccess, Unary, Binary, Assign, Call>;
-    using ExprPtr = std::unique_ptr<Expr>;
+    using ExprPtr = std::unique_ptr<Expr, AstNodeDeleter>;
 
     /// BEGIN NODE DEFINITIONS ///
 
@@ -130,15 +147,15 @@ export namespace DerkJS {
     };
 
     struct ObjectLiteral {
-        std::vector<ObjectField> fields;
+        AstList<ObjectField> fields;
     };
 
     struct ArrayLiteral {
-        std::vector<ExprPtr> items;
+        AstList<ExprPtr> items;
     };
 
     struct LambdaLiteral {
-        std::vector<Param> params;
+        AstList<Param> params;
         StmtPtr body;
     };
 
@@ -165,7 +182,7 @@ export namespace DerkJS {
     };
 
     struct Call {
-        std::vector<ExprPtr> args;
+        AstList<ExprPtr> args;
         ExprPtr callee;
     };
 
@@ -180,7 +197,7 @@ export namespace DerkJS {
     };
     
     struct Variables {
-        std::vector<VarDecl> vars;
+        AstList<VarDecl> vars;
     };
 
     struct Return {
@@ -211,7 +228,7 @@ export namespace DerkJS {
     };
 
     struct Block {
-        std::vector<StmtPtr> items;
+        AstList<StmtPtr> items;
     };
 
     struct Throw {
@@ -233,5 +250,58 @@ export namespace DerkJS {
         int src_id;
     };
 
-    using ASTUnit = std::vector<SourcedAst>;
+    /**
+     * @brief Owns a parsed program's top-level declarations along with the arena holding all of their nodes. The arena is heap-held so node addresses survive moving the unit, and it's declared before the declarations so it's released last.
+     */
+    class ASTUnit {
+    public:
+        using value_type = SourcedAst;
+
+        static constexpr std::size_t default_arena_chunk_size = 64 * 1024;
+
+    private:
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> m_arena;
+        std::vector<SourcedAst> m_decls;
+
+    public:
+        ASTUnit()
+        : m_arena {std::make_unique<std::pmr::monotonic_buffer_resource>(default_arena_chunk_size)}, m_decls {} {}
+
+        ASTUnit(ASTUnit&&) noexcept = default;
+
+        /// NOTE: The old nodes live in the old arena, so they must be destroyed before it is released. A defaulted move would replace `m_arena` 1st since it's declared before `m_decls`.
+        auto operator=(ASTUnit&& other) noexcept -> ASTUnit& {
+            if (this != &other) {
+                m_decls.clear();
+                m_arena = std::move(other.m_arena);
+                m_decls = std::move(other.m_decls);
+            }
+
+            return *this;
+        }
+
+        [[nodiscard]] auto arena() noexcept -> std::pmr::memory_resource* {
+            return m_arena.get();
+        }
+
+        void emplace_back(SourcedAst decl) {
+            m_decls.emplace_back(std::move(decl));
+        }
+
+        [[nodiscard]] auto at(std::size_t pos) const -> const SourcedAst& {
+            return m_decls.at(pos);
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t {
+            return m_decls.size();
+        }
+
+        [[nodiscard]] auto begin() const noexcept {
+            return m_decls.begin();
+        }
+
+        [[nodiscard]] auto end() const noexcept {
+            return m_decls.end();
+        }
+    };
 }
\ No newline at end of file
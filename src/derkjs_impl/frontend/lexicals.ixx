@@ -175,7 +175,7 @@ export namespace DerkJS {
             ++m_pos;
         }
 
-        [[nodiscard]] auto lex_single(const std::string& source, TokenTag tag) noexcept -> Token {
+        [[nodiscard]] auto lex_single(std::string_view source, TokenTag tag) noexcept -> Token {
             const auto temp_start = m_pos;
             const auto temp_line = m_line;
             const auto temp_column = m_column;
@@ -190,7 +190,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto eat_escape_sequence(const std::string& source) noexcept -> bool {
+        [[nodiscard]] auto eat_escape_sequence(std::string_view source) noexcept -> bool {
             const auto temp_offset = m_pos;
             auto is_simple_escape = true;
 
@@ -225,7 +225,7 @@ export namespace DerkJS {
             return true;
         }
 
-        [[nodiscard]] auto lex_string(const std::string& source, char delim) noexcept -> Token {
+        [[nodiscard]] auto lex_string(std::string_view source, char delim) noexcept -> Token {
             const auto temp_start = m_pos;
             const auto temp_line = m_line;
             const auto temp_column = m_column;
@@ -269,7 +269,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto lex_whitespace(const std::string& source) noexcept -> Token {
+        [[nodiscard]] auto lex_whitespace(std::string_view source) noexcept -> Token {
             const auto temp_start = m_pos;
             auto temp_length = 0;
             const auto temp_line = m_line;
@@ -293,7 +293,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto lex_line_comment(const std::string& source) noexcept -> Token {
+        [[nodiscard]] auto lex_line_comment(std::string_view source) noexcept -> Token {
             auto temp_start = m_pos;
             auto temp_length = 0;
             const auto temp_line = m_line;
@@ -322,7 +322,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto lex_block_comment(const std::string& source) noexcept -> Token {
+        [[nodiscard]] auto lex_block_comment(std::string_view source) noexcept -> Token {
             auto temp_start = m_pos;
             auto temp_length = 0;
             const auto temp_line = m_line;
@@ -352,7 +352,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto lex_dot_cluster(const std::string& source) noexcept -> Token {
+        [[nodiscard]] auto lex_dot_cluster(std::string_view source) noexcept -> Token {
             auto temp_start = m_pos;
             auto temp_length = 0;
             const auto temp_line = m_line;
@@ -384,7 +384,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto lex_numeric(const std::string& source) noexcept -> Token {
+        [[nodiscard]] auto lex_numeric(std::string_view source) noexcept -> Token {
             auto temp_start = m_pos;
             auto temp_length = 0;
             const auto temp_line = m_line;
@@ -424,7 +424,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto lex_word(const std::string& source) noexcept -> Token {
+        [[nodiscard]] auto lex_word(std::string_view source) noexcept -> Token {
             auto temp_start = m_pos;
             auto temp_length = 0;
             const auto temp_line = m_line;
@@ -455,7 +455,7 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto lex_operator(const std::string& source) noexcept -> Token {
+        [[nodiscard]] auto lex_operator(std::string_view source) noexcept -> Token {
             auto temp_start = m_pos;
             auto temp_length = 0;
             const auto temp_line = m_line;
@@ -500,7 +500,7 @@ export namespace DerkJS {
             m_column = 1;
         }
 
-        [[nodiscard]] auto operator()(const std::string& source) -> Token {
+        [[nodiscard]] auto operator()(std::string_view source) -> Token {
             if (at_eof()) {
                 return {TokenTag::eof, 0, m_line, m_column};
             }
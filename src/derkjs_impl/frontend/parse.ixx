@@ -1,11 +1,14 @@
 module;
 
 #include <utility>
+#include <new>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <variant>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <iostream>
 #include <print>
@@ -66,13 +69,14 @@ export namespace DerkJS {
 
     class Parser {
     private:
+        std::pmr::memory_resource* m_arena_p;
         Token m_previous;
         Token m_current;
         int m_error_count;
         SyntaxTag m_syntax;
         bool m_primitive_as_key;
 
-        void report_syntax_error(const std::string& source, std::string msg, Token culprit) noexcept(false) {
+        void report_syntax_error(std::string_view source, std::string msg, Token culprit) noexcept(false) {
             const auto [culprit_tag, culprit_start, culprit_length, culprit_line, culprit_column] = culprit;
 
             ++m_error_count;
@@ -82,15 +86,23 @@ export namespace DerkJS {
                 culprit_line,
                 culprit_column,
                 msg,
-                culprit.as_string(source)
+                culprit.as_str(source)
             )};
         }
 
+        /// NOTE: Places an AST node into the current unit's arena.
+        template <typename Node, typename ... Args>
+        [[nodiscard]] auto make_node(Args&& ... args) -> std::unique_ptr<Node, AstNodeDeleter> {
+            void* node_mem_p = m_arena_p->allocate(sizeof(Node), alignof(Node));
+
+            return std::unique_ptr<Node, AstNodeDeleter> {::new (node_mem_p) Node (std::forward<Args>(args)...)};
+        }
+
         [[nodiscard]] auto at_eof() const noexcept -> bool {
             return m_current.tag == TokenTag::eof;
         }
 
-        [[nodiscard]] auto advance(Lexer& lexer, const std::string& source) -> Token {
+        [[nodiscard]] auto advance(Lexer& lexer, std::string_view source) -> Token {
             Token temp;
 
             do {
@@ -106,12 +118,12 @@ export namespace DerkJS {
             return temp;
         }
 
-        void consume_any(Lexer& lexer, const std::string& source) {
+        void consume_any(Lexer& lexer, std::string_view source) {
             m_previous = m_current;
             m_current = advance(lexer, source);
         }
 
-        void consume(Lexer& lexer, const std::string& source, std::same_as<TokenTag> auto first, std::same_as<TokenTag> auto ... more) {
+        void consume(Lexer& lexer, std::string_view source, std::same_as<TokenTag> auto first, std::same_as<TokenTag> auto ... more) {
             if (m_current.match_tag_to(first, more...) && !m_current.match_tag_to(TokenTag::unknown)) {
                 m_previous = m_current;
                 m_current = advance(lexer, source);
@@ -126,7 +138,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_primary(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_primary(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_primary;
 
             const auto current_token_tag = m_current.tag;
@@ -148,7 +160,7 @@ export namespace DerkJS {
             case TokenTag::literal_escaped_string:
                 consume_any(lexer, source);
 
-                return std::make_unique<Expr>(
+                return make_node<Expr>(
                     Primitive { .token = current_token_copy, .is_key = m_primitive_as_key },
                     0, // NOTE: `src_id` is 0 since I'll only support single-file JS programs for now.
                     snippet_begin,
@@ -177,7 +189,7 @@ export namespace DerkJS {
             std::unreachable();
         }
 
-        [[nodiscard]] auto parse_field(Lexer& lexer, const std::string& source) -> ObjectField {
+        [[nodiscard]] auto parse_field(Lexer& lexer, std::string_view source) -> ObjectField {
             consume(lexer, source, TokenTag::identifier); // TODO: add string key support for object fields!
 
             Token field_name = m_previous;
@@ -190,16 +202,16 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto parse_object(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_object(Lexer& lexer, std::string_view source) -> ExprPtr {
             const auto object_lexeme_begin = m_current.start;
             consume_any(lexer, source); // eat pre-checked '{' since this is only called from parse_primary()
 
-            std::vector<ObjectField> fields;
+            AstList<ObjectField> fields {m_arena_p};
 
             if (m_current.match_tag_to(TokenTag::right_brace)) {
                 consume_any(lexer, source);
 
-                return std::make_unique<Expr>(
+                return make_node<Expr>(
                     ObjectLiteral {
                         .fields = std::move(fields)
                     },
@@ -222,7 +234,7 @@ export namespace DerkJS {
                 fields.emplace_back(parse_field(lexer, source));
             }
 
-            return std::make_unique<Expr>(
+            return make_node<Expr>(
                 ObjectLiteral {
                     .fields = std::move(fields)
                 },
@@ -233,12 +245,12 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_array(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_array(Lexer& lexer, std::string_view source) -> ExprPtr {
             // ArrayLiteral
             const auto array_lexeme_begin = m_current.start;
             consume_any(lexer, source); // eat pre-checked '[' since this is only called by parse_primary()
 
-            std::vector<ExprPtr> temp_items;
+            AstList<ExprPtr> temp_items {m_arena_p};
 
             if (!m_current.match_tag_to(TokenTag::right_bracket)) {
                 temp_items.emplace_back(parse_logical_or(lexer, source));
@@ -256,7 +268,7 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::right_bracket);
 
-            return std::make_unique<Expr>(
+            return make_node<Expr>(
                 ArrayLiteral {
                     .items = std::move(temp_items)
                 },
@@ -267,7 +279,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_param(Lexer& lexer, const std::string& source) -> Param {
+        [[nodiscard]] auto parse_param(Lexer& lexer, std::string_view source) -> Param {
             const auto snippet_begin = m_current.start;
             const auto is_rest_param = m_current.match_tag_to(TokenTag::elipses);
 
@@ -283,11 +295,11 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto parse_lambda(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_lambda(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_lambda;
 
             const auto snippet_begin = m_current.start;
-            std::vector<Param> param_list;
+            AstList<Param> param_list {m_arena_p};
 
             consume_any(lexer, source); // skip pre-checked 'function'
             consume(lexer, source, TokenTag::left_paren);
@@ -309,7 +321,7 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::right_paren);
 
-            return std::make_unique<Expr>(
+            return make_node<Expr>(
                 LambdaLiteral {
                     .params = std::move(param_list),
                     .body = parse_block(lexer, source)
@@ -321,7 +333,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_member(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_member(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_member;
             
             const auto snippet_begin = m_current.start;
@@ -334,10 +346,10 @@ export namespace DerkJS {
                     consume_any(lexer, source);
                     consume(lexer, source, TokenTag::identifier, TokenTag::keyword_prototype);
 
-                    lhs_primary = std::make_unique<Expr>(
+                    lhs_primary = make_node<Expr>(
                         MemberAccess {
                             .target = std::move(lhs_primary),
-                            .key = std::make_unique<Expr>(
+                            .key = make_node<Expr>(
                                 Primitive { .token = m_previous, .is_key = true },
                                 0,
                                 m_previous.start,
@@ -358,7 +370,7 @@ export namespace DerkJS {
 
                     consume(lexer, source, TokenTag::right_bracket);
 
-                    lhs_primary = std::make_unique<Expr>(
+                    lhs_primary = make_node<Expr>(
                         MemberAccess {
                             .target = std::move(lhs_primary),
                             .key = std::move(enclosed_expr),
@@ -379,7 +391,7 @@ export namespace DerkJS {
             return lhs_primary;
         }
 
-        [[nodiscard]] auto parse_new(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_new(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_new;
 
             bool has_new = false;
@@ -396,7 +408,7 @@ export namespace DerkJS {
                 return inner_primary;
             }
 
-            return std::make_unique<Expr>(
+            return make_node<Expr>(
                 Unary {
                     .inner = std::move(inner_primary),
                     .op = AstOp::ast_op_new
@@ -408,7 +420,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_call(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_call(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_call;
 
             auto callee_new_expr = parse_new(lexer, source);
@@ -420,12 +432,12 @@ export namespace DerkJS {
 
             consume_any(lexer, source);
 
-            std::vector<ExprPtr> args;
+            AstList<ExprPtr> args {m_arena_p};
 
             if (m_current.match_tag_to(TokenTag::right_paren)) {
                 consume_any(lexer, source);
 
-                return std::make_unique<Expr>(
+                return make_node<Expr>(
                     Call {
                         .args = std::move(args),
                         .callee = std::move(callee_new_expr)
@@ -451,7 +463,7 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::right_paren);
 
-            return std::make_unique<Expr>(
+            return make_node<Expr>(
                 Call {
                     .args = std::move(args),
                     .callee = std::move(callee_new_expr)
@@ -463,7 +475,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_postfix_unary(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_postfix_unary(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_unary;
 
             const auto snippet_begin = m_current.start;
@@ -480,7 +492,7 @@ export namespace DerkJS {
             if (postfix_unary_op != AstOp::ast_op_noop) {
                 consume_any(lexer, source);
 
-                return std::make_unique<Expr>(
+                return make_node<Expr>(
                     Unary {
                         .inner = std::move(inner_expr),
                         .op = postfix_unary_op
@@ -495,7 +507,7 @@ export namespace DerkJS {
             return inner_expr;
         }
 
-        [[nodiscard]] auto parse_prefix_unary(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_prefix_unary(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_unary;
 
             const auto snippet_begin = m_current.start;
@@ -516,7 +528,7 @@ export namespace DerkJS {
             if (unary_op != AstOp::ast_op_noop) {
                 consume_any(lexer, source);
 
-                return std::make_unique<Expr>(
+                return make_node<Expr>(
                     Unary {
                         .inner = parse_postfix_unary(lexer, source),
                         .op = unary_op
@@ -531,7 +543,7 @@ export namespace DerkJS {
             return parse_postfix_unary(lexer, source);
         }
 
-        [[nodiscard]] auto parse_factor(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_factor(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_factor;
 
             const auto snippet_begin = m_current.start;
@@ -552,7 +564,7 @@ export namespace DerkJS {
 
                 consume_any(lexer, source);
 
-                lhs = std::make_unique<Expr>(
+                lhs = make_node<Expr>(
                     Binary {
                         .lhs = std::move(lhs),
                         .rhs = parse_prefix_unary(lexer, source),
@@ -568,7 +580,7 @@ export namespace DerkJS {
             return lhs;
         }
 
-        [[nodiscard]] auto parse_term(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_term(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_term;
 
             const auto snippet_begin = m_current.start;
@@ -585,7 +597,7 @@ export namespace DerkJS {
 
                 consume_any(lexer, source);
 
-                lhs = std::make_unique<Expr>(
+                lhs = make_node<Expr>(
                     Binary {
                         .lhs = std::move(lhs),
                         .rhs = parse_factor(lexer, source),
@@ -601,7 +613,7 @@ export namespace DerkJS {
             return lhs;
         }
 
-        [[nodiscard]] auto parse_compare(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_compare(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_compare;
 
             const auto snippet_begin = m_current.start;
@@ -624,7 +636,7 @@ export namespace DerkJS {
 
                 consume_any(lexer, source);
 
-                lhs = std::make_unique<Expr>(
+                lhs = make_node<Expr>(
                     Binary {
                         .lhs = std::move(lhs),
                         .rhs = parse_term(lexer, source),
@@ -640,7 +652,7 @@ export namespace DerkJS {
             return lhs;
         }
 
-        [[nodiscard]] auto parse_equality(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_equality(Lexer& lexer, std::string_view source) -> ExprPtr {
             m_syntax = SyntaxTag::expr_equality;
 
             const auto snippet_begin = m_current.start;
@@ -662,7 +674,7 @@ export namespace DerkJS {
 
                 consume_any(lexer, source);
 
-                lhs = std::make_unique<Expr>(
+                lhs = make_node<Expr>(
                     Binary {
                         .lhs = std::move(lhs),
                         .rhs = parse_compare(lexer, source),
@@ -678,7 +690,7 @@ export namespace DerkJS {
             return lhs;
         }
 
-        [[nodiscard]] auto parse_logical_and(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_logical_and(Lexer& lexer, std::string_view source) -> ExprPtr {
             const auto snippet_begin = m_current.start;
             auto and_lhs = parse_equality(lexer, source);
 
@@ -689,7 +701,7 @@ export namespace DerkJS {
 
                 consume_any(lexer, source);
 
-                and_lhs = std::make_unique<Expr>(
+                and_lhs = make_node<Expr>(
                     Binary {
                         .lhs = std::move(and_lhs),
                         .rhs = parse_equality(lexer, source),
@@ -705,7 +717,7 @@ export namespace DerkJS {
             return and_lhs;
         }
 
-        [[nodiscard]] auto parse_logical_or(Lexer& lexer, const std::string& source) -> ExprPtr {
+        [[nodiscard]] auto parse_logical_or(Lexer& lexer, std::string_view source) -> ExprPtr {
             const auto snippet_begin = m_current.start;
             auto or_lhs = parse_logical_and(lexer, source);
 
@@ -716,7 +728,7 @@ export namespace DerkJS {
 
                 consume_any(lexer, source);
 
-                or_lhs = std::make_unique<Expr>(
+                or_lhs = make_node<Expr>(
                     Binary {
                         .lhs = std::move(or_lhs),
                         .rhs = parse_logical_and(lexer, source),
@@ -732,7 +744,7 @@ export namespace DerkJS {
             return or_lhs;
         }
 
-        [[nodiscard]] auto parse_stmt(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_stmt(Lexer& lexer, std::string_view source) -> StmtPtr {
             if (const auto stmt_begin = m_current.tag; stmt_begin == TokenTag::keyword_var) {
                 return parse_variable(lexer, source);
             } else if (stmt_begin == TokenTag::keyword_if) {
@@ -766,7 +778,7 @@ export namespace DerkJS {
             }
         }
 
-        [[nodiscard]] auto parse_var_decl(Lexer& lexer, const std::string& source) -> VarDecl {
+        [[nodiscard]] auto parse_var_decl(Lexer& lexer, std::string_view source) -> VarDecl {
             const auto snippet_begin = m_current.start;
 
             consume(lexer, source, TokenTag::identifier);
@@ -777,7 +789,7 @@ export namespace DerkJS {
             if (!m_current.match_tag_to(TokenTag::symbol_assign)) {
                 return VarDecl {
                     .name = name_token,
-                    .rhs = std::make_unique<Expr>(
+                    .rhs = make_node<Expr>(
                         Primitive {
                             .token = Token {TokenTag::keyword_undefined, 0, 0, name_token.line, name_token.column + name_token.length},
                             .is_key = false
@@ -798,13 +810,13 @@ export namespace DerkJS {
             };
         }
 
-        [[nodiscard]] auto parse_variable(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_variable(Lexer& lexer, std::string_view source) -> StmtPtr {
             m_syntax = SyntaxTag::stmt_var;
 
             const auto snippet_begin = m_current.start;
             consume_any(lexer, source); // skip 'var'
 
-            std::vector<VarDecl> vars;
+            AstList<VarDecl> vars {m_arena_p};
 
             vars.emplace_back(parse_var_decl(lexer, source));
 
@@ -820,7 +832,7 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::semicolon);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 Variables {
                     .vars = std::move(vars)
                 },
@@ -831,7 +843,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_if(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_if(Lexer& lexer, std::string_view source) -> StmtPtr {
             m_syntax = SyntaxTag::stmt_if;
 
             const auto snippet_begin = m_current.start;
@@ -845,14 +857,14 @@ export namespace DerkJS {
 
             auto truthy_stmt = parse_stmt(lexer, source);
 
-            std::unique_ptr<Stmt> falsy_stmt;
+            StmtPtr falsy_stmt;
 
             if (const auto current_token_tag = m_current.tag; current_token_tag == TokenTag::keyword_else) {
                 consume_any(lexer, source);
                 falsy_stmt = parse_stmt(lexer, source);
             }
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 If {
                     .check = std::move(condition_expr),
                     .body_true = std::move(truthy_stmt),
@@ -865,7 +877,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_return(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_return(Lexer& lexer, std::string_view source) -> StmtPtr {
             m_syntax = SyntaxTag::stmt_return;
 
             const auto snippet_begin = m_current.start;
@@ -877,7 +889,7 @@ export namespace DerkJS {
             if (m_current.tag != TokenTag::semicolon) {
                 result_expr = parse_logical_or(lexer, source);
             } else {
-                result_expr = std::make_unique<Expr>(
+                result_expr = make_node<Expr>(
                     Primitive {
                         .token = Token {TokenTag::keyword_undefined, 0, 0, m_previous.line, m_previous.column + m_previous.length},
                         .is_key = false
@@ -891,7 +903,7 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::semicolon);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 Return {
                     .result = std::move(result_expr)
                 },
@@ -902,7 +914,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_while(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_while(Lexer& lexer, std::string_view source) -> StmtPtr {
             m_syntax = SyntaxTag::stmt_while;
 
             const auto snippet_begin = m_current.start;
@@ -916,7 +928,7 @@ export namespace DerkJS {
 
             auto loop_stmt = parse_stmt(lexer, source);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 While {
                     .check = std::move(loop_check_expr),
                     .body = std::move(loop_stmt),
@@ -929,7 +941,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_do_while(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_do_while(Lexer& lexer, std::string_view source) -> StmtPtr {
             m_syntax = SyntaxTag::stmt_while;
 
             const auto snippet_begin = m_current.start;
@@ -946,7 +958,7 @@ export namespace DerkJS {
             consume(lexer, source, TokenTag::right_paren);
             consume(lexer, source, TokenTag::semicolon);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 While {
                     .check = std::move(loop_check_expr),
                     .body = std::move(loop_stmt),
@@ -959,7 +971,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_for_stepped(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_for_stepped(Lexer& lexer, std::string_view source) -> StmtPtr {
             const auto snippet_begin = m_current.start;
 
             consume_any(lexer, source); // skip 'for'
@@ -994,7 +1006,7 @@ export namespace DerkJS {
 
             StmtPtr body_stmt = parse_stmt(lexer, source);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 ForStepped {
                     .init = std::move(init_part),
                     .check = std::move(check_expr),
@@ -1008,13 +1020,13 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_break(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_break(Lexer& lexer, std::string_view source) -> StmtPtr {
             const auto snippet_begin = m_current.start;
 
             consume_any(lexer, source);
             consume(lexer, source, TokenTag::semicolon);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 Break {},
                 0,
                 snippet_begin,
@@ -1023,13 +1035,13 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_continue(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_continue(Lexer& lexer, std::string_view source) -> StmtPtr {
             const auto snippet_begin = m_current.start;
 
             consume_any(lexer, source);
             consume(lexer, source, TokenTag::semicolon);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 Continue {},
                 0,
                 snippet_begin,
@@ -1038,7 +1050,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_throw(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_throw(Lexer& lexer, std::string_view source) -> StmtPtr {
             const auto snippet_begin = m_current.start;
             consume_any(lexer, source); // skip 'throw'
 
@@ -1046,7 +1058,7 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::semicolon);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 Throw {
                     .error_expr = std::move(throwable_expr)
                 },
@@ -1057,7 +1069,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_try_catch(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_try_catch(Lexer& lexer, std::string_view source) -> StmtPtr {
             const auto snippet_begin = m_current.start;
             consume_any(lexer, source); // skip 'try'
 
@@ -1081,7 +1093,7 @@ export namespace DerkJS {
                 block_finally = parse_block(lexer, source);
             }
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 TryCatch {
                     .error_name = error_name_token,
                     .body_try = std::move(block_try),
@@ -1095,7 +1107,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_function(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_function(Lexer& lexer, std::string_view source) -> StmtPtr {
             m_syntax = SyntaxTag::stmt_function;
 
             const auto snippet_begin = m_current.start;
@@ -1107,7 +1119,7 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::left_paren);
 
-            std::vector<Param> params;
+            AstList<Param> params {m_arena_p};
 
             if (!m_current.match_tag_to(TokenTag::right_paren)) {
                 params.emplace_back(parse_param(lexer, source));
@@ -1125,10 +1137,10 @@ export namespace DerkJS {
             consume(lexer, source, TokenTag::right_paren);
 
             /// NOTE: Treat function <name>(args...) {...} as var name = function(args...) {...} here.
-            std::vector<VarDecl> hidden_lambda_var_decl;
+            AstList<VarDecl> hidden_lambda_var_decl {m_arena_p};
             hidden_lambda_var_decl.emplace_back(VarDecl {
                 .name = name_token,
-                .rhs = std::make_unique<Expr>(
+                .rhs = make_node<Expr>(
                     LambdaLiteral {
                         .params = std::move(params),
                         .body = parse_block(lexer, source)
@@ -1140,7 +1152,7 @@ export namespace DerkJS {
                 )
             });
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 Variables {
                     .vars = std::move(hidden_lambda_var_decl)
                 },
@@ -1151,9 +1163,9 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_block(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_block(Lexer& lexer, std::string_view source) -> StmtPtr {
             const auto snippet_begin = m_current.start;
-            std::vector<StmtPtr> stmts;
+            AstList<StmtPtr> stmts {m_arena_p};
 
             consume(lexer, source, TokenTag::left_brace);
 
@@ -1166,7 +1178,7 @@ export namespace DerkJS {
                 }
             }
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 Block {
                     .items = std::move(stmts)
                 },
@@ -1177,7 +1189,7 @@ export namespace DerkJS {
             );
         }
 
-        [[nodiscard]] auto parse_expr_stmt(Lexer& lexer, const std::string& source) -> StmtPtr {
+        [[nodiscard]] auto parse_expr_stmt(Lexer& lexer, std::string_view source) -> StmtPtr {
             m_syntax = SyntaxTag::stmt_expr;
 
             const auto snippet_begin = m_current.start;
@@ -1186,7 +1198,7 @@ export namespace DerkJS {
             if (!m_current.match_tag_to(TokenTag::symbol_assign)) {
                 consume(lexer, source, TokenTag::semicolon);
 
-                return std::make_unique<Stmt>(
+                return make_node<Stmt>(
                     ExprStmt {
                         .expr = std::move(lhs_expr),
                     },
@@ -1203,9 +1215,9 @@ export namespace DerkJS {
 
             consume(lexer, source, TokenTag::semicolon);
 
-            return std::make_unique<Stmt>(
+            return make_node<Stmt>(
                 ExprStmt {
-                    .expr = std::make_unique<Expr>(Expr {
+                    .expr = make_node<Expr>(Expr {
                         Assign {
                             .lhs = std::move(lhs_expr),
                             .rhs = std::move(rhs)
@@ -1224,7 +1236,8 @@ export namespace DerkJS {
         }
 
         /// NOTE: this reset method exists because the parser should be reused across multiple sources for efficiency's sake & supporting modular programs later.
-        void reset(Lexer& lexer, const std::string& source) {
+        void reset(Lexer& lexer, std::string_view source, std::pmr::memory_resource* arena_p) {
+            m_arena_p = arena_p;
             m_previous = Token {};
             m_current = advance(lexer, source);
             m_error_count = 0;
@@ -1234,37 +1247,34 @@ export namespace DerkJS {
 
     public:
         Parser() noexcept
-        : m_previous {}, m_current {}, m_error_count {0}, m_syntax {SyntaxTag::program_top}, m_primitive_as_key {false} {}
+        : m_arena_p {nullptr}, m_previous {}, m_current {}, m_error_count {0}, m_syntax {SyntaxTag::program_top}, m_primitive_as_key {false} {}
 
 
         /// TODO: add source mapping IDs here when requires are added.
-        [[nodiscard]] auto operator()(Lexer& lexer, std::string file_name, const std::string& source) -> std::optional<ASTUnit> {
-            reset(lexer, source);
+        [[nodiscard]] auto operator()(Lexer& lexer, std::string file_name, std::string_view source) -> std::optional<ASTUnit> {
+            //? NOTE: The unit is made first since its arena backs every node parsed below.
+            ASTUnit translation_unit;
 
-            std::vector<StmtPtr> translation_unit_stmts;
+            reset(lexer, source, translation_unit.arena());
 
             try {
                 while (!at_eof()) {
-                    translation_unit_stmts.emplace_back(parse_stmt(lexer, source));
+                    translation_unit.emplace_back(ASTUnit::value_type {
+                        .source_filename = file_name,
+                        .decl = parse_stmt(lexer, source),
+                        .src_id = 0,
+                    });
                 }
             } catch (const std::runtime_error& parse_err) {
                 std::println(std::cerr, "{}", parse_err.what());
             }
 
+            m_arena_p = nullptr;
+
             if (m_error_count > 0) {
                 return {};
             }
 
-            ASTUnit translation_unit;
-
-            for (auto& stmt_ptr : translation_unit_stmts) {
-                translation_unit.emplace_back(ASTUnit::value_type {
-                    .source_filename = file_name,
-                    .decl = std::move(stmt_ptr),
-                    .src_id = 0,
-                });
-            }
-
             return translation_unit;
         }
     };
@@ -1,5 +1,6 @@
 module;
 
+#include <cstdint>
 #include <type_traits>
 #include <utility>
 #include <algorithm>
@@ -11,6 +12,7 @@ module;
 export module runtime.arrays;
 
 import runtime.value;
+import runtime.slabs;
 
 namespace DerkJS {
     auto handle_length_change(ObjectBase<Value>* object_p, const Value& next_length) -> bool;
@@ -23,6 +25,10 @@ namespace DerkJS {
         std::vector<Value> m_items;
         // Holds [[Prototype]] reference.
         Value m_prototype;
+        // Hidden class of `m_own_properties`, starting from the "length" slot.
+        const PropShape* m_shape;
+        // Key hash index of `m_own_properties` once this array is in dictionary mode.
+        PropIndex m_prop_index;
         uint8_t m_flags;
 
         void fill_gap_to_n(int index, bool should_default) {
@@ -52,12 +58,21 @@ namespace DerkJS {
         }
 
     public:
+        /// NOTE: Instances are placed into this type's slab arena, see `./src/derkjs_impl/runtime/slabs.ixx`.
+        [[nodiscard]] static auto operator new(std::size_t size) -> void* {
+            return slab_allocate<Array>(size);
+        }
+
+        static void operator delete(void* ptr, std::size_t size) noexcept {
+            slab_deallocate<Array>(ptr, size);
+        }
+
         Array(ObjectBase<Value>* prototype_p, const Value& length_key, const Value& initial_length_v) noexcept (std::is_nothrow_default_constructible_v<Value>)
-        : m_own_properties {}, m_items {}, m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_flags {std::to_underlying(AttrMask::defaults)} {
+        : m_own_properties {}, m_items {}, m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_shape {PropShape::next_of(PropShape::root(), shape_key_text(length_key))}, m_prop_index {}, m_flags {std::to_underlying(AttrMask::defaults)} {
             auto& length_ref = m_own_properties.emplace_back(PropEntry<Value, Value> {
                 .key = length_key,
                 .item = initial_length_v,
-                .handler_p = nullptr
+                .handler_p = handle_length_change
             }).item;
 
             length_ref.set_flag<AttrMask::defaults>();
@@ -66,7 +81,7 @@ namespace DerkJS {
         }
 
         Array(ObjectBase<Value>* prototype_p, const Value& length_key, const std::span<Value>& item_slice) noexcept (std::is_nothrow_default_constructible_v<Value>)
-        : m_own_properties {}, m_items {}, m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_flags {std::to_underlying(AttrMask::defaults)} {
+        : m_own_properties {}, m_items {}, m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_shape {PropShape::next_of(PropShape::root(), shape_key_text(length_key))}, m_prop_index {}, m_flags {std::to_underlying(AttrMask::defaults)} {
             auto& length_value_ref = m_own_properties.emplace_back(PropEntry<Value, Value> {
                 .key = length_key,
                 .item = Value {0, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::accessor) | std::to_underlying(AttrMask::property)},
@@ -87,10 +102,58 @@ namespace DerkJS {
             return m_items;
         }
 
+        /// NOTE: Bulk append for natives, which reserves capacity once and keeps "length" in sync. Callers must apply GC write barriers for the new items.
+        [[nodiscard]] auto append_items(std::span<const Value> new_items) -> bool {
+            if ((m_flags & std::to_underlying(AttrMask::writable)) == 0) {
+                return false;
+            }
+
+            m_items.reserve(m_items.size() + new_items.size());
+
+            for (auto item_value : new_items) {
+                item_value.set_flag<AttrMask::property>();
+                m_items.emplace_back(item_value);
+            }
+
+            sync_length();
+
+            return true;
+        }
+
+        /// NOTE: For natives that resize the items directly, this updates "length" (always the 1st own property) to match.
+        void sync_length() noexcept {
+            m_own_properties.front().item = Value {
+                static_cast<int>(m_items.size()),
+                std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::accessor) | std::to_underlying(AttrMask::property)
+            };
+        }
+
+        [[nodiscard]] auto get_shape() const noexcept -> const PropShape* override {
+            return m_shape;
+        }
+
+        [[nodiscard]] auto append_shaped_property(const Value& key, const Value& value, const PropShape* next_shape_p) -> Value* override {
+            if ((m_flags & std::to_underlying(AttrMask::writable)) == 0) {
+                return nullptr;
+            }
+
+            auto value_copy = value;
+            value_copy.set_flag<AttrMask::property>();
+
+            auto& new_entry = m_own_properties.emplace_back(key, value_copy, nullptr);
+            m_shape = (index_last_prop(m_own_properties, m_prop_index)) ? nullptr : next_shape_p;
+
+            return &new_entry.item;
+        }
+
         [[nodiscard]] auto get_unique_addr() noexcept -> void* override {
             return this;
         }
 
+        [[nodiscard]] auto get_footprint() const noexcept -> std::size_t override {
+            return sizeof(Array) + m_own_properties.capacity() * sizeof(PropEntry<Value, Value>) + m_items.capacity() * sizeof(Value);
+        }
+
         [[nodiscard]] auto get_class_name() const noexcept -> std::string override {
             return "Array";
         }
@@ -124,23 +187,20 @@ namespace DerkJS {
                 return PropertyDescriptor<Value> {key, &m_prototype, this}; // TODO: add instance-specific prototype support?
             } else if (key.get_tag() == ValueTag::num_i32) {
                 return PropertyDescriptor<Value> {key, get_item(key.to_num_i32().value(), allow_filler), this};
-            } else if (auto property_entry_it = std::find_if(m_own_properties.begin(), m_own_properties.end(), [&key](const auto& prop) -> bool {
-                return prop.key == key || prop.key.compare_as_object(key);
-            }); property_entry_it != m_own_properties.end()) {
-                return PropertyDescriptor<Value> {key, &property_entry_it->item, this};
+            } else if (auto property_entry_p = find_own_prop(m_own_properties, m_prop_index, key); property_entry_p) {
+                return PropertyDescriptor<Value> {key, &property_entry_p->item, this};
             } else if ((m_flags & std::to_underlying(AttrMask::writable)) && allow_filler) {
-                return PropertyDescriptor<Value> {
+                auto& filler_entry = m_own_properties.emplace_back(
                     key,
-                    &m_own_properties.emplace_back(
-                        key,
-                        Value {
-                            JSUndefOpt {},
-                            std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)
-                        },
-                        nullptr
-                    ).item,
-                    this
-                };
+                    Value {
+                        JSUndefOpt {},
+                        std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)
+                    },
+                    nullptr
+                );
+                m_shape = (index_last_prop(m_own_properties, m_prop_index)) ? nullptr : PropShape::next_of(m_shape, shape_key_text(key));
+
+                return PropertyDescriptor<Value> {key, &filler_entry.item, this};
             } else if (auto prototype_p = m_prototype.to_object(); prototype_p) {
                 return prototype_p->get_property_value(key, allow_filler);
             }
@@ -175,10 +235,8 @@ namespace DerkJS {
 
         //! TODO: I should not have this silently fail... Return a bool at least.
         void update_on_accessor_mut([[maybe_unused]] const Value& key, const Value& value) override {
-            if (auto property_entry_it = std::find_if(m_own_properties.begin(), m_own_properties.end(), [&key](const auto& prop) -> bool {
-                return prop.key == key || prop.key.compare_as_object(key);
-            }); property_entry_it != m_own_properties.end() && property_entry_it->handler_p != nullptr) {
-                property_entry_it->handler_p(this, value);
+            if (auto property_entry_p = find_own_prop(m_own_properties, m_prop_index, key); property_entry_p && property_entry_p->handler_p != nullptr) {
+                property_entry_p->handler_p(this, value);
             }
         }
 
@@ -222,7 +280,7 @@ namespace DerkJS {
             return sout.str();
         }
 
-        [[nodiscard]] auto operator==(const ObjectBase& other) const noexcept -> bool override {
+        [[nodiscard]] auto operator==(const ObjectBase& other) const -> bool override {
             if (&other == this) {
                 return true;
             }
@@ -275,13 +333,9 @@ namespace DerkJS {
         if (auto object_as_array_p = dynamic_cast<Array*>(object_p); object_as_array_p) {
             const int next_length_i32 = next_length.to_num_i32().value_or(0);
 
-            if (const int old_length = object_as_array_p->get_seq_items()->size(); next_length_i32 > old_length) {
-                object_as_array_p->get_seq_items()->resize(next_length_i32 + 1, Value {
-                    JSUndefOpt {},
-                    std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)
-                });
-            } else if (next_length_i32 < old_length) {
-                object_as_array_p->get_seq_items()->resize(next_length_i32, Value {
+            //? NOTE: Resize only on real changes, which also avoids refilling gaps for same-length writes. Growth stays amortized by `std::vector`.
+            if (auto& items = object_as_array_p->items(); next_length_i32 >= 0 && static_cast<std::size_t>(next_length_i32) != items.size()) {
+                items.resize(next_length_i32, Value {
                     JSUndefOpt {},
                     std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)
                 });
@@ -2,6 +2,9 @@ module;
 
 #include <cstdint>
 #include <array>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <print>
 
@@ -39,8 +42,8 @@ export namespace DerkJS {
         djs_put_obj_dud, // Pushes a newly created, empty JS object.
         djs_make_arr, // Args: <item-count>; Pushes a newly created, empty JS array from the top N stack items. The Array prototype is automatically bound to the new array.
         djs_put_proto_key, // Replaces top stack obj-ref with proto-ref.
-        djs_get_prop, // djs_get_prop gets a property value's ref based on an object's ref below a pooled string ref on the stack... the result is placed where the targeted ref was. --> Stack placement: <OBJ-REF-LOCAL> <PROP-KEY-HANDLE> --> <PROP-VALUE-REF>
-        djs_put_prop, // djs_put_prop --> Stack placement: <OBJ-REF> <PROP-KEY-HANDLE-VALUE> <NEW-VALUE> --> <OBJ-REF>
+        djs_get_prop, // Args: <inline-cache-id> <access-flags>; djs_get_prop gets a property value's ref based on an object's ref below a pooled string ref on the stack... the result is placed where the targeted ref was. --> Stack placement: <OBJ-REF-LOCAL> <PROP-KEY-HANDLE> --> <PROP-VALUE-REF>
+        djs_put_prop, // Args: <inline-cache-id>; djs_put_prop --> Stack placement: <OBJ-REF> <PROP-KEY-HANDLE-VALUE> <NEW-VALUE> --> <OBJ-REF>
         djs_ref_pack, // TODO, please see roadmap todos under "rest parameters"
         djs_numify, // converts the VM stack's top value to a number
         djs_strcat, // concatenates 2 string copies since the ref-wrapping `Value` is decoupled from VM state --> Stack placement: <STRING-1> <STRING-2> --> <NEW-STRING>
@@ -66,17 +69,52 @@ export namespace DerkJS {
         djs_jump,
         djs_object_call, // Args: <arg-count> <pass-this-flag>: Assumes the top stack value references a `ObjectBase<Value>` to invoke on <arg-count> temporaries below. NativeFunction objects don't need to affect `RSBP` and `RSP` for restoring caller stack state. The call() virtual method per function object can now take 'this' on `pass-this-flag == 1`: the caller object is 'this', laying on top of all other arguments as the consuming temporary. Stack: `<obj-ref> <obj-ref> <key-value> -> <result>`
         djs_ctor_call, // Args: <arg-count>; creates a this object to initialize and return via `var foo = new Foo()` where the function has `return this;`. Invokes the object's `call_as_ctor()` virtual method. If `opt-chunk-id >= 0`: invokes the bytecode function as a constructor. ONLY WORKS WITH FUNCTION OBJECTS!!
+        djs_tail_call, // Args: <arg-count> <pass-this-flag>; Like `djs_object_call`, but only emitted right before a `djs_ret`. The call reuses the current frame & stack window when no `try` handler covers it, so the `djs_ret` only runs for native callees or calls which can't reuse the frame.
         djs_ret, // Arg: <is-implicit> Yields the callee's result to the caller. If `is-implicit = 1`, return `undefined` or `this`, but yield the top-stack value otherwise.
-        djs_throw, // Arg: <is-in-try> // Takes the top stack value and passes it to `ExternVMCtx::try_recover(Value error_msg, bool is_in_try)`. If is-in-try is `1`, this method saves the error object in the heap and caches its object reference in the context before searching bottom-up through callees' bytecode for the nearest `djs_catch` instruction. Otherwise, the nearest, local `djs_ret` is found before resuming the search for a `djs_catch`.
-        djs_catch, // Resumes VM execution at the catch body's code located +1 after this kind of instruction.
+        djs_throw, // Arg: <is-in-try> // Takes the top stack value and passes it to `ExternVMCtx::try_recover(ObjectBase<Value>* error_ptr)`, which caches the error object reference in the context before looking up each active frame's `ExceptionRange` table for the innermost handler, unwinding frames without one. The <is-in-try> flag is only informative now.
+        djs_catch, // Each handler's landing spot: resumes VM execution at the catch body's code located +1 after this kind of instruction.
         djs_halt,
+        // Superinstructions: Each fused head keeps its original tail instructions after it, so jumps into a tail still work. See `./src/derkjs_impl/backend/bc_peephole.ixx`.
+        djs_add_local_const, // Args: <const-id> <local-id>; Fuses `djs_put_const, djs_dup_local, djs_add` by pushing `<const> + <local>`.
+        djs_sub_local_const, // Args: <const-id> <local-id>; Fuses `djs_put_const, djs_dup_local, djs_sub` by pushing `<local> - <const>`.
+        djs_get_prop_const, // Args: <const-id>; Fuses `djs_put_const, djs_get_prop` by reading the inline cache ID & access flags from the kept `djs_get_prop` tail.
+        djs_jump_else_strict_eq, // Args: <relative-offset> <pop-n>; Fuses `djs_test_strict_eq, djs_jump_else` where the offset is relative to this head.
+        djs_jump_else_strict_ne,
+        djs_jump_else_lt,
+        djs_jump_else_lte,
+        djs_jump_else_gt,
+        djs_jump_else_gte,
+        // Quickened forms: Generic arithmetic & comparison opcodes rewrite themselves into these once their operand feedback is all `num_i32` (or all `num_f64`). Each one reverts to its generic opcode upon seeing any other operand types.
+        djs_add_i32,
+        djs_add_f64,
+        djs_sub_i32,
+        djs_sub_f64,
+        djs_test_lt_i32,
+        djs_jump_else_lt_i32,
+        djs_add_local_const_i32,
+        djs_sub_local_const_i32,
         last,
     };
 
+    /// NOTE: Operand type bits which quickenable instructions accumulate in `Instruction::feedback`.
+    enum class TypeFeedback : uint8_t {
+        none = 0b00000000,
+        i32 = 0b00000001,
+        f64 = 0b00000010,
+        other = 0b00000100
+    };
+
     enum class CallFlags : uint8_t {
         is_ctor = 0b00000001
     };
 
+    /// NOTE: Bit flags packed into the 2nd argument of `djs_get_prop`. The 1st argument is the site's inline cache ID, or -1 for uncached sites.
+    enum class PropAccessFlags : uint8_t {
+        none = 0b00000000,
+        should_default = 0b00000001, // default any invalid key to `undefined` for assignments
+        in_try = 0b00000010
+    };
+
     enum Location : uint8_t {
         code_chunk,
         immediate,
@@ -98,6 +136,14 @@ export namespace DerkJS {
     struct Instruction {
         int16_t args[2];
         Opcode op;
+        uint8_t feedback; // `TypeFeedback` bits of all operands seen so far, which fits in the padding
+    };
+
+    /// NOTE: One `try` block of a code buffer: throws from code offsets in `[try_begin, try_end)` land on the `djs_catch` at `handler_pos`. Tables list nested tries before their enclosing ones, so the first match is the innermost handler.
+    struct ExceptionRange {
+        int32_t try_begin;
+        int32_t try_end;
+        int32_t handler_pos;
     };
 
     struct Program {
@@ -109,67 +155,105 @@ export namespace DerkJS {
         
         std::vector<Value> consts;
         std::vector<Instruction> code;
+
+        /// Handler table of the top-level code.
+        std::vector<ExceptionRange> handlers;
+
         std::vector<int> offsets;
         int16_t entry_func_id;
+
+        /// Counts inline cache IDs given to property access sites.
+        int16_t prop_cache_count;
+
+        /// Counts the leading heap slots filled by native preloads. Bytecode caches only store the items after these, since natives get rebuilt on each launch.
+        int preload_item_count;
+
+        /// Top-level variables by name & local slot, so embedders can call script functions later.
+        std::vector<std::pair<std::string, Arg>> globals;
+    };
+
+    /// NOTE: Most items that nested array literals & calls may have pushed at once. The compiler rejects code past this, so a frame's temporaries fit the VM stack's per-frame room (`ExternVMCtx::stack_segment_length` slots), which leaves the rest for locals & operands.
+    constexpr int max_listed_items = 4096;
+
+    /// NOTE: Most locals one function may have, which also fits the per-frame room along with `max_listed_items`.
+    constexpr int max_frame_locals = 2048;
+
+    /// NOTE: Opcode mnemonics by `Opcode` value, for dumps & profiling reports.
+    constexpr std::array<std::string_view, static_cast<std::size_t>(Opcode::last)> opcode_names = {
+        "djs_nop",
+        "djs_dup",
+        "djs_dup_local",
+        "djs_ref_local",
+        "djs_store_upval",
+        "djs_ref_upval",
+        "djs_put_const",
+        "djs_deref",
+        "djs_pop",
+        "djs_emplace",
+        "djs_put_global_this",
+        "djs_put_this",
+        "djs_ref_error",
+        "djs_discard",
+        "djs_try_del",
+        "djs_typename",
+        "djs_put_obj_dud",
+        "djs_make_arr",
+        "djs_put_proto_key",
+        "djs_get_prop", // Args: <inline-cache-id> <access-flags>: gets a property value based on RSP: <OBJ-REF>, RSP - 1: <POOLED-STR-REF>; IF access-flags has `should_default`, default any invalid key to `undefined`.
+        "djs_put_prop", // SEE: djs_get_prop for stack args passing...
+        "djs_ref_pack",
+        "djs_numify",
+        "djs_strcat",
+        "djs_pre_inc",
+        "djs_pre_dec",
+        "djs_post_inc",
+        "djs_post_dec",
+        "djs_mod",
+        "djs_mul",
+        "djs_div",
+        "djs_add",
+        "djs_sub",
+        "djs_test_falsy",
+        "djs_test_strict_eq",
+        "djs_test_strict_ne",
+        "djs_test_lt",
+        "djs_test_lte",
+        "djs_test_gt",
+        "djs_test_gte",
+        "djs_cmp_protos",
+        "djs_jump_else",
+        "djs_jump_if",
+        "djs_jump",
+        "djs_object_call",
+        "djs_ctor_call",
+        "djs_tail_call",
+        "djs_ret",
+        "djs_throw",
+        "djs_catch",
+        "djs_halt",
+        "djs_add_local_const",
+        "djs_sub_local_const",
+        "djs_get_prop_const",
+        "djs_jump_else_strict_eq",
+        "djs_jump_else_strict_ne",
+        "djs_jump_else_lt",
+        "djs_jump_else_lte",
+        "djs_jump_else_gt",
+        "djs_jump_else_gte",
+        "djs_add_i32",
+        "djs_add_f64",
+        "djs_sub_i32",
+        "djs_sub_f64",
+        "djs_test_lt_i32",
+        "djs_jump_else_lt_i32",
+        "djs_add_local_const_i32",
+        "djs_sub_local_const_i32",
     };
 
     void disassemble_program(const Program& prgm) {
-        static constexpr std::array<std::string_view, static_cast<std::size_t>(Opcode::last)> opcode_names = {
-            "djs_nop",
-            "djs_dup",
-            "djs_dup_local",
-            "djs_ref_local",
-            "djs_store_upval",
-            "djs_ref_upval",
-            "djs_put_const",
-            "djs_deref",
-            "djs_pop",
-            "djs_emplace",
-            "djs_put_global_this",
-            "djs_put_this",
-            "djs_ref_error",
-            "djs_discard",
-            "djs_try_del",
-            "djs_typename",
-            "djs_put_obj_dud",
-            "djs_make_arr",
-            "djs_put_proto_key",
-            "djs_get_prop", // Args: <should-default>: gets a property value based on RSP: <OBJ-REF>, RSP - 1: <POOLED-STR-REF>; IF should-default == 1, default any invalid key to `undefined`.
-            "djs_put_prop", // SEE: djs_get_prop for stack args passing...
-            "djs_ref_pack",
-            "djs_numify",
-            "djs_strcat",
-            "djs_pre_inc",
-            "djs_pre_dec",
-            "djs_post_inc",
-            "djs_post_dec",
-            "djs_mod",
-            "djs_mul",
-            "djs_div",
-            "djs_add",
-            "djs_sub",
-            "djs_test_falsy",
-            "djs_test_strict_eq",
-            "djs_test_strict_ne",
-            "djs_test_lt",
-            "djs_test_lte",
-            "djs_test_gt",
-            "djs_test_gte",
-            "djs_cmp_protos",
-            "djs_jump_else",
-            "djs_jump_if",
-            "djs_jump",
-            "djs_object_call",
-            "djs_ctor_call",
-            "djs_ret",
-            "djs_throw",
-            "djs_catch",
-            "djs_halt",
-        };
-
-        const auto& [prgm_heap_items, prgm_prototype_bases, prgm_consts, prgm_code, prgm_code_offsets, prgm_entry_id] = prgm;
-
-        std::println("\x1b[1;33mProgram Dump:\x1b[0m\n\nEntry Chunk ID: {}\n", prgm_entry_id);
+        const auto& [prgm_heap_items, prgm_prototype_bases, prgm_consts, prgm_code, prgm_handlers, prgm_code_offsets, prgm_entry_id, prgm_prop_cache_n, prgm_preload_n, prgm_globals] = prgm;
+
+        std::println("\x1b[1;33mProgram Dump:\x1b[0m\n\nEntry Chunk ID: {}\nProperty Inline Caches: {}\n", prgm_entry_id, prgm_prop_cache_n);
 
         std::println("\x1b[1;33mFunction Offsets:\x1b[0m\n");
 
@@ -203,7 +287,7 @@ export namespace DerkJS {
 
         std::println("\n\x1b[1;33mCode:\x1b[0m\n");
 
-        for (int fn_offset_index = 0, abs_code_pos = 0; const auto& [instr_argv, instr_op] : prgm_code) {
+        for (int fn_offset_index = 0, abs_code_pos = 0; const auto& [instr_argv, instr_op, instr_feedback] : prgm_code) {
             if (const auto fn_begin = prgm_code_offsets.at(fn_offset_index); abs_code_pos == fn_begin) {
                 std::println("\n--- BEGIN CHUNK {} at {} ---\n", fn_offset_index, fn_begin);
                 ++fn_offset_index;
@@ -1,5 +1,8 @@
 module;
 
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <utility>
 #include <algorithm>
 #include <format>
@@ -14,12 +17,20 @@ module;
 export module runtime.callables;
 
 import runtime.value;
+import runtime.slabs;
 import runtime.object;
 import runtime.arrays;
 import runtime.bytecode;
 import runtime.context;
 
 export namespace DerkJS {
+#ifdef DERKJS_JIT
+    /// NOTE: Whether `Lambda` calls bump the tier-up counters, which only a `DERKJS_JIT` build does. The baseline JIT itself is still WIP, see `./docs/roadmap.md`.
+    constexpr bool jit_counters_built_in = true;
+#else
+    constexpr bool jit_counters_built_in = false;
+#endif
+
     /**
      * @brief Wraps a native function pointer that is then invoked on the VM context (see `./src/derkjs_impl/runtime/vm.ixx` for `ExternVMCtx`) and some metadata (see `NativeFunction::native_func_p`). This allows for C++ functions that interact with the JS environment.
      */
@@ -59,6 +70,10 @@ export namespace DerkJS {
             return this;
         }
 
+        [[nodiscard]] auto get_footprint() const noexcept -> std::size_t override {
+            return sizeof(NativeFunction) + m_own_properties.capacity() * sizeof(PropEntry<Value, Value>);
+        }
+
         [[nodiscard]] auto get_class_name() const noexcept -> std::string override {
             return "function";
         }
@@ -91,7 +106,7 @@ export namespace DerkJS {
             if (key.is_prototype_key()) { // For prototype, not __proto__!
                 return PropertyDescriptor<Value> {key, &m_instance_prototype, this};
             } else if (auto property_entry_it = std::find_if(m_own_properties.begin(), m_own_properties.end(), [&key](const auto& prop) -> bool {
-                return prop.key == key || prop.key.compare_as_object(key);
+                return prop.key.is_same_key(key);
             }); property_entry_it != m_own_properties.end()) {
                 return PropertyDescriptor<Value> {key, &property_entry_it->item, this};
             } else if ((m_flags & std::to_underlying(AttrMask::writable)) && allow_filler) {
@@ -150,8 +165,8 @@ export namespace DerkJS {
             auto vm_context_p = reinterpret_cast<ExternVMCtx*>(opaque_ctx_p);
 
             const auto resume_ip = vm_context_p->rip_p + 1;
-            const int16_t callee_rsbp = vm_context_p->rsp - argc;
-            const int16_t caller_rsbp = vm_context_p->rsbp;
+            const int32_t callee_rsbp = vm_context_p->rsp - argc;
+            const int32_t caller_rsbp = vm_context_p->rsbp;
 
             // 1.2: Resolve `thisArg`... Native functions will refer to themselves by default.
             if (!has_this_arg) {
@@ -189,8 +204,8 @@ export namespace DerkJS {
             auto vm_context_p = reinterpret_cast<ExternVMCtx*>(opaque_ctx_p);
 
             const auto resume_ip = vm_context_p->rip_p + 1;
-            const int16_t callee_rsbp = vm_context_p->rsp - argc;
-            const int16_t caller_rsbp = vm_context_p->rsbp;
+            const int32_t callee_rsbp = vm_context_p->rsp - argc;
+            const int32_t caller_rsbp = vm_context_p->rsbp;
 
             // 2. Push dummy frame mostly to track ctor-call status.
             vm_context_p->rsbp = callee_rsbp;
@@ -256,6 +271,10 @@ export namespace DerkJS {
      * @brief Wraps a lambda's bytecode buffer which is separate from the main bytecode buffer for top-level functions or code. However, this must be a object- All JS functions are basically objects.
      */
     class Lambda : public ObjectBase<Value> {
+    public:
+        /// NOTE: Calls after which a function counts as hot, which is where the baseline JIT would tier it up.
+        static constexpr uint32_t hot_call_threshold = 1000;
+
     private:
         static constexpr std::array<std::string_view, static_cast<std::size_t>(Opcode::last)> opcode_names = {
             "djs_nop",
@@ -304,22 +323,66 @@ export namespace DerkJS {
             "djs_jump",
             "djs_object_call",
             "djs_ctor_call",
+            "djs_tail_call",
             "djs_ret",
             "djs_throw",
             "djs_catch",
             "djs_halt",
+            "djs_add_local_const",
+            "djs_sub_local_const",
+            "djs_get_prop_const",
+            "djs_jump_else_strict_eq",
+            "djs_jump_else_strict_ne",
+            "djs_jump_else_lt",
+            "djs_jump_else_lte",
+            "djs_jump_else_gt",
+            "djs_jump_else_gte",
+            "djs_add_i32",
+            "djs_add_f64",
+            "djs_sub_i32",
+            "djs_sub_f64",
+            "djs_test_lt_i32",
+            "djs_jump_else_lt_i32",
+            "djs_add_local_const_i32",
+            "djs_sub_local_const_i32",
         };
 
         PropPool<Value, Value> m_own_properties;
         std::vector<Instruction> m_code;
+        std::vector<ExceptionRange> m_handlers;
         Value m_prototype;
         Value m_instance_prototype;
+        uint32_t m_call_count; // normal & ctor calls so far, saturating, which only counts in `DERKJS_JIT` builds
         int16_t m_min_arity;
         uint8_t m_flags;
+        bool m_owns_capture; // whether calls need a fresh capture object for this function's `djs_store_upval`s
+
+        void count_call() noexcept {
+            if constexpr (jit_counters_built_in) {
+                if (m_call_count < std::numeric_limits<uint32_t>::max()) {
+                    ++m_call_count;
+                }
+            }
+        }
+
+        [[nodiscard]] static auto has_upval_stores(const std::vector<Instruction>& code) noexcept -> bool {
+            return std::any_of(code.begin(), code.end(), [](const Instruction& instr) noexcept -> bool {
+                return instr.op == Opcode::djs_store_upval;
+            });
+        }
 
     public:
-        Lambda(ObjectBase<Value>* instance_prototype_p, std::vector<Instruction> code, ObjectBase<Value>* prototype_p, const Value& length_key, const Value& length_value) noexcept
-        : m_own_properties {}, m_code (std::move(code)), m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_instance_prototype {instance_prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_min_arity {static_cast<int16_t>(length_value.to_num_i32().value_or(0))}, m_flags {std::to_underlying(AttrMask::defaults)} {
+        /// NOTE: Instances are placed into this type's slab arena, see `./src/derkjs_impl/runtime/slabs.ixx`.
+        [[nodiscard]] static auto operator new(std::size_t size) -> void* {
+            return slab_allocate<Lambda>(size);
+        }
+
+        static void operator delete(void* ptr, std::size_t size) noexcept {
+            slab_deallocate<Lambda>(ptr, size);
+        }
+
+        Lambda(ObjectBase<Value>* instance_prototype_p, std::vector<Instruction> code, ObjectBase<Value>* prototype_p, const Value& length_key, const Value& length_value, std::vector<ExceptionRange> handlers = {}) noexcept
+        : m_own_properties {}, m_code (std::move(code)), m_handlers (std::move(handlers)), m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_instance_prototype {instance_prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_call_count {0}, m_min_arity {static_cast<int16_t>(length_value.to_num_i32().value_or(0))}, m_flags {std::to_underlying(AttrMask::defaults)}, m_owns_capture {has_upval_stores(m_code)} {
             m_prototype.update_flags(m_flags);
             m_own_properties.emplace_back(length_key, length_value, nullptr);
         }
@@ -328,10 +391,67 @@ export namespace DerkJS {
             return self.m_min_arity;
         } 
 
+        [[nodiscard]] auto owns_capture() const noexcept -> bool {
+            return m_owns_capture;
+        }
+
+        [[nodiscard]] auto get_call_count() const noexcept -> uint32_t {
+            return m_call_count;
+        }
+
+        [[nodiscard]] auto is_hot() const noexcept -> bool {
+            return m_call_count >= hot_call_threshold;
+        }
+
+        /**
+         * @brief For the compiler's escape analysis: turns each `djs_put_const <key>, djs_store_upval` pair into `djs_nop`s when no function can capture that variable. Calls then skip the fresh capture object if no stores are left, since an empty capture object just forwards lookups to the caller's one anyway.
+         * @param is_captured Predicate taking the key's constant ID.
+         */
+        template <typename CapturePred>
+        void elide_upval_stores(CapturePred&& is_captured) {
+            for (std::size_t code_pos = 1; code_pos < m_code.size(); code_pos++) {
+                auto& key_instr = m_code[code_pos - 1];
+                auto& store_instr = m_code[code_pos];
+
+                if (store_instr.op == Opcode::djs_store_upval && key_instr.op == Opcode::djs_put_const && !is_captured(key_instr.args[0])) {
+                    key_instr = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+                    store_instr = Instruction {.args = {0, 0}, .op = Opcode::djs_nop};
+                }
+            }
+
+            m_owns_capture = has_upval_stores(m_code);
+        }
+
+        /// NOTE: For compiler passes over the finished bytecode, e.g superinstruction fusion. The pass takes `std::vector<Instruction>&`, plus `std::vector<ExceptionRange>&` if it moves instructions & must relocate the handlers.
+        template <typename CodePass>
+        void rewrite_code(CodePass&& pass) {
+            if constexpr (std::is_invocable_v<CodePass, std::vector<Instruction>&, std::vector<ExceptionRange>&>) {
+                pass(m_code, m_handlers);
+            } else {
+                pass(m_code);
+            }
+
+            m_owns_capture = has_upval_stores(m_code);
+        }
+
+        /// NOTE: For bytecode caches, which store each compiled function's code.
+        [[nodiscard]] auto view_code() const noexcept -> std::span<const Instruction> {
+            return m_code;
+        }
+
+        /// NOTE: Gives this function's `try` handler table, see `ExceptionRange`.
+        [[nodiscard]] auto view_handlers() const noexcept -> std::span<const ExceptionRange> {
+            return m_handlers;
+        }
+
         [[nodiscard]] auto get_unique_addr() noexcept -> void* override {
             return this;
         }
 
+        [[nodiscard]] auto get_footprint() const noexcept -> std::size_t override {
+            return sizeof(Lambda) + m_own_properties.capacity() * sizeof(PropEntry<Value, Value>) + m_code.capacity() * sizeof(Instruction) + m_handlers.capacity() * sizeof(ExceptionRange);
+        }
+
         [[nodiscard]] auto get_class_name() const noexcept -> std::string override {
             return "function";
         }
@@ -364,7 +484,7 @@ export namespace DerkJS {
             if (key.is_prototype_key()) { // For prototype, not __proto__!
                 return PropertyDescriptor<Value> {key, &m_instance_prototype, this};
             } else if (auto property_entry_it = std::find_if(m_own_properties.begin(), m_own_properties.end(), [&key](const auto& prop) -> bool {
-                return prop.key == key || prop.key.compare_as_object(key);
+                return prop.key.is_same_key(key);
             }); property_entry_it != m_own_properties.end()) {
                 return PropertyDescriptor<Value> {property_entry_it->key, &property_entry_it->item, this};
             } else if ((m_flags & std::to_underlying(AttrMask::writable)) && !m_prototype && allow_filler) {
@@ -416,15 +536,22 @@ export namespace DerkJS {
             auto vm_context_p = reinterpret_cast<ExternVMCtx*>(opaque_ctx_p);
 
             const auto resume_ip = vm_context_p->rip_p + 1;
-            const int16_t caller_rsbp = vm_context_p->rsbp;
-            const int16_t callee_rsbp = vm_context_p->rsp - argc;
+            const int32_t caller_rsbp = vm_context_p->rsbp;
+            const int32_t callee_rsbp = vm_context_p->rsp - argc;
+
+            if (!vm_context_p->reserve_stack(callee_rsbp)) {
+                vm_context_p->status = VMErrcode::stack_overflow;
+                return false;
+            }
 
             // 1.2: Get thisArg and capture objects.
             ObjectBase<Value>* caller_capture_p = vm_context_p->frames.back().capture_p;
             ObjectBase<Value>* callee_pack_p = nullptr;
 
             if (vm_context_p->frames.back().caller_addr != this) {
-                caller_capture_p = vm_context_p->heap.add_item(vm_context_p->heap.get_next_id(), std::make_unique<Object>(caller_capture_p));
+                if (m_owns_capture) {
+                    caller_capture_p = vm_context_p->heap.add_item(vm_context_p->heap.get_next_id(), std::make_unique<Object>(caller_capture_p));
+                }
 
                 if (const int16_t named_arity = min_arity(); argc > named_arity) {
                     callee_pack_p = vm_context_p->heap.add_item(
@@ -441,6 +568,8 @@ export namespace DerkJS {
                 }
             }
 
+            count_call();
+
             if (!has_this_arg) {
                 //? NOTE: `this` defaults to `globalThis` in normal function calls vs. ctor calls.
                 vm_context_p->stack.at(callee_rsbp - 1) = vm_context_p->stack.at(0);
@@ -455,7 +584,9 @@ export namespace DerkJS {
                 .pack_array_p = callee_pack_p,
                 .m_callee_sbp = callee_rsbp,
                 .m_caller_sbp = caller_rsbp,
-                .m_flags = 0
+                .m_flags = 0,
+                .m_code_bp = m_code.data(),
+                .m_handlers = m_handlers
             });
 
             return true;
@@ -467,8 +598,13 @@ export namespace DerkJS {
             auto vm_context_p = reinterpret_cast<ExternVMCtx*>(opaque_ctx_p);
 
             const auto resume_ip = vm_context_p->rip_p + 1;
-            const int16_t callee_rsbp = vm_context_p->rsp - argc;
-            const int16_t caller_rsbp = vm_context_p->rsbp;
+            const int32_t callee_rsbp = vm_context_p->rsp - argc;
+            const int32_t caller_rsbp = vm_context_p->rsbp;
+
+            if (!vm_context_p->reserve_stack(callee_rsbp)) {
+                vm_context_p->status = VMErrcode::stack_overflow;
+                return false;
+            }
 
             ObjectBase<Value>* this_arg_p = vm_context_p->heap.add_item(
                 vm_context_p->heap.get_next_id(),
@@ -480,11 +616,12 @@ export namespace DerkJS {
             }
 
             vm_context_p->stack.at(callee_rsbp - 1) = Value {this_arg_p};
+            count_call();
 
-            // 1.2: Only allocate a capture Object for different callee vs. caller Functions.
+            // 1.2: Only allocate a capture Object for different callee vs. caller Functions, and only if the callee stores upvalues.
             ObjectBase<Value>* caller_capture_p = vm_context_p->frames.back().capture_p;
 
-            if (vm_context_p->frames.back().caller_addr != this) {
+            if (vm_context_p->frames.back().caller_addr != this && m_owns_capture) {
                 caller_capture_p = vm_context_p->heap.add_item(vm_context_p->heap.get_next_id(), std::make_unique<Object>(caller_capture_p));
             }
 
@@ -497,7 +634,9 @@ export namespace DerkJS {
                 .capture_p = caller_capture_p,
                 .m_callee_sbp = callee_rsbp,
                 .m_caller_sbp = caller_rsbp,
-                .m_flags = std::to_underlying(CallFlags::is_ctor)
+                .m_flags = std::to_underlying(CallFlags::is_ctor),
+                .m_code_bp = m_code.data(),
+                .m_handlers = m_handlers
             });
 
             return true;
@@ -518,7 +657,7 @@ export namespace DerkJS {
 
             sout << std::format("[Lambda bytecode-ptr({})] [\n", reinterpret_cast<const void*>(m_code.data()));
 
-            for (auto lambda_bc_pos = 0; const auto& [instr_argv, instr_op] : m_code) {
+            for (auto lambda_bc_pos = 0; const auto& [instr_argv, instr_op, instr_feedback] : m_code) {
                 sout << std::format(
                     "\t{}: {} {} {}\n",
                     lambda_bc_pos,
@@ -0,0 +1,107 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <array>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+export module runtime.console_io;
+
+export namespace DerkJS {
+    /// NOTE: When buffered console output gets written out, besides explicit flushes, reads, & the VM's exit.
+    enum class FlushPolicy : uint8_t {
+        by_size,   // only once the buffer reaches its threshold, which suits piped output
+        by_newline // also after every newline, which suits interactive terminals
+    };
+
+    /// NOTE: Interactive terminals get output per line, so long-running scripts show progress. Piped or redirected output is batched by size.
+    [[nodiscard]] inline auto default_flush_policy() noexcept -> FlushPolicy {
+        return (isatty(STDOUT_FILENO) == 1) ? FlushPolicy::by_newline : FlushPolicy::by_size;
+    }
+
+    /**
+     * @brief Batches a VM's console output into large writes, and reads whole lines from stdin's own buffer. Scripts printing many small pieces (like `console.log()` does per argument) then don't pay a formatted stdio call per piece.
+     * @note Reads flush the output first, so prompts always show before blocking. Each isolate has its own output buffer, but every flush writes whole chunks, so isolates only interleave by chunks.
+     */
+    class ConsoleIO {
+    public:
+        static constexpr std::size_t default_flush_threshold = 8192;
+
+    private:
+        std::string m_out_buffer;
+        std::size_t m_flush_threshold;
+        FlushPolicy m_policy;
+
+    public:
+        explicit ConsoleIO(FlushPolicy policy = default_flush_policy(), std::size_t flush_threshold = default_flush_threshold)
+        : m_out_buffer {}, m_flush_threshold {flush_threshold}, m_policy {policy} {
+            m_out_buffer.reserve(flush_threshold);
+        }
+
+        ConsoleIO(const ConsoleIO&) = delete;
+        ConsoleIO& operator=(const ConsoleIO&) = delete;
+
+        ~ConsoleIO() {
+            flush();
+        }
+
+        void set_policy(FlushPolicy policy, std::size_t flush_threshold) noexcept {
+            m_policy = policy;
+            m_flush_threshold = flush_threshold;
+        }
+
+        void write(std::string_view text) {
+            m_out_buffer.append(text);
+
+            if (m_out_buffer.size() >= m_flush_threshold || (m_policy == FlushPolicy::by_newline && text.contains('\n'))) {
+                flush();
+            }
+        }
+
+        void put(char c) {
+            m_out_buffer.push_back(c);
+
+            if (m_out_buffer.size() >= m_flush_threshold || (c == '\n' && m_policy == FlushPolicy::by_newline)) {
+                flush();
+            }
+        }
+
+        void flush() {
+            if (m_out_buffer.empty()) {
+                return;
+            }
+
+            std::fwrite(m_out_buffer.data(), 1, m_out_buffer.size(), stdout);
+            std::fflush(stdout);
+            m_out_buffer.clear();
+        }
+
+        /**
+         * @brief Reads the next line of stdin without its newline. This goes through the `FILE` buffer by chunks instead of per character, and that buffer is shared by all isolates so none of them steals another's input.
+         * @return False at the end of input with no characters left.
+         */
+        [[nodiscard]] auto read_line(std::string& line) -> bool {
+            std::array<char, 512> chunk;
+
+            flush();
+            line.clear();
+
+            while (std::fgets(chunk.data(), static_cast<int>(chunk.size()), stdin)) {
+                std::string_view chunk_text {chunk.data()};
+
+                if (chunk_text.ends_with('\n')) {
+                    chunk_text.remove_suffix(1);
+                    line.append(chunk_text);
+                    return true;
+                }
+
+                line.append(chunk_text);
+            }
+
+            return !line.empty();
+        }
+    };
+}
@@ -2,12 +2,15 @@ module;
 
 #include <cstdint>
 #include <utility>
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <array>
 #include <vector>
 #include <span>
-#include <span>
 
 export module runtime.context;
 
@@ -15,7 +18,10 @@ import runtime.value;
 import runtime.strings;
 import runtime.object;
 import runtime.bytecode;
+import runtime.interns;
 import runtime.gc;
+export import runtime.console_io;
+export import runtime.profiler;
 
 namespace DerkJS {
     export enum class VMErrcode : uint8_t {
@@ -24,11 +30,25 @@ namespace DerkJS {
         bad_operation,
         bad_heap_alloc,
         vm_abort,
+        stack_overflow, // a call needed more stack than the VM's limit
         uncaught_error,
+        suspended, // the time slice ran out, but the VM can resume
         ok,
         last
     };
 
+    /// NOTE: A `setTimeout()` callback waiting in the job queue. Timers due at the same time run in the order they were queued.
+    export struct TimerJob {
+        ObjectBase<Value>* callback_p;
+        std::chrono::steady_clock::time_point due_time;
+        uint64_t order;
+    };
+
+    /// NOTE: Orders the timer heap so the earliest-due (then earliest-queued) timer is on top.
+    [[nodiscard]] inline auto timer_runs_after(const TimerJob& lhs, const TimerJob& rhs) noexcept -> bool {
+        return (lhs.due_time != rhs.due_time) ? lhs.due_time > rhs.due_time : lhs.order > rhs.order;
+    }
+
     /**
      * @brief Provides the bytecode VM's call frame type. The full specializations by `DispatchPolicy` are meant for use.
      * @see `DispatchPolicy` for more information about how opcodes would be dispatched.
@@ -43,6 +63,10 @@ namespace DerkJS {
         int m_caller_sbp;
         uint8_t m_flags;
 
+        /// NOTE: The callee's code buffer & its `try` handler table. Native callees have neither.
+        const Instruction* m_code_bp;
+        std::span<const ExceptionRange> m_handlers;
+
         template <CallFlags F>
         friend constexpr auto derkjs_call_flag(const CallFrame& frame) noexcept -> bool {
             if constexpr (F == CallFlags::is_ctor) {
@@ -53,17 +77,68 @@ namespace DerkJS {
         }
     };
 
+    /// NOTE: One cached property location of an access site. Own properties have no `holder_p`, but direct prototype hits keep the prototype and its shape. Cached property additions (object literal fields) keep the resulting shape in `next_shape_p`.
+    export struct PropCacheEntry {
+        const PropShape* shape_p;
+        const PropShape* holder_shape_p;
+        const PropShape* next_shape_p;
+        ObjectBase<Value>* holder_p;
+        const ObjectBase<Value>* key_p;
+        int slot;
+    };
+
+    /// NOTE: Per-instruction inline cache for `djs_get_prop` & `djs_put_prop`. It's monomorphic after the 1st fill and polymorphic up to `max_entries` shapes. Any megamorphic site stays on the uncached path past that.
+    export struct PropInlineCache {
+        static constexpr int max_entries = 4;
+
+        std::array<PropCacheEntry, max_entries> entries;
+        int count;
+    };
+
+    [[nodiscard]] auto find_prop_slot(PropPool<Value, Value>& props, const Value* item_p) noexcept -> int {
+        for (int slot = 0; auto& entry : props) {
+            if (&entry.item == item_p) {
+                return slot;
+            }
+
+            ++slot;
+        }
+
+        return -1;
+    }
+
     /// NOTE: This type decouples the internal state of the bytecode VM.
     export struct ExternVMCtx {
         using call_frame_type = CallFrame;
         using runtime_object_ptr = ObjectBase<Value>*;
         using compile_snippet_fn = runtime_object_ptr (*) (void*, void*, void*, void*, const std::span<Value>&);
 
+        /// NOTE: The stack grows by these many slots, and each call needs this many free slots past its frame base. This is the per-frame cap on temporaries, which the compiler keeps by limiting array literals & argument lists to `max_listed_items`.
+        static constexpr std::size_t stack_segment_length = 8192;
+
+        /// NOTE: Most nested native-to-JS calls (see `call_reentrant()`), since each one re-enters dispatch on the native stack. Isolate worker threads may have small native stacks, so this stays far below what the VM stack allows.
+        static constexpr int max_reentry_depth = 128;
+        //? NOTE: The rest of each frame's room holds the few operands each level of nested expressions keeps.
+        static_assert(stack_segment_length >= static_cast<std::size_t>(max_listed_items + max_frame_locals) + 2048);
+
         GC gc;
         PolyPool<ObjectBase<Value>> heap;
+        InternTable interns;
         std::array<ObjectBase<Value>*, static_cast<std::size_t>(BuiltInObjects::last)> builtins;
         std::vector<Value> stack;
         std::vector<CallFrame> frames;
+        std::vector<PropInlineCache> prop_caches;
+
+        /// NOTE: The job queue: `queueMicrotask()` callbacks run first by FIFO order, then any due timers from a min-heap by due time.
+        std::deque<ObjectBase<Value>*> microtasks;
+        std::vector<TimerJob> timers;
+        uint64_t next_timer_order;
+
+        /// NOTE: Buffered stdout & line-reading stdin for the console natives.
+        ConsoleIO console;
+
+        /// NOTE: Only fed by `DERKJS_PROFILE` builds, see `runtime/profiler.ixx`.
+        OpProfiler profiler;
 
         void* lexer_p;
         void* parser_p;
@@ -86,21 +161,34 @@ namespace DerkJS {
 
         std::size_t ending_frame_depth;
 
+        /// NOTE: The frame depth which the host's dispatch ends at. Only dispatches at this depth can yield, since nested ones for natives cannot be resumed by the host.
+        std::size_t slice_frame_depth;
+
+        /// NOTE: Counts the `call_reentrant()` calls in progress, up to `max_reentry_depth`.
+        int reentry_depth;
+
         /// NOTE: holds stack base pointer for call locals
-        int16_t rsbp;
+        int32_t rsbp;
 
         /// NOTE: holds stack top pointer
-        int16_t rsp;
+        int32_t rsp;
+
+        /// NOTE: Safepoints (backward jumps & calls) allowed per time slice, or 0 for no time-slicing.
+        int32_t slice_budget;
 
-        // int16_t dispatch_allowance;
+        /// NOTE: Safepoints left in the current time slice.
+        int32_t dispatch_allowance;
 
         VMErrcode status;
 
         ExternVMCtx(Program& prgm, std::size_t stack_length_limit, std::size_t call_frame_limit, std::size_t gc_heap_threshold, void* lexer_ptr, void* parser_ptr, void* compile_state_ptr, compile_snippet_fn compile_proc_ptr)
-        : gc {gc_heap_threshold}, heap (std::move(prgm.heap_items)), builtins(std::move(prgm.builtins)), stack {}, frames {}, lexer_p {lexer_ptr}, parser_p {parser_ptr}, compile_state_p {compile_state_ptr}, compile_proc {compile_proc_ptr}, consts_view {prgm.consts.data()}, current_error {nullptr}, code_bp {prgm.code.data()}, fn_table_bp {prgm.offsets.data()}, rip_p {prgm.code.data() + prgm.offsets[prgm.entry_func_id]}, ending_frame_depth {0}, rsbp {-1}, rsp {-1}, /*dispatch_allowance {100},*/ status {VMErrcode::pending} {
+        : gc {gc_heap_threshold}, heap (std::move(prgm.heap_items)), interns {}, builtins(std::move(prgm.builtins)), stack {}, frames {}, prop_caches {}, microtasks {}, timers {}, next_timer_order {0}, console {}, profiler {}, lexer_p {lexer_ptr}, parser_p {parser_ptr}, compile_state_p {compile_state_ptr}, compile_proc {compile_proc_ptr}, consts_view {prgm.consts.data()}, current_error {nullptr}, code_bp {prgm.code.data()}, fn_table_bp {prgm.offsets.data()}, rip_p {prgm.code.data() + prgm.offsets[prgm.entry_func_id]}, ending_frame_depth {0}, slice_frame_depth {0}, reentry_depth {0}, rsbp {-1}, rsp {-1}, slice_budget {0}, dispatch_allowance {0}, status {VMErrcode::pending} {
+            //? NOTE: The whole limit is reserved as address space once, so growing never moves the slots which `Value` references point to. Only the used segments are constructed & touched.
             stack.reserve(stack_length_limit);
-            stack.resize(stack_length_limit);
+            stack.resize(std::min(stack_length_limit, 2 * stack_segment_length));
             frames.reserve(call_frame_limit);
+            prop_caches.resize(prgm.prop_cache_count, PropInlineCache {});
+            intern_preloaded_keys(prgm);
 
             if (auto global_this_p = heap.add_item(heap.get_next_id(), std::make_unique<Object>(nullptr)); !global_this_p) {
                 status = VMErrcode::bad_heap_alloc;
@@ -112,7 +200,15 @@ namespace DerkJS {
                     .pack_array_p = nullptr,
                     .m_callee_sbp = 1,
                     .m_caller_sbp = -1,
+                    .m_flags = 0,
+                    .m_code_bp = prgm.code.data(),
+                    .m_handlers = prgm.handlers
                 });
+                //? NOTE: The top-level frame gets the same room past its variables as any call.
+                if (!reserve_stack(1 + top_level_extent_of(prgm))) {
+                    status = VMErrcode::stack_overflow;
+                }
+
                 // 2. Push globalThis for implicit main code...
                 ++rsp;
                 stack.at(rsp) = Value {global_this_p};
@@ -123,6 +219,152 @@ namespace DerkJS {
             }
         }
 
+        /// NOTE: Shades the GC roots: the live stack slots, every call frame's objects, any thrown error, and the queued jobs.
+        void mark_roots(GC& collector) {
+            for (int gc_sp = 0; gc_sp <= rsp; gc_sp++) {
+                collector.shade(stack[gc_sp]);
+            }
+
+            for (const auto& [caller_ret_ip, caller_addr, caller_capture_p, pack_array_ptr, callee_sbp, caller_sbp, calling_flags, callee_code_bp, callee_handlers] : frames) {
+                collector.shade(caller_addr);
+                collector.shade(caller_capture_p);
+                collector.shade(pack_array_ptr);
+            }
+
+            collector.shade(current_error);
+
+            for (auto microtask_p : microtasks) {
+                collector.shade(microtask_p);
+            }
+
+            for (const auto& timer : timers) {
+                collector.shade(timer.callback_p);
+            }
+        }
+
+        /// NOTE: Gives the highest top-level variable slot, past which the top-level code pushes its temporaries.
+        [[nodiscard]] static auto top_level_extent_of(const Program& prgm) noexcept -> std::size_t {
+            int top_level_extent = 0;
+
+            for (const auto& [global_name, global_loc] : prgm.globals) {
+                top_level_extent = std::max<int>(top_level_extent, global_loc.n);
+            }
+
+            return static_cast<std::size_t>(top_level_extent);
+        }
+
+        /**
+         * @brief Makes sure a frame based at `frame_base` has a whole segment of free slots past it, growing the stack by segments up to its limit.
+         * @return False if the stack's limit is too small, which callers report as `VMErrcode::stack_overflow`.
+         */
+        [[nodiscard]] auto reserve_stack(std::size_t frame_base) -> bool {
+            const std::size_t needed_length = frame_base + stack_segment_length;
+
+            if (needed_length <= stack.size()) {
+                return true;
+            } else if (needed_length > stack.capacity()) {
+                return false;
+            }
+
+            const std::size_t grown_length = (needed_length + stack_segment_length - 1) / stack_segment_length * stack_segment_length;
+            stack.resize(std::min(grown_length, stack.capacity()));
+
+            return true;
+        }
+
+        /// NOTE: Runs a GC step (or a whole collection) before an allocation.
+        void collect_garbage() {
+            gc(heap, interns, [this](GC& collector) {
+                mark_roots(collector);
+            });
+        }
+
+        /// NOTE: Reaps unreachable young objects right away. Values held outside the VM e.g an embedder's call arguments must be passed as `extra_roots`.
+        void collect_young(std::span<const Value> extra_roots) {
+            gc.collect_young(heap, interns, [this, extra_roots](GC& collector) {
+                mark_roots(collector);
+
+                for (const auto& root : extra_roots) {
+                    collector.shade(root);
+                }
+            });
+        }
+
+        /// NOTE: Write barrier for stores through a property or variable reference, whose holder object is unknown. Stack slots are GC roots anyways, so they're skipped.
+        void write_barrier_at(const Value* dest_p, const Value& stored_value) {
+            if (const Value* stack_bp = stack.data(); dest_p >= stack_bp && dest_p < stack_bp + stack.size()) {
+                return;
+            }
+
+            gc.write_barrier(nullptr, stored_value);
+        }
+
+        void enqueue_microtask(ObjectBase<Value>* callback_p) {
+            microtasks.push_back(callback_p);
+        }
+
+        void enqueue_timer(ObjectBase<Value>* callback_p, double delay_ms) {
+            const auto delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli> {std::max(delay_ms, 0.0)});
+
+            timers.emplace_back(TimerJob {
+                .callback_p = callback_p,
+                .due_time = std::chrono::steady_clock::now() + delay,
+                .order = next_timer_order++
+            });
+            std::ranges::push_heap(timers, timer_runs_after);
+        }
+
+        /// NOTE: Dequeues the next job to run by `now`: microtasks go before any timers.
+        [[nodiscard]] auto take_ready_job(std::chrono::steady_clock::time_point now) -> ObjectBase<Value>* {
+            if (!microtasks.empty()) {
+                auto microtask_p = microtasks.front();
+                microtasks.pop_front();
+                return microtask_p;
+            }
+
+            if (!timers.empty() && timers.front().due_time <= now) {
+                std::ranges::pop_heap(timers, timer_runs_after);
+                auto timer_callback_p = timers.back().callback_p;
+                timers.pop_back();
+                return timer_callback_p;
+            }
+
+            return nullptr;
+        }
+
+        [[nodiscard]] auto next_timer_due() const noexcept -> std::optional<std::chrono::steady_clock::time_point> {
+            if (timers.empty()) {
+                return {};
+            }
+
+            return timers.front().due_time;
+        }
+
+        /// NOTE: Canonicalizes the built-in key strings, every preloaded object's string keys, and the string constants. The compiler only dedupes its own key constants, so the natives' property names may still be duplicates until here.
+        void intern_preloaded_keys(Program& prgm) {
+            for (const auto builtin_key_id : {BuiltInObjects::extra_length_key, BuiltInObjects::extra_msg_key, BuiltInObjects::extra_name_key}) {
+                auto& builtin_key_p = builtins[static_cast<std::size_t>(builtin_key_id)];
+
+                if (auto canonical_p = interns.intern(builtin_key_p); canonical_p) {
+                    builtin_key_p = canonical_p;
+                }
+            }
+
+            for (const auto& item_sp : heap.items()) {
+                if (!item_sp) {
+                    continue;
+                }
+
+                for (auto& prop_entry : item_sp->get_own_prop_pool()) {
+                    interns.intern_key(prop_entry.key);
+                }
+            }
+
+            for (auto& const_value : prgm.consts) {
+                interns.intern_key(const_value);
+            }
+        }
+
         /// NOTE: Only use this to push an exception object for opcodes corresponding to JS operators e.g TypeError on an invalid `djs_get_prop`. Returns `true` if the error object was allocated AND the error ctor ID was valid.
         [[nodiscard]] auto prepare_error(std::string msg, std::uint8_t builtin_id) -> bool {
             rsp++;
@@ -146,34 +388,207 @@ namespace DerkJS {
             return true;
         }
 
-        /// NOTE: Only use this for "throwing" exceptions in the VM!
-        [[nodiscard]] auto try_recover(ObjectBase<Value>* error_ptr, bool is_throw_within_try) -> VMErrcode {
+        /**
+         * @brief Only use this for "throwing" exceptions in the VM! Looks up the innermost handler covering the throw site in each frame's table, unwinding frames without one. `RIP` must still be at the throwing instruction.
+         * @note Unwinding stops at `ending_frame_depth`, so an error escaping a re-entrant call stays uncaught there. The implicit top-level frame is never popped.
+         */
+        [[nodiscard]] auto try_recover(ObjectBase<Value>* error_ptr) -> VMErrcode {
             current_error = error_ptr;
 
-            auto search_for_catch = is_throw_within_try;
-            auto peek_rip_p = rip_p;
+            const Instruction* throw_site_p = rip_p;
 
-            for (; !frames.empty() && peek_rip_p != nullptr; peek_rip_p++) {
-                if (search_for_catch && peek_rip_p->op == Opcode::djs_catch) {
-                    rip_p = peek_rip_p;
-                    return VMErrcode::pending;
-                }
+            while (frames.size() > ending_frame_depth) {
+                const auto& [caller_ret_ip, caller_addr, caller_capture_p, pack_array_ptr, callee_sbp, caller_sbp, calling_flags, callee_code_bp, callee_handlers] = frames.back();
 
-                if (const auto& [caller_ret_ip, caller_addr, caller_capture_p, pack_array_ptr, callee_sbp, caller_sbp, calling_flags] = frames.back(); peek_rip_p->op == Opcode::djs_ret) {
-                    rsbp = caller_sbp;
-                    rsp = callee_sbp;
-                    rip_p = caller_ret_ip;
-                    peek_rip_p = caller_ret_ip;
+                if (callee_code_bp && throw_site_p) {
+                    const int throw_pos = throw_site_p - callee_code_bp;
 
-                    frames.pop_back();
+                    for (const auto& [try_begin, try_end, handler_pos] : callee_handlers) {
+                        if (throw_pos >= try_begin && throw_pos < try_end) {
+                            rip_p = callee_code_bp + handler_pos;
+                            return VMErrcode::pending;
+                        }
+                    }
+                }
 
-                    search_for_catch = true;
+                if (frames.size() == 1) {
+                    break;
                 }
+
+                //? NOTE: The caller's throw site is its call instruction, which is just before the return address.
+                rsbp = caller_sbp;
+                rsp = callee_sbp;
+                rip_p = caller_ret_ip;
+                throw_site_p = (caller_ret_ip) ? caller_ret_ip - 1 : nullptr;
+
+                frames.pop_back();
             }
 
             return VMErrcode::uncaught_error;
         }
 
+        /// NOTE: Probes a property access site's inline cache, yielding the cached property slot on a hit. Cached additions never hit here because they need a store.
+        [[nodiscard]] auto probe_prop_cache(int cache_id, ObjectBase<Value>* target_p, const ObjectBase<Value>* key_p) -> Value* {
+            if (cache_id < 0 || cache_id >= static_cast<int>(prop_caches.size())) {
+                return nullptr;
+            }
+
+            const auto& [cache_entries, cache_count] = prop_caches[cache_id];
+            const PropShape* target_shape_p = target_p->get_shape();
+
+            if (!target_shape_p) {
+                return nullptr;
+            }
+
+            for (int entry_pos = 0; entry_pos < cache_count; entry_pos++) {
+                const auto& [shape_p, holder_shape_p, next_shape_p, holder_p, cached_key_p, slot] = cache_entries[entry_pos];
+
+                if (shape_p != target_shape_p || cached_key_p != key_p || next_shape_p != nullptr) {
+                    continue;
+                } else if (!holder_p) {
+                    return &target_p->get_own_prop_pool()[slot].item;
+                } else if (target_p->get_prototype() == holder_p && holder_p->get_shape() == holder_shape_p) {
+                    return &holder_p->get_own_prop_pool()[slot].item;
+                }
+            }
+
+            return nullptr;
+        }
+
+        /// NOTE: Records where an uncached lookup found `item_p`: either among the target's own properties or its direct prototype's. Deeper prototype hits are not cached.
+        void fill_prop_cache(int cache_id, ObjectBase<Value>* target_p, const ObjectBase<Value>* key_p, const Value* item_p, bool own_only) {
+            if (cache_id < 0 || key_p == nullptr || item_p == nullptr) {
+                return;
+            }
+
+            if (cache_id >= static_cast<int>(prop_caches.size())) {
+                //? NOTE: `Function()` snippets compiled at runtime may add more cached sites.
+                prop_caches.resize(cache_id + 1, PropInlineCache {});
+            }
+
+            auto& [cache_entries, cache_count] = prop_caches[cache_id];
+            const PropShape* target_shape_p = target_p->get_shape();
+
+            if (cache_count >= PropInlineCache::max_entries || !target_shape_p) {
+                return;
+            }
+
+            if (const int own_slot = find_prop_slot(target_p->get_own_prop_pool(), item_p); own_slot != -1) {
+                cache_entries[cache_count] = PropCacheEntry {
+                    .shape_p = target_shape_p,
+                    .holder_shape_p = nullptr,
+                    .next_shape_p = nullptr,
+                    .holder_p = nullptr,
+                    .key_p = key_p,
+                    .slot = own_slot
+                };
+                ++cache_count;
+                return;
+            }
+
+            ObjectBase<Value>* holder_p = target_p->get_prototype();
+
+            if (own_only || !holder_p || !holder_p->get_shape()) {
+                return;
+            }
+
+            if (const int holder_slot = find_prop_slot(holder_p->get_own_prop_pool(), item_p); holder_slot != -1) {
+                cache_entries[cache_count] = PropCacheEntry {
+                    .shape_p = target_shape_p,
+                    .holder_shape_p = holder_p->get_shape(),
+                    .next_shape_p = nullptr,
+                    .holder_p = holder_p,
+                    .key_p = key_p,
+                    .slot = holder_slot
+                };
+                ++cache_count;
+            }
+        }
+
+        /// NOTE: Tries a cached property store for a `djs_put_prop` site. Overwrites check the usual writable flag, while additions take the cached shape transition.
+        [[nodiscard]] auto store_prop_cached(int cache_id, ObjectBase<Value>* target_p, const Value& key, const Value& value) -> Value* {
+            if (cache_id < 0 || cache_id >= static_cast<int>(prop_caches.size())) {
+                return nullptr;
+            }
+
+            auto key_copy = key;
+            const ObjectBase<Value>* key_p = key_copy.to_object();
+            const auto& [cache_entries, cache_count] = prop_caches[cache_id];
+            const PropShape* target_shape_p = target_p->get_shape();
+
+            if (!target_shape_p || !key_p) {
+                return nullptr;
+            }
+
+            for (int entry_pos = 0; entry_pos < cache_count; entry_pos++) {
+                const auto& [shape_p, holder_shape_p, next_shape_p, holder_p, cached_key_p, slot] = cache_entries[entry_pos];
+
+                if (shape_p != target_shape_p || cached_key_p != key_p || holder_p != nullptr) {
+                    continue;
+                } else if (next_shape_p) {
+                    return target_p->append_shaped_property(key, value, next_shape_p);
+                }
+
+                auto value_copy = value;
+                value_copy.set_flag<AttrMask::property>();
+
+                if (PropertyDescriptor<Value> cached_desc {key, &target_p->get_own_prop_pool()[slot].item, target_p}; cached_desc.set_value(key, value_copy)) {
+                    return cached_desc.ref_value();
+                }
+
+                return nullptr;
+            }
+
+            return nullptr;
+        }
+
+        /// NOTE: Records an uncached `djs_put_prop` into its site's cache, given the target's shape from before the store.
+        void fill_store_cache(int cache_id, ObjectBase<Value>* target_p, const ObjectBase<Value>* key_p, const PropShape* old_shape_p, const Value* item_p) {
+            if (cache_id < 0 || key_p == nullptr || item_p == nullptr || old_shape_p == nullptr) {
+                return;
+            }
+
+            if (cache_id >= static_cast<int>(prop_caches.size())) {
+                prop_caches.resize(cache_id + 1, PropInlineCache {});
+            }
+
+            auto& [cache_entries, cache_count] = prop_caches[cache_id];
+            const PropShape* new_shape_p = target_p->get_shape();
+
+            //? NOTE: Dictionary mode objects are shapeless, so skip the slot scan over their (large) property pools.
+            if (cache_count >= PropInlineCache::max_entries || !new_shape_p) {
+                return;
+            }
+
+            const int slot = find_prop_slot(target_p->get_own_prop_pool(), item_p);
+
+            if (slot == -1) {
+                return;
+            }
+
+            if (new_shape_p == old_shape_p) {
+                cache_entries[cache_count] = PropCacheEntry {
+                    .shape_p = old_shape_p,
+                    .holder_shape_p = nullptr,
+                    .next_shape_p = nullptr,
+                    .holder_p = nullptr,
+                    .key_p = key_p,
+                    .slot = slot
+                };
+                ++cache_count;
+            } else if (new_shape_p->get_parent() == old_shape_p && slot == old_shape_p->get_slot_count()) {
+                cache_entries[cache_count] = PropCacheEntry {
+                    .shape_p = old_shape_p,
+                    .holder_shape_p = nullptr,
+                    .next_shape_p = new_shape_p,
+                    .holder_p = nullptr,
+                    .key_p = key_p,
+                    .slot = slot
+                };
+                ++cache_count;
+            }
+        }
+
         [[nodiscard]] auto push_string(const std::string& s, const int passed_rsbp) noexcept -> bool {
             if (auto temp_str_p = heap.add_item(heap.get_next_id(), std::make_unique<DynamicString>(
                 stack.at(passed_rsbp).to_object()->get_instance_prototype(),
@@ -187,5 +602,20 @@ namespace DerkJS {
             status = VMErrcode::bad_heap_alloc;   
             return false;
         }
+
+        /// NOTE: Like `push_string()`, but the result string lazily holds the rope's text.
+        [[nodiscard]] auto push_rope(RopePtr rope, const int passed_rsbp) noexcept -> bool {
+            if (auto temp_str_p = heap.add_item(heap.get_next_id(), std::make_unique<DynamicString>(
+                stack.at(passed_rsbp).to_object()->get_instance_prototype(),
+                builtins.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key)),
+                std::move(rope)
+            )); temp_str_p) {
+                stack.at(passed_rsbp - 1) = Value {temp_str_p};
+                return true;
+            }
+
+            status = VMErrcode::bad_heap_alloc;
+            return false;
+        }
     };
 }
\ No newline at end of file
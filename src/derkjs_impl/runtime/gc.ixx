@@ -1,107 +1,441 @@
 module;
 
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <string>
 #include <vector>
-#include <queue>
 #include <flat_map>
 #include <print>
+#include <iostream>
 
 export module runtime.gc;
 
 import runtime.value;
+import runtime.interns;
 
 namespace DerkJS {
-    /// Indicates reachability status for objects.
-    enum class GCMark : uint8_t {
-        dead,
-        live
+    export enum class GCMode : uint8_t {
+        stop_world,  // finish a whole cycle per collection
+        incremental  // do at most `GC::default_step_budget` work units per allocation
     };
 
-    struct GCEntry {
-        int object_id;
-        GCMark mark;
+    export enum class GCPhase : uint8_t {
+        idle,
+        marking,
+        sweeping
     };
 
+    /// NOTE: Running totals of the collector's work. Each `GC::operator()` call doing any work counts as one pause, and its time is split by phase: root scans, marking, sweeping, and any nursery collection.
+    export struct GCStats {
+        std::chrono::nanoseconds root_time;
+        std::chrono::nanoseconds mark_time;
+        std::chrono::nanoseconds sweep_time;
+        std::chrono::nanoseconds minor_time;
+        std::chrono::nanoseconds total_pause;
+        std::chrono::nanoseconds max_pause;
+        uint64_t pause_count;
+        uint64_t major_cycles;
+        uint64_t minor_collections;
+        uint64_t major_reaped;
+        uint64_t minor_reaped;
+        std::size_t peak_bytes;
+    };
+
+    /**
+     * @brief Tri-color mark & sweep collector. Mark "bits" are epochs stored inline in each `ObjectBase` header: an object is white if its epoch is stale, gray if marked but still on `m_gray`, and black once its references are pushed. Starting a cycle just bumps the epoch, so no census or reset pass over the heap is needed.
+     * @note In incremental mode, the mutator runs between steps. Any store of an object reference into another heap object must call `write_barrier()` for the (Dijkstra) tri-color invariant, but stack & call frame roots are rescanned before marking ends.
+     * @note There's also a young generation: the heap's nursery of objects allocated since the last minor collection. Minor collections only trace from the roots plus a remembered set of old objects that may reference young ones, then they reap dead young objects & promote survivors. These only run while no major cycle is in progress.
+     */
     export class GC {
+    public:
+        static constexpr int default_step_budget = 64;
+        static constexpr int default_nursery_limit = 512;
+
     private:
-        /// Census of all raw object pointers to their IDs & has liveness info.
-        std::flat_map<void*, GCEntry> m_tracked;
+        using clock_type = std::chrono::steady_clock;
+
+        std::vector<ObjectBase<Value>*> m_gray;
+        std::vector<ObjectBase<Value>*> m_remembered;
+        GCStats m_stats;
+        clock_type::time_point m_start_time;
         std::size_t m_threshold;
+        int m_step_budget;
+        int m_nursery_limit;
+        int m_sweep_pos;
+        int m_reap_count;
+        int m_minor_reap_count;
+        int m_promote_count;
+        uint32_t m_epoch;
+        GCMode m_mode;
+        GCPhase m_phase;
+        bool m_in_minor; // redirects `shade()` to nursery marks during minor collections
 
-    public:
-        GC(std::size_t max_overhead)
-        : m_tracked {}, m_threshold {max_overhead} {}
-        
-        void operator()(PolyPool<ObjectBase<Value>>& heap, std::vector<Value>& stack, int rsp) {
-            using derkjs_object_ptr = ObjectBase<Value>*;
+        void blacken(ObjectBase<Value>* object_p) {
+            if (auto maybe_array_items_p = object_p->get_seq_items(); maybe_array_items_p) {
+                for (auto& item_value : *maybe_array_items_p) {
+                    shade(item_value);
+                }
+            }
 
-            auto& heap_items = heap.items();
-            const auto heap_overhead_sz = heap.get_overhead();
-            auto reap_count = 0;
+            for (auto& [prop_key, prop_v, prop_handler_p] : object_p->get_own_prop_pool()) {
+                //? NOTE: Interned keys are only weakly held by the `InternTable`, so live objects must keep their keys alive.
+                shade(prop_key);
+                shade(prop_v);
+            }
+
+            shade(object_p->get_prototype());
+        }
+
+        /// NOTE: Reaps the slot if white, but tenured items are never freed. Dead interned strings must leave the intern table first.
+        void sweep_slot(PolyPool<ObjectBase<Value>>& heap, InternTable& interns, int slot_id) {
+            auto item_p = heap.get_item(slot_id);
 
-            if (heap_overhead_sz < m_threshold) {
+            if (!item_p) {
                 return;
+            } else if (heap.is_tenured(slot_id) || item_p->get_gc_epoch() == m_epoch) {
+                //? NOTE: Survivors may have grown since they were counted.
+                heap.remeasure_item(slot_id);
+                return;
+            }
+
+            interns.forget(item_p);
+
+            if (item_p->has_gc_flag(GCHeaderFlag::remembered)) {
+                std::erase(m_remembered, item_p);
+            }
+
+            if (heap.remove_item(slot_id)) {
+                ++m_reap_count;
+                ++m_stats.major_reaped;
+            }
+        }
+
+        void remember(ObjectBase<Value>* object_p) {
+            if (!object_p->has_gc_flag(GCHeaderFlag::remembered)) {
+                object_p->set_gc_flag(GCHeaderFlag::remembered);
+                m_remembered.emplace_back(object_p);
             }
+        }
+
+        /// NOTE: Reaps dead young objects and promotes the surviving ones. Old objects are never traced through here unless remembered.
+        template <typename RootMarker>
+        void collect_nursery(PolyPool<ObjectBase<Value>>& heap, InternTable& interns, RootMarker&& mark_roots) {
+            const auto minor_begin = clock_type::now();
 
-            int heap_count = heap_items.size();
+            m_in_minor = true;
+            m_minor_reap_count = 0;
 
-            // 1. Census all heap object pointers to IDs.
-            for (int heap_id = 0; heap_id < heap_count; heap_id++) {
-                derkjs_object_ptr temp_p = heap_items.at(heap_id).get();
+            mark_roots(*this);
 
-                m_tracked[temp_p] = GCEntry {
-                    .object_id = heap_id,
-                    .mark = GCMark::dead
-                };
+            for (auto remembered_p : m_remembered) {
+                blacken(remembered_p);
+                remembered_p->clear_gc_flag(GCHeaderFlag::remembered);
             }
 
-            // 2. DFS (sweep) over each object reference in the stack, updating reachability data if needed.
-            std::queue<derkjs_object_ptr> frontier;
+            m_remembered.clear();
 
-            for (int gc_sp = 0; gc_sp < rsp; gc_sp++) {
-                if (derkjs_object_ptr temp_root = stack.at(gc_sp).to_object(); temp_root) {
-                    frontier.push(temp_root);
+            while (!m_gray.empty()) {
+                auto next_p = m_gray.back();
+                m_gray.pop_back();
+
+                blacken(next_p);
+            }
+
+            m_in_minor = false;
+
+            for (const auto young_id : heap.get_nursery()) {
+                auto young_p = heap.get_item(young_id);
+
+                //? NOTE: Skip stale IDs & young objects promoted early by the write barrier.
+                if (!young_p || !young_p->has_gc_flag(GCHeaderFlag::young)) {
+                    continue;
+                } else if (young_p->has_gc_flag(GCHeaderFlag::nursery_live)) {
+                    ++m_promote_count;
+                    continue;
+                }
+
+                interns.forget(young_p);
+
+                if (heap.remove_item(young_id)) {
+                    ++m_minor_reap_count;
                 }
             }
 
-            while (!frontier.empty()) {
-                auto next_ptr = frontier.front();
-                frontier.pop();
+            heap.promote_nursery();
+
+            m_stats.minor_reaped += m_minor_reap_count;
+            ++m_stats.minor_collections;
+            m_stats.minor_time += clock_type::now() - minor_begin;
+        }
+
+        /// NOTE: Charges the time since `segment_begin` to the phase's total, then restarts the segment.
+        void charge_phase(GCPhase phase, clock_type::time_point& segment_begin) {
+            const auto segment_end = clock_type::now();
+
+            if (phase == GCPhase::marking) {
+                m_stats.mark_time += segment_end - segment_begin;
+            } else {
+                m_stats.sweep_time += segment_end - segment_begin;
+            }
 
-                if (m_tracked.at(next_ptr).mark == GCMark::live) {
+            segment_begin = segment_end;
+        }
+
+        void record_pause(clock_type::time_point pause_begin, clock_type::time_point pause_end) {
+            const auto pause_time = std::chrono::duration_cast<std::chrono::nanoseconds>(pause_end - pause_begin);
+
+            m_stats.total_pause += pause_time;
+            m_stats.max_pause = std::max(m_stats.max_pause, pause_time);
+            ++m_stats.pause_count;
+        }
+
+        /// NOTE: Root scans are timed apart from the rest of marking.
+        template <typename RootMarker>
+        void scan_roots(RootMarker&& mark_roots, clock_type::time_point& segment_begin) {
+            charge_phase(GCPhase::marking, segment_begin);
+            mark_roots(*this);
+
+            const auto scan_end = clock_type::now();
+            m_stats.root_time += scan_end - segment_begin;
+            segment_begin = scan_end;
+        }
+
+        void begin_marking(PolyPool<ObjectBase<Value>>& heap) {
+            ++m_epoch;
+
+            if (m_epoch == 0) {
+                //? NOTE: Epoch 0 stays reserved for never-marked objects even after wrapping.
+                ++m_epoch;
+            }
+
+            //? NOTE: Objects allocated during marking start white, as the barrier & the final root scan still reach live ones.
+            heap.set_alloc_epoch(0);
+            m_reap_count = 0;
+            m_phase = GCPhase::marking;
+        }
+
+        void begin_sweeping(PolyPool<ObjectBase<Value>>& heap, InternTable& interns) {
+            //? NOTE: Tenured items are never freed, so they're stamped live even if marking missed them. Otherwise the intern table would treat tenured canonical keys (e.g compiled property names) as condemned and intern duplicates.
+            for (int slot_id = 0, slot_count = heap.view_items().size(); slot_id < slot_count && heap.is_tenured(slot_id); slot_id++) {
+                if (auto item_p = heap.get_item(slot_id); item_p) {
+                    item_p->set_gc_epoch(m_epoch);
+                }
+            }
+
+            //? NOTE: Objects allocated during sweeping are live by definition, so they're pre-marked.
+            heap.set_alloc_epoch(m_epoch);
+            interns.begin_sweep(m_epoch);
+            m_sweep_pos = 0;
+            m_phase = GCPhase::sweeping;
+        }
+
+        void end_sweeping(InternTable& interns) {
+            interns.end_sweep();
+            m_phase = GCPhase::idle;
+            ++m_stats.major_cycles;
+        }
+
+    public:
+        GC(std::size_t max_overhead, GCMode mode = GCMode::incremental, int step_budget = default_step_budget, int nursery_limit = default_nursery_limit)
+        : m_gray {}, m_remembered {}, m_stats {}, m_start_time {clock_type::now()}, m_threshold {max_overhead}, m_step_budget {step_budget}, m_nursery_limit {nursery_limit}, m_sweep_pos {0}, m_reap_count {0}, m_minor_reap_count {0}, m_promote_count {0}, m_epoch {0}, m_mode {mode}, m_phase {GCPhase::idle}, m_in_minor {false} {}
+
+        [[nodiscard]] auto get_phase() const noexcept -> GCPhase {
+            return m_phase;
+        }
+
+        [[nodiscard]] auto get_stats() const noexcept -> const GCStats& {
+            return m_stats;
+        }
+
+        /**
+         * @brief Prints the collector's stats and a census of the heap by class name, e.g on exit or when a script asks.
+         * @note Live bytes are recounted here, so they include any growth since objects were last measured.
+         */
+        void print_report(const PolyPool<ObjectBase<Value>>& heap) const {
+            struct HeapClassCensus {
+                std::size_t count;
+                std::size_t bytes;
+            };
+
+            using std::chrono::duration_cast;
+            using std::chrono::microseconds;
+
+            std::flat_map<std::string, HeapClassCensus> heap_census;
+            std::size_t live_count = 0;
+            std::size_t live_bytes = 0;
+
+            for (const auto& item_sp : heap.view_items()) {
+                if (!item_sp) {
                     continue;
                 }
 
-                m_tracked.at(next_ptr).mark = GCMark::live;
+                auto& [class_count, class_bytes] = heap_census[item_sp->get_class_name()];
+                const auto item_bytes = item_sp->get_footprint();
 
-                if (auto maybe_array_items_p = next_ptr->get_seq_items(); maybe_array_items_p) {
-                    for (auto& array_items = *maybe_array_items_p; auto& item_value : array_items) {
-                        if (auto next_item_p = item_value.to_object(); next_item_p) {
-                            frontier.push(next_item_p);
-                        }
-                    }
+                ++class_count;
+                class_bytes += item_bytes;
+                ++live_count;
+                live_bytes += item_bytes;
+            }
+
+            const std::chrono::duration<double> run_time = clock_type::now() - m_start_time;
+            const auto alloc_rate = (run_time.count() > 0.0) ? static_cast<double>(heap.get_allocated_bytes()) / run_time.count() : 0.0;
+
+            std::println(std::cerr, "GC Stats:\n\nmajor cycles: {}, reaped: {}\nminor collections: {}, reaped: {}, promoted: {}", m_stats.major_cycles, m_stats.major_reaped, m_stats.minor_collections, m_stats.minor_reaped, m_promote_count);
+            std::println(std::cerr, "pauses: {}, total: {}us, max: {}us", m_stats.pause_count, duration_cast<microseconds>(m_stats.total_pause).count(), duration_cast<microseconds>(m_stats.max_pause).count());
+            std::println(std::cerr, "phase times: roots {}us, mark {}us, sweep {}us, minor {}us", duration_cast<microseconds>(m_stats.root_time).count(), duration_cast<microseconds>(m_stats.mark_time).count(), duration_cast<microseconds>(m_stats.sweep_time).count(), duration_cast<microseconds>(m_stats.minor_time).count());
+            std::println(std::cerr, "allocated: {} objects, {} bytes ({:.0f} bytes/s)", heap.get_allocated_count(), heap.get_allocated_bytes(), alloc_rate);
+            std::println(std::cerr, "heap: {} live objects, {} bytes (counted {}, peak {}, threshold {})", live_count, live_bytes, heap.get_overhead(), m_stats.peak_bytes, m_threshold);
+            std::println(std::cerr, "slots: {} used of {} ({} free for reuse)\n", heap.get_used_extent(), heap.get_slot_capacity(), heap.get_free_slot_count());
+            std::println(std::cerr, "Heap Census:\n");
+
+            for (const auto& [class_name, class_census] : heap_census) {
+                std::println(std::cerr, "{:<12} count: {:<10} bytes: {}", class_name, class_census.count, class_census.bytes);
+            }
+        }
+
+        /// NOTE: Gives the count of objects reaped by the last or current cycle.
+        [[nodiscard]] auto get_reap_count() const noexcept -> int {
+            return m_reap_count;
+        }
+
+        /// NOTE: Gives the count of young objects reaped by the last nursery collection.
+        [[nodiscard]] auto get_minor_reap_count() const noexcept -> int {
+            return m_minor_reap_count;
+        }
+
+        /// NOTE: Gives the total count of young objects promoted by nursery collections.
+        [[nodiscard]] auto get_promote_count() const noexcept -> int {
+            return m_promote_count;
+        }
+
+        /// NOTE: Grays a white object, whether it's a root or a newly found reference. During nursery collections, this only marks unreached young objects.
+        void shade(ObjectBase<Value>* object_p) {
+            if (!object_p) {
+                return;
+            } else if (m_in_minor) {
+                if (object_p->has_gc_flag(GCHeaderFlag::young) && !object_p->has_gc_flag(GCHeaderFlag::nursery_live)) {
+                    object_p->set_gc_flag(GCHeaderFlag::nursery_live);
+                    m_gray.emplace_back(object_p);
                 }
 
-                for (auto& [prop_key, prop_v, prop_flags] : next_ptr->get_own_prop_pool()) {
-                    /// TODO: add prop_key reachability checks!
-                    if (auto neighbor_ptr = prop_v.to_object(); neighbor_ptr) {
-                        frontier.push(neighbor_ptr);
-                    }
+                return;
+            } else if (object_p->get_gc_epoch() == m_epoch) {
+                return;
+            }
+
+            object_p->set_gc_epoch(m_epoch);
+            m_gray.emplace_back(object_p);
+        }
+
+        void shade(Value value) {
+            shade(value.to_object());
+        }
+
+        /**
+         * @brief Call this on every object reference stored into a heap object. During marking, this keeps the tri-color invariant. Young references stored into old objects also get the holder remembered for nursery collections.
+         * @param holder_p The object being stored into, or `nullptr` if unknown e.g stores through property references. Unknown holders just make the stored object old (and remembered, as its own references may be young).
+         * @param stored_value The newly stored value.
+         */
+        void write_barrier(ObjectBase<Value>* holder_p, Value stored_value) {
+            auto stored_p = stored_value.to_object();
+
+            if (!stored_p) {
+                return;
+            } else if (m_phase == GCPhase::marking) {
+                shade(stored_p);
+            }
+
+            if (!stored_p->has_gc_flag(GCHeaderFlag::young)) {
+                return;
+            } else if (!holder_p) {
+                stored_p->clear_gc_flag(GCHeaderFlag::young);
+                remember(stored_p);
+            } else if (!holder_p->has_gc_flag(GCHeaderFlag::young)) {
+                remember(holder_p);
+            }
+        }
+
+        /// NOTE: Runs a nursery collection right away regardless of the nursery limit, e.g to reap an embedder call's garbage. It's skipped while a major cycle is running, which reclaims the nursery anyways.
+        template <typename RootMarker>
+        void collect_young(PolyPool<ObjectBase<Value>>& heap, InternTable& interns, RootMarker&& mark_roots) {
+            if (m_phase == GCPhase::idle && !heap.get_nursery().empty()) {
+                collect_nursery(heap, interns, mark_roots);
+            }
+        }
+
+        /**
+         * @brief Runs a bounded GC step, or the rest of a whole cycle in stop-the-world mode. Cycles begin once the heap overhead reaches the threshold.
+         * @param mark_roots Callable taking `GC&` which must `shade()` all roots. It's called at the start of marking and again upon any empty gray list.
+         */
+        template <typename RootMarker>
+        void operator()(PolyPool<ObjectBase<Value>>& heap, InternTable& interns, RootMarker&& mark_roots) {
+            const bool nursery_full = static_cast<int>(heap.get_nursery().size()) >= m_nursery_limit;
+
+            if (m_phase == GCPhase::idle) {
+                m_stats.peak_bytes = std::max(m_stats.peak_bytes, heap.get_overhead());
+
+                //? NOTE: Most calls have nothing to do, so they return before reading the clock.
+                if (!nursery_full && heap.get_overhead() < m_threshold) {
+                    return;
+                }
+            }
+
+            const auto pause_begin = clock_type::now();
+            auto segment_begin = pause_begin;
+
+            if (m_phase == GCPhase::idle) {
+                if (nursery_full) {
+                    collect_nursery(heap, interns, mark_roots);
+                    segment_begin = clock_type::now();
+                }
+
+                if (heap.get_overhead() < m_threshold) {
+                    record_pause(pause_begin, segment_begin);
+                    return;
                 }
+
+                begin_marking(heap);
+                scan_roots(mark_roots, segment_begin);
             }
 
-            // 3. Delete all object IDs that are "dead".
-            for (auto [next_object_p, life_info] : m_tracked) {
-                if (auto [target_id, target_mark] = life_info; target_mark == GCMark::dead) {
-                    if (heap.remove_item(target_id)) {
-                        reap_count++;
+            int work_left = (m_mode == GCMode::incremental) ? m_step_budget : std::numeric_limits<int>::max();
+
+            while (work_left > 0 && m_phase != GCPhase::idle) {
+                if (m_phase == GCPhase::marking) {
+                    if (!m_gray.empty()) {
+                        auto next_p = m_gray.back();
+                        m_gray.pop_back();
+
+                        blacken(next_p);
+                        --work_left;
+                        continue;
                     }
+
+                    //? NOTE: The mutator may have moved references onto the stack or frames since the last scan, so only a root rescan finding nothing new ends marking.
+                    scan_roots(mark_roots, segment_begin);
+
+                    if (m_gray.empty()) {
+                        begin_sweeping(heap, interns);
+                    }
+                } else if (m_sweep_pos < heap.get_used_extent()) {
+                    sweep_slot(heap, interns, m_sweep_pos);
+                    ++m_sweep_pos;
+                    --work_left;
+                } else {
+                    charge_phase(GCPhase::sweeping, segment_begin);
+                    end_sweeping(interns);
                 }
             }
 
-            // 4. Reset state except `m_overhead`.
-            m_tracked.clear();
+            if (m_phase != GCPhase::idle) {
+                charge_phase(m_phase, segment_begin);
+            }
 
-            std::println("GC: collected {} objects.", reap_count);
+            record_pause(pause_begin, segment_begin);
         }
     };
 }
@@ -0,0 +1,106 @@
+module;
+
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+
+export module runtime.interns;
+
+import runtime.value;
+
+namespace DerkJS {
+    /**
+     * @brief VM-wide table of canonical property key strings. Each distinct key text maps to exactly one heap string, so interned keys compare by pointer alone. Entries are weak references: the table never keeps a string alive, and the GC must call `forget()` on every string it reaps.
+     */
+    export class InternTable {
+    private:
+        /// NOTE: Strings already precompute their hashes via `StringBase::get_hash()`, so the table must not rehash the text again.
+        struct PrehashedKey {
+            [[nodiscard]] auto operator()(std::size_t key_hash) const noexcept -> std::size_t {
+                return key_hash;
+            }
+        };
+
+        struct InternEntry {
+            ObjectBase<Value>* object_p;
+            const StringBase* str_p;
+        };
+
+        std::unordered_multimap<std::size_t, InternEntry, PrehashedKey> m_entries;
+
+        /// NOTE: While the GC sweeps, only strings marked with this epoch are alive. Zero means no sweep is in progress.
+        uint32_t m_live_epoch;
+
+        [[nodiscard]] auto is_condemned(const ObjectBase<Value>* object_p) const noexcept -> bool {
+            return m_live_epoch != 0 && object_p->get_gc_epoch() != m_live_epoch;
+        }
+
+    public:
+        InternTable()
+        : m_entries {}, m_live_epoch {0} {}
+
+        [[nodiscard]] auto get_count() const noexcept -> int {
+            return m_entries.size();
+        }
+
+        /// NOTE: Gives the canonical string having the same text as `object_p`, which becomes canonical itself if its text is new. Non-strings yield `nullptr`.
+        [[nodiscard]] auto intern(ObjectBase<Value>* object_p) -> ObjectBase<Value>* {
+            const auto str_p = dynamic_cast<const StringBase*>(object_p);
+
+            if (!str_p) {
+                return nullptr;
+            }
+
+            const auto str_hash = str_p->get_hash();
+            const auto str_text = str_p->as_str_view();
+
+            for (auto [entry_it, entries_end] = m_entries.equal_range(str_hash); entry_it != entries_end; entry_it++) {
+                //? NOTE: Unreachable strings awaiting the sweep must not be handed out again.
+                if (const auto& [canonical_p, canonical_str_p] = entry_it->second; is_condemned(canonical_p)) {
+                    continue;
+                } else if (canonical_p == object_p || canonical_str_p->as_str_view() == str_text) {
+                    return canonical_p;
+                }
+            }
+
+            m_entries.emplace(str_hash, InternEntry {object_p, str_p});
+
+            return object_p;
+        }
+
+        /// NOTE: Replaces a string property key with its canonical string, marking it as interned for pointer-only comparisons. Key references are unwrapped, but other keys are left as-is.
+        void intern_key(Value& key) {
+            if (key.get_tag() == ValueTag::object && key.flag<AttrMask::interned>()) {
+                return;
+            }
+
+            if (auto canonical_p = intern(key.to_object()); canonical_p) {
+                key = Value {canonical_p, static_cast<uint8_t>(key.flags() | std::to_underlying(AttrMask::interned))};
+            }
+        }
+
+        void begin_sweep(uint32_t live_epoch) noexcept {
+            m_live_epoch = live_epoch;
+        }
+
+        void end_sweep() noexcept {
+            m_live_epoch = 0;
+        }
+
+        /// NOTE: Drops `object_p` from the table if it's a canonical string. Call this before the GC frees it!
+        void forget(ObjectBase<Value>* object_p) {
+            const auto str_p = dynamic_cast<const StringBase*>(object_p);
+
+            if (!str_p) {
+                return;
+            }
+
+            for (auto [entry_it, entries_end] = m_entries.equal_range(str_p->get_hash()); entry_it != entries_end; entry_it++) {
+                if (entry_it->second.object_p == object_p) {
+                    m_entries.erase(entry_it);
+                    return;
+                }
+            }
+        }
+    };
+}
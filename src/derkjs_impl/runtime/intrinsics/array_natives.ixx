@@ -1,19 +1,27 @@
 module;
 
+#include <cstdint>
 #include <utility>
 #include <algorithm>
+#include <optional>
+#include <numeric>
+#include <tuple>
 #include <memory>
 #include <string>
 #include <string_view>
-#include <sstream>
+#include <vector>
+#include <span>
 #include <iostream>
 #include <print>
 
 export module runtime.intrinsics.array_natives;
 
 import runtime.value;
+import runtime.strings;
 import runtime.arrays;
-import runtime.context;
+import runtime.bytecode;
+import runtime.callables;
+import runtime.op_handlers;
 
 namespace DerkJS::Runtime::Intrinsics {
     /// BEGIN Array.prototype impls:
@@ -82,8 +90,13 @@ namespace DerkJS::Runtime::Intrinsics {
             return false;
         }
 
+        array_this_p->items().reserve(array_this_p->items().size() + argc);
+
         for (int temp_item_offset = 0; temp_item_offset < argc; temp_item_offset++) {
-            array_this_p->items().emplace_back(ctx->stack.at(passed_rsbp + 1 + temp_item_offset));
+            const auto& pushed_item = ctx->stack.at(passed_rsbp + 1 + temp_item_offset);
+
+            ctx->gc.write_barrier(array_this_p, pushed_item);
+            array_this_p->items().emplace_back(pushed_item);
             array_length_p->increment();
         }
 
@@ -93,30 +106,57 @@ namespace DerkJS::Runtime::Intrinsics {
         return true;
     }
 
+    [[nodiscard]] auto is_number_item(const Value& item) noexcept -> bool {
+        const auto item_tag = item.get_tag();
+
+        return item_tag == ValueTag::num_i32 || item_tag == ValueTag::num_f64 || item_tag == ValueTag::num_nan;
+    }
+
+    /// NOTE: The numeric fast path of `join()`, which formats straight into one flat string in the same pass that checks the items. Gives false at the first non-number item, and then the caller joins by ropes instead.
+    [[nodiscard]] auto join_numeric_items(const std::vector<Value>& items, std::string_view delim, std::string& joined) -> bool {
+        joined.reserve(items.size() * (4 + delim.length()));
+
+        for (std::size_t item_pos = 0; item_pos < items.size(); item_pos++) {
+            if (!is_number_item(items[item_pos])) {
+                return false;
+            } else if (item_pos > 0) {
+                joined.append_range(delim);
+            }
+
+            joined.append_range(items[item_pos].to_string());
+        }
+
+        return true;
+    }
+
     /// SEE: ES5-15.4.4.5
+    /// NOTE: The result is a balanced rope over the items' text and one shared delimiter leaf, so string items aren't copied until the result is read. Numeric arrays are just formatted into one flat string.
     export auto native_array_join(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
-        std::ostringstream sout;
+        std::vector<RopePtr> pieces;
 
         const int passed_rsbp = ctx->rsbp;
         auto array_this_p = dynamic_cast<Array*>(
             ctx->stack.at(passed_rsbp - 1).to_object()
         );
 
-        if (!array_this_p->items().empty()) {
-            std::string delim = (argc == 1) ? ctx->stack.at(passed_rsbp + 1).to_string() : ",";
+        if (std::string joined; !array_this_p->items().empty() && is_number_item(array_this_p->items().front()) && join_numeric_items(array_this_p->items(), (argc == 1) ? ctx->stack.at(passed_rsbp + 1).to_string() : ",", joined)) {
+            return ctx->push_string(joined, passed_rsbp);
+        } else if (!array_this_p->items().empty()) {
+            auto delim = make_rope_leaf((argc == 1) ? ctx->stack.at(passed_rsbp + 1).to_string() : ",");
 
-            sout << array_this_p->items().front().to_string();
+            pieces.reserve(array_this_p->items().size() * 2 - 1);
+            pieces.push_back(rope_of(array_this_p->items().front()));
 
             for (int more_count = 1, self_len = array_this_p->items().size(); more_count < self_len; more_count++) {
-                sout << delim;
+                pieces.push_back(delim);
 
-                if (const auto& next_item = array_this_p->items().at(more_count); next_item.get_tag() != ValueTag::undefined && next_item.get_tag() != ValueTag::null) {
-                    sout << next_item.to_string();
+                if (auto& next_item = array_this_p->items().at(more_count); next_item.get_tag() != ValueTag::undefined && next_item.get_tag() != ValueTag::null) {
+                    pieces.push_back(rope_of(next_item));
                 }
             }
         }
 
-        return ctx->push_string(sout.str(), passed_rsbp);
+        return ctx->push_rope(concat_rope_range(pieces, 0, pieces.size()), passed_rsbp);
     }
 
     export auto native_array_concat(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
@@ -138,28 +178,31 @@ namespace DerkJS::Runtime::Intrinsics {
             }
         }
 
-        int array_this_len = array_this_p->items().size();
+        //? NOTE: Reserve for all incoming items once, then bulk append each sequence instead of storing items 1 by 1 via keys.
+        std::size_t incoming_count = 0;
 
         for (auto arg_pos = 0; arg_pos < argc; arg_pos++) {
-            if (auto& arg_value = ctx->stack.at(passed_rsbp + 1 + arg_pos); arg_value.get_tag() == ValueTag::object) {
-                if (auto arg_seq_items_p = arg_value.to_object()->get_seq_items(); arg_seq_items_p) {
-                    for (const auto& arg_items = *arg_seq_items_p; const auto& item_v : arg_items) {
-                        array_this_p->set_property_value(Value {array_this_len}, item_v);
-                        array_this_len++;
-                    }
-                } else {
-                    array_this_p->set_property_value(
-                        Value {array_this_len},
-                        Value {arg_value.to_object()}
-                    );
-                    array_this_len++;
-                }
+            if (auto arg_object_p = ctx->stack.at(passed_rsbp + 1 + arg_pos).to_object(); arg_object_p && arg_object_p->get_seq_items()) {
+                incoming_count += arg_object_p->get_seq_items()->size();
             } else {
-                array_this_p->set_property_value(
-                    Value {array_this_len},
-                    arg_value
-                );
-                array_this_len++;
+                incoming_count++;
+            }
+        }
+
+        array_this_p->items().reserve(array_this_p->items().size() + incoming_count);
+
+        for (auto arg_pos = 0; arg_pos < argc; arg_pos++) {
+            auto& arg_value = ctx->stack.at(passed_rsbp + 1 + arg_pos);
+            const Value arg_item = (arg_value.get_tag() == ValueTag::object) ? Value {arg_value.to_object()} : arg_value;
+            const auto arg_seq_items_p = (arg_value.get_tag() == ValueTag::object) ? arg_value.to_object()->get_seq_items() : nullptr;
+            const std::span<const Value> new_items = (arg_seq_items_p) ? std::span<const Value> {*arg_seq_items_p} : std::span<const Value> {&arg_item, 1};
+
+            for (const auto& item_v : new_items) {
+                ctx->gc.write_barrier(array_this_p, item_v);
+            }
+
+            if (!array_this_p->append_items(new_items)) {
+                break;
             }
         }
 
@@ -167,6 +210,431 @@ namespace DerkJS::Runtime::Intrinsics {
             array_this_p
         };
 
+        return true;
+    }
+    /// BEGIN iteration natives: these loop over `Array::items()` in C++ and only enter bytecode for callbacks, see `call_reentrant()`.
+
+    /// NOTE: Items may be removed by callbacks mid-loop, so reads past the current end just give `undefined`.
+    [[nodiscard]] auto item_at(const Array& array, int item_pos) -> Value {
+        if (const auto& items = array.items(); item_pos >= 0 && item_pos < static_cast<int>(items.size())) {
+            return items[item_pos];
+        }
+
+        return Value {JSUndefOpt {}};
+    }
+
+    [[nodiscard]] auto fail_array_native(ExternVMCtx* ctx, std::string_view native_name, std::string_view reason) -> bool {
+        std::println(std::cerr, "{}: {}", native_name, reason);
+
+        if (ctx->status == VMErrcode::pending) {
+            ctx->status = VMErrcode::bad_operation;
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] auto make_result_array(ExternVMCtx* ctx) -> Array* {
+        return dynamic_cast<Array*>(ctx->heap.add_item(ctx->heap.get_next_id(), std::make_unique<Array>(
+            ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::array)),
+            Value {ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key))},
+            Value {0}
+        )));
+    }
+
+    /// NOTE: Calls `callbackFn(item, index, array)` on `thisArg`, like the former polyfills did via `Function.prototype.call`.
+    [[nodiscard]] auto call_item_callback(ExternVMCtx* ctx, ObjectBase<Value>* callback_p, const Value& this_arg, Array* array_p, int item_pos) -> std::optional<Value> {
+        const Value callback_args[] {item_at(*array_p, item_pos), Value {item_pos}, Value {array_p}};
+
+        return call_reentrant(*ctx, callback_p, this_arg, callback_args);
+    }
+
+    /// NOTE: Covers `forEach`, `map`, `filter`, and `some`, which share their argument handling & loop. Results of `map` and `filter` are rooted on the stack above RSP while callbacks run.
+    enum class ItemLoopKind : uint8_t {
+        for_each,
+        map,
+        filter,
+        some
+    };
+
+    template <ItemLoopKind Kind>
+    [[nodiscard]] auto run_item_loop(ExternVMCtx* ctx, int argc, std::string_view native_name) -> bool {
+        const int passed_rsbp = ctx->rsbp;
+        auto array_this_p = dynamic_cast<Array*>(ctx->stack.at(passed_rsbp - 1).to_object());
+        auto callback_p = (argc >= 1) ? ctx->stack.at(passed_rsbp + 1).to_object() : nullptr;
+        const Value this_arg = (argc >= 2) ? ctx->stack.at(passed_rsbp + 2).deep_clone() : Value {JSUndefOpt {}};
+        const int passed_rsp = ctx->rsp;
+        Array* result_p = nullptr;
+
+        if (!array_this_p || !callback_p) {
+            return fail_array_native(ctx, native_name, "Expected an Array this and a callback function.");
+        }
+
+        if constexpr (Kind == ItemLoopKind::map || Kind == ItemLoopKind::filter) {
+            if (result_p = make_result_array(ctx); !result_p) {
+                ctx->status = VMErrcode::bad_heap_alloc;
+                return false;
+            }
+
+            ctx->stack.at(++ctx->rsp) = Value {result_p};
+        }
+
+        for (int item_pos = 0, item_end = array_this_p->items().size(); item_pos < item_end; item_pos++) {
+            const auto item = item_at(*array_this_p, item_pos);
+
+            //? NOTE: Like the old polyfills, all but `forEach` skip undefined items (holes).
+            if (Kind != ItemLoopKind::for_each && item.get_tag() == ValueTag::undefined) {
+                continue;
+            }
+
+            const auto callback_result = call_item_callback(ctx, callback_p, this_arg, array_this_p, item_pos);
+
+            if (!callback_result) {
+                //? NOTE: Pop the result array's slot too, or the caller resumes with RSP 1 too high.
+                ctx->rsp = passed_rsp;
+
+                return fail_array_native(ctx, native_name, "Failed to invoke the callback.");
+            }
+
+            if constexpr (Kind == ItemLoopKind::map) {
+                ctx->gc.write_barrier(result_p, *callback_result);
+                std::ignore = result_p->append_items({&*callback_result, 1});
+            } else if constexpr (Kind == ItemLoopKind::filter) {
+                if (!callback_result->is_falsy()) {
+                    ctx->gc.write_barrier(result_p, item);
+                    std::ignore = result_p->append_items({&item, 1});
+                }
+            } else if constexpr (Kind == ItemLoopKind::some) {
+                if (!callback_result->is_falsy()) {
+                    ctx->stack.at(passed_rsbp - 1) = Value {true};
+                    return true;
+                }
+            }
+        }
+
+        if constexpr (Kind == ItemLoopKind::map || Kind == ItemLoopKind::filter) {
+            ctx->rsp = passed_rsp;
+            ctx->stack.at(passed_rsbp - 1) = Value {result_p};
+        } else if constexpr (Kind == ItemLoopKind::some) {
+            ctx->stack.at(passed_rsbp - 1) = Value {false};
+        } else {
+            ctx->stack.at(passed_rsbp - 1) = Value {JSUndefOpt {}};
+        }
+
+        return true;
+    }
+
+    /// SEE: ES5-15.4.4.18
+    export auto native_array_for_each(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        return run_item_loop<ItemLoopKind::for_each>(ctx, argc, "Array.prototype.forEach");
+    }
+
+    /// SEE: ES5-15.4.4.19
+    export auto native_array_map(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        return run_item_loop<ItemLoopKind::map>(ctx, argc, "Array.prototype.map");
+    }
+
+    /// SEE: ES5-15.4.4.20
+    export auto native_array_filter(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        return run_item_loop<ItemLoopKind::filter>(ctx, argc, "Array.prototype.filter");
+    }
+
+    /// SEE: ES5-15.4.4.17
+    export auto native_array_some(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        return run_item_loop<ItemLoopKind::some>(ctx, argc, "Array.prototype.some");
+    }
+
+    /// SEE: ES5-15.4.4.21
+    export auto native_array_reduce(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        const int passed_rsbp = ctx->rsbp;
+        auto array_this_p = dynamic_cast<Array*>(ctx->stack.at(passed_rsbp - 1).to_object());
+        auto callback_p = (argc >= 1) ? ctx->stack.at(passed_rsbp + 1).to_object() : nullptr;
+        int item_pos = 0;
+
+        if (!array_this_p || !callback_p) {
+            return fail_array_native(ctx, "Array.prototype.reduce", "Expected an Array this and a callback function.");
+        }
+
+        //? NOTE: The accumulator lives in a stack slot above RSP, so the GC sees any object it holds between callbacks. Every return pops it back to `passed_rsp`.
+        const int passed_rsp = ctx->rsp;
+        const int acc_pos = ++ctx->rsp;
+
+        if (argc >= 2) {
+            ctx->stack.at(acc_pos) = ctx->stack.at(passed_rsbp + 2).deep_clone();
+        } else if (!array_this_p->items().empty()) {
+            ctx->stack.at(acc_pos) = array_this_p->items().front();
+            item_pos = 1;
+        } else {
+            ctx->rsp = passed_rsp;
+
+            return fail_array_native(ctx, "Array.prototype.reduce", "Cannot reduce an empty array without an initial value.");
+        }
+
+        for (const int item_end = array_this_p->items().size(); item_pos < item_end; item_pos++) {
+            const Value callback_args[] {ctx->stack.at(acc_pos), item_at(*array_this_p, item_pos), Value {item_pos}, Value {array_this_p}};
+
+            if (auto next_acc = call_reentrant(*ctx, callback_p, Value {JSUndefOpt {}}, callback_args); next_acc) {
+                ctx->stack.at(acc_pos) = *next_acc;
+            } else {
+                ctx->rsp = passed_rsp;
+
+                return fail_array_native(ctx, "Array.prototype.reduce", "Failed to invoke the callback.");
+            }
+        }
+
+        ctx->stack.at(passed_rsbp - 1) = ctx->stack.at(acc_pos);
+        ctx->rsp = passed_rsp;
+
+        return true;
+    }
+
+    /// SEE: ES5-15.4.4.14
+    export auto native_array_index_of(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        const int passed_rsbp = ctx->rsbp;
+        auto array_this_p = dynamic_cast<Array*>(ctx->stack.at(passed_rsbp - 1).to_object());
+
+        if (!array_this_p) {
+            return fail_array_native(ctx, "Array.prototype.indexOf", "Expected an Array this.");
+        }
+
+        const auto& items = array_this_p->items();
+        const int items_n = items.size();
+        const Value target = (argc >= 1) ? ctx->stack.at(passed_rsbp + 1).deep_clone() : Value {JSUndefOpt {}};
+        const int from_index = (argc >= 2) ? ctx->stack.at(passed_rsbp + 2).to_num_i32().value_or(0) : 0;
+        int result = -1;
+
+        for (int item_pos = (from_index < 0) ? std::max(items_n + from_index, 0) : from_index; item_pos < items_n; item_pos++) {
+            if (items[item_pos] == target) {
+                result = item_pos;
+                break;
+            }
+        }
+
+        ctx->stack.at(passed_rsbp - 1) = Value {result};
+
+        return true;
+    }
+
+    /// SEE: ES5-15.4.4.9
+    export auto native_array_shift(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, [[maybe_unused]] int argc) -> bool {
+        const int passed_rsbp = ctx->rsbp;
+        auto array_this_p = dynamic_cast<Array*>(ctx->stack.at(passed_rsbp - 1).to_object());
+
+        if (!array_this_p) {
+            return fail_array_native(ctx, "Array.prototype.shift", "Expected an Array this.");
+        } else if (auto& items = array_this_p->items(); items.empty()) {
+            ctx->stack.at(passed_rsbp - 1) = Value {JSUndefOpt {}};
+        } else {
+            const auto first_item = items.front().deep_clone();
+
+            items.erase(items.begin());
+            array_this_p->sync_length();
+            ctx->stack.at(passed_rsbp - 1) = first_item;
+        }
+
+        return true;
+    }
+
+    /// SEE: ES5-15.4.4.13
+    export auto native_array_unshift(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        const int passed_rsbp = ctx->rsbp;
+        auto array_this_p = dynamic_cast<Array*>(ctx->stack.at(passed_rsbp - 1).to_object());
+
+        if (!array_this_p) {
+            return fail_array_native(ctx, "Array.prototype.unshift", "Expected an Array this.");
+        }
+
+        std::span<Value> new_items {ctx->stack.begin() + passed_rsbp + 1, static_cast<std::size_t>(argc)};
+
+        for (auto& item_v : new_items) {
+            item_v = item_v.deep_clone();
+            item_v.set_flag<AttrMask::property>();
+            ctx->gc.write_barrier(array_this_p, item_v);
+        }
+
+        array_this_p->items().insert_range(array_this_p->items().begin(), new_items);
+        array_this_p->sync_length();
+        ctx->stack.at(passed_rsbp - 1) = Value {static_cast<int>(array_this_p->items().size())};
+
+        return true;
+    }
+
+    /// SEE: ES5-15.4.4.12
+    export auto native_array_splice(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        const int passed_rsbp = ctx->rsbp;
+        auto array_this_p = dynamic_cast<Array*>(ctx->stack.at(passed_rsbp - 1).to_object());
+
+        if (!array_this_p) {
+            return fail_array_native(ctx, "Array.prototype.splice", "Expected an Array this.");
+        }
+
+        auto& items = array_this_p->items();
+        const int items_n = items.size();
+        const int relative_start = (argc >= 1) ? ctx->stack.at(passed_rsbp + 1).to_num_i32().value_or(0) : 0;
+        const int actual_start = (relative_start < 0) ? std::max(items_n + relative_start, 0) : std::min(relative_start, items_n);
+        const int delete_count = (argc >= 2)
+            ? std::clamp(ctx->stack.at(passed_rsbp + 2).to_num_i32().value_or(0), 0, items_n - actual_start)
+            : ((argc == 1) ? items_n - actual_start : 0);
+        auto removed_p = make_result_array(ctx);
+
+        if (!removed_p) {
+            ctx->status = VMErrcode::bad_heap_alloc;
+            return false;
+        }
+
+        std::ignore = removed_p->append_items(std::span<const Value> {items.begin() + actual_start, static_cast<std::size_t>(delete_count)});
+        items.erase(items.begin() + actual_start, items.begin() + actual_start + delete_count);
+
+        if (argc > 2) {
+            std::span<Value> new_items {ctx->stack.begin() + passed_rsbp + 3, static_cast<std::size_t>(argc - 2)};
+
+            for (auto& item_v : new_items) {
+                item_v = item_v.deep_clone();
+                item_v.set_flag<AttrMask::property>();
+                ctx->gc.write_barrier(array_this_p, item_v);
+            }
+
+            items.insert_range(items.begin() + actual_start, new_items);
+        }
+
+        array_this_p->sync_length();
+        ctx->stack.at(passed_rsbp - 1) = Value {removed_p};
+
+        return true;
+    }
+
+    /// NOTE: Detects comparators with bytecode that's exactly `return a - b;` (`true`) or `return b - a;` (`false`) over the 2 parameters (locals 1 & 2). Anything else, including ones with captured parameters, needs real calls.
+    [[nodiscard]] auto numeric_comparator_order(ObjectBase<Value>* comparator_p) -> std::optional<bool> {
+        auto lambda_p = dynamic_cast<Lambda*>(comparator_p);
+
+        if (!lambda_p) {
+            return {};
+        }
+
+        auto code = lambda_p->view_code();
+
+        while (!code.empty() && code.front().op == Opcode::djs_nop) {
+            code = code.subspan(1);
+        }
+
+        if (code.size() < 4 || code[0].op != Opcode::djs_dup_local || code[1].op != Opcode::djs_dup_local || code[3].op != Opcode::djs_ret || code[3].args[0] != 0) {
+            return {};
+        } else if (const auto sub_op = code[2].op; sub_op != Opcode::djs_sub && sub_op != Opcode::djs_sub_i32 && sub_op != Opcode::djs_sub_f64) {
+            return {};
+        }
+
+        //? NOTE: Binary operators push the RHS first, so `a - b` is `dup_local 2, dup_local 1, sub`.
+        if (code[0].args[0] == 2 && code[1].args[0] == 1) {
+            return true;
+        } else if (code[0].args[0] == 1 && code[1].args[0] == 2) {
+            return false;
+        }
+
+        return {};
+    }
+
+    /// NOTE: Stable bottom-up merge sort of item positions. Unlike `std::stable_sort`, this stays in bounds for inconsistent JS comparators, and it can stop once a comparator call fails.
+    template <typename LessFn>
+    [[nodiscard]] auto merge_sort_positions(std::vector<int>& order, LessFn&& is_less) -> bool {
+        std::vector<int> merged (order.size());
+        const std::size_t order_n = order.size();
+
+        for (std::size_t run_width = 1; run_width < order_n; run_width *= 2) {
+            for (std::size_t left_pos = 0; left_pos < order_n; left_pos += 2 * run_width) {
+                const std::size_t middle_pos = std::min(left_pos + run_width, order_n);
+                const std::size_t right_end = std::min(left_pos + 2 * run_width, order_n);
+                std::size_t lhs_pos = left_pos;
+                std::size_t rhs_pos = middle_pos;
+                std::size_t out_pos = left_pos;
+
+                while (lhs_pos < middle_pos && rhs_pos < right_end) {
+                    const auto rhs_first = is_less(order[rhs_pos], order[lhs_pos]);
+
+                    if (!rhs_first) {
+                        return false;
+                    }
+
+                    merged[out_pos++] = (*rhs_first) ? order[rhs_pos++] : order[lhs_pos++];
+                }
+
+                while (lhs_pos < middle_pos) {
+                    merged[out_pos++] = order[lhs_pos++];
+                }
+
+                while (rhs_pos < right_end) {
+                    merged[out_pos++] = order[rhs_pos++];
+                }
+            }
+
+            order.swap(merged);
+        }
+
+        return true;
+    }
+
+    /// SEE: ES5-15.4.4.11
+    /// NOTE: Sorts item positions first, then permutes the items once. Default sorting compares item text with `undefined` last, while `a - b` / `b - a` comparators over numeric arrays skip calling back into bytecode.
+    export auto native_array_sort(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        const int passed_rsbp = ctx->rsbp;
+        auto array_this_p = dynamic_cast<Array*>(ctx->stack.at(passed_rsbp - 1).to_object());
+        auto comparator_p = (argc >= 1) ? ctx->stack.at(passed_rsbp + 1).to_object() : nullptr;
+
+        if (!array_this_p) {
+            return fail_array_native(ctx, "Array.prototype.sort", "Expected an Array this.");
+        } else if (argc >= 1 && !comparator_p && ctx->stack.at(passed_rsbp + 1).get_tag() != ValueTag::undefined) {
+            return fail_array_native(ctx, "Array.prototype.sort", "The comparator must be a function.");
+        }
+
+        const auto& items = array_this_p->items();
+        std::vector<int> order (items.size());
+        std::ranges::iota(order, 0);
+
+        if (!comparator_p) {
+            std::vector<std::string> item_texts;
+            item_texts.reserve(items.size());
+
+            for (const auto& item : items) {
+                item_texts.emplace_back(item.to_string());
+            }
+
+            std::ranges::stable_sort(order, [&items, &item_texts](int lhs, int rhs) {
+                const bool lhs_undefined = items[lhs].get_tag() == ValueTag::undefined;
+                const bool rhs_undefined = items[rhs].get_tag() == ValueTag::undefined;
+
+                if (lhs_undefined || rhs_undefined) {
+                    return !lhs_undefined && rhs_undefined;
+                }
+
+                return item_texts[lhs] < item_texts[rhs];
+            });
+        } else if (const auto numeric_order = numeric_comparator_order(comparator_p); numeric_order && std::ranges::all_of(items, [](const Value& item) noexcept { return item.get_tag() == ValueTag::num_i32 || item.get_tag() == ValueTag::num_f64; })) {
+            std::ranges::stable_sort(order, [&items, ascending = *numeric_order](int lhs, int rhs) {
+                const double lhs_num = items[lhs].to_num_f64().value_or(0.0);
+                const double rhs_num = items[rhs].to_num_f64().value_or(0.0);
+
+                return (ascending) ? lhs_num < rhs_num : rhs_num < lhs_num;
+            });
+        } else if (!merge_sort_positions(order, [ctx, comparator_p, array_this_p](int lhs, int rhs) -> std::optional<bool> {
+            const Value comparator_args[] {item_at(*array_this_p, lhs), item_at(*array_this_p, rhs)};
+
+            if (auto comparison = call_reentrant(*ctx, comparator_p, Value {JSUndefOpt {}}, comparator_args); comparison) {
+                return comparison->to_num_f64().value_or(0.0) < 0.0;
+            }
+
+            return {};
+        })) {
+            return fail_array_native(ctx, "Array.prototype.sort", "Failed to invoke the comparator.");
+        }
+
+        std::vector<Value> sorted_items;
+        sorted_items.reserve(order.size());
+
+        for (const int item_pos : order) {
+            sorted_items.emplace_back(item_at(*array_this_p, item_pos));
+        }
+
+        array_this_p->items() = std::move(sorted_items);
+        array_this_p->sync_length();
+
         return true;
     }
 }
\ No newline at end of file
@@ -59,21 +59,29 @@ namespace DerkJS::Runtime::Intrinsics {
         const int passed_rsbp = ctx->rsbp;
         const char passed_terminator = static_cast<char>(ctx->stack.at(passed_rsbp + 2).to_num_i32().value_or(32) & 0xff);
 
-        std::print("{}{}", ctx->stack.at(passed_rsbp + 1).to_string(), passed_terminator);
+        ctx->console.write(ctx->stack.at(passed_rsbp + 1).to_string());
+        ctx->console.put(passed_terminator);
         ctx->stack.at(passed_rsbp - 1) = Value {JSUndefOpt {}};
 
         return true;
     }
 
+    export auto native_flush(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        ctx->console.flush();
+        ctx->stack.at(ctx->rsbp - 1) = Value {JSUndefOpt {}};
+
+        return true;
+    }
+
     export auto native_read_line(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
         /// NOTE: Show user the passed-in prompt string: It MUST be the 1st argument on the stack.
         const auto passed_rsbp = ctx->rsbp;
         const auto& prompt_value = ctx->stack.at(passed_rsbp + 1);
 
-        std::print("{}", prompt_value.to_string());
+        ctx->console.write(prompt_value.to_string());
 
         std::string temp_line;
-        std::getline(std::cin, temp_line);
+        [[maybe_unused]] const auto got_line = ctx->console.read_line(temp_line);
 
         ObjectBase<Value>* line_str_p = ctx->heap.add_item(
             ctx->heap.get_next_id(),
@@ -94,6 +102,57 @@ namespace DerkJS::Runtime::Intrinsics {
         }
     }
 
+    /// NOTE: Prints the GC's stats & heap census to stderr right away.
+    export auto native_dump_gc_stats(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        ctx->console.flush();
+        ctx->gc.print_report(ctx->heap);
+        ctx->stack.at(ctx->rsbp - 1) = Value {JSUndefOpt {}};
+
+        return true;
+    }
+
+    //// BEGIN job queue impls:
+
+    [[nodiscard]] auto job_callback_arg(ExternVMCtx* ctx, int argc) -> ObjectBase<Value>* {
+        if (auto callback_p = (argc >= 1) ? ctx->stack.at(ctx->rsbp + 1).to_object() : nullptr; callback_p && callback_p->get_class_name() == "function") {
+            return callback_p;
+        }
+
+        return nullptr;
+    }
+
+    export auto native_queue_microtask(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        const auto passed_rsbp = ctx->rsbp;
+        auto callback_p = job_callback_arg(ctx, argc);
+
+        if (!callback_p) {
+            std::println(std::cerr, "queueMicrotask: Expected a callback function.");
+            return false;
+        }
+
+        ctx->enqueue_microtask(callback_p);
+        ctx->stack.at(passed_rsbp - 1) = Value {JSUndefOpt {}};
+
+        return true;
+    }
+
+    export auto native_set_timeout(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
+        const auto passed_rsbp = ctx->rsbp;
+        auto callback_p = job_callback_arg(ctx, argc);
+        const double delay_ms = (argc >= 2) ? ctx->stack.at(passed_rsbp + 2).to_num_f64().value_or(0.0) : 0.0;
+
+        if (!callback_p) {
+            std::println(std::cerr, "setTimeout: Expected a callback function.");
+            return false;
+        }
+
+        /// NOTE: The timer's order doubles as its ID, though there's no `clearTimeout()` yet.
+        ctx->stack.at(passed_rsbp - 1) = Value {static_cast<int>(ctx->next_timer_order)};
+        ctx->enqueue_timer(callback_p, delay_ms);
+
+        return true;
+    }
+
     //// BEGIN time impls:
 
     export auto clock_time_now(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
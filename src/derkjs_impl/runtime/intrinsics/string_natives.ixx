@@ -15,6 +15,24 @@ import runtime.strings;
 import runtime.context;
 
 namespace DerkJS::Runtime::Intrinsics {
+    /// NOTE: Puts a new string viewing part of `str_this_p`'s text as the native call's result. The range must be within that string.
+    [[nodiscard]] auto push_str_slice(ExternVMCtx* ctx, DynamicString* str_this_p, int offset, int length, int passed_rsbp) -> bool {
+        if (auto slice_p = ctx->heap.add_item(
+            ctx->heap.get_next_id(),
+            std::make_unique<DynamicString>(
+                ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::str)),
+                ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key)),
+                str_this_p->share_slice(offset, length)
+            )
+        )) {
+            ctx->stack.at(passed_rsbp - 1) = Value {slice_p};
+            return true;
+        }
+
+        ctx->status = VMErrcode::bad_heap_alloc;
+        return false;
+    }
+
     /// NOTE: See ES5 - 15.5.2.1
     export auto native_str_ctor(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
         const int passed_rsbp = ctx->rsbp;
@@ -52,7 +70,7 @@ namespace DerkJS::Runtime::Intrinsics {
     // ES5 15.5.4.15 - Create a substring with start & end indices of an original string.
     export auto native_str_substring(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
         const int passed_rsbp = ctx->rsbp;
-        const auto str_this_p = dynamic_cast<const StringBase*>(
+        const auto str_this_p = dynamic_cast<DynamicString*>(
             ctx->stack.at(passed_rsbp - 1).to_object()
         );
 
@@ -76,26 +94,13 @@ namespace DerkJS::Runtime::Intrinsics {
         const int from_index = std::min(final_start, final_end);
         const int to_index = std::max(final_start, final_end);
 
-        if (auto substring_p = ctx->heap.add_item(
-            ctx->heap.get_next_id(),
-            std::make_unique<DynamicString>(
-                ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::str)),
-                ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key)),
-                std::string_view {str_this_p->as_str_view().substr(from_index, to_index - from_index)}
-            )
-        )) {
-            ctx->stack.at(passed_rsbp - 1) = Value {substring_p};
-            return true;
-        } else {
-            ctx->status = VMErrcode::bad_heap_alloc;
-            return false;
-        }
+        return push_str_slice(ctx, str_this_p, from_index, to_index - from_index, passed_rsbp);
     }
 
     // ES5 - 15.5.4.20: remove fringe spaces.
     export auto native_str_trim(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
         const int passed_rsbp = ctx->rsbp;
-        const auto str_this_p = dynamic_cast<const StringBase*>(
+        const auto str_this_p = dynamic_cast<DynamicString*>(
             ctx->stack.at(passed_rsbp - 1).to_object()
         );
 
@@ -122,52 +127,27 @@ namespace DerkJS::Runtime::Intrinsics {
             }
         }
 
-        std::string trimmed_source;
-
-        if (first_non_space_pos <= last_non_space_pos) {
-            trimmed_source.append_range(old_str_view.substr(first_non_space_pos, last_non_space_pos - first_non_space_pos + 1));
-        }
-
-        if (auto trimmed_string_p = ctx->heap.add_item(ctx->heap.get_next_id(), std::make_unique<DynamicString>(
-            ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::str)),
-            ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key)),
-            std::move(trimmed_source)
-        )); trimmed_string_p) {
-            ctx->stack.at(passed_rsbp - 1) = Value {trimmed_string_p};
-            return true;
-        }
+        const int trimmed_length = (first_non_space_pos < old_str_length) ? last_non_space_pos - first_non_space_pos + 1 : 0;
 
-        ctx->status = VMErrcode::bad_heap_alloc;
-        return false;
+        return push_str_slice(ctx, str_this_p, first_non_space_pos, trimmed_length, passed_rsbp);
     }
 
     export auto native_str_substr(ExternVMCtx* ctx, [[maybe_unused]] PropPool<Value, Value>* props, int argc) -> bool {
         const int passed_rsbp = ctx->rsbp;
-        const auto str_this_p = dynamic_cast<const StringBase*>(
+        const auto str_this_p = dynamic_cast<DynamicString*>(
             ctx->stack.at(passed_rsbp - 1).to_object()
         );
-        const int substr_begin = ctx->stack.at(passed_rsbp + 1).to_num_i32().value_or(0);
-        const int substr_len = ctx->stack.at(passed_rsbp + 2).to_num_i32().value_or(0);
 
-        std::string temp_substr;
-        temp_substr.append_range(
-            str_this_p->as_str_view().substr(substr_begin, substr_len)
-        );
+        /// NOTE: clamp the range into the string, like `std::string_view::substr` would for the length.
+        const int old_length = str_this_p->get_length();
+        const int substr_begin = std::clamp(ctx->stack.at(passed_rsbp + 1).to_num_i32().value_or(0), 0, old_length);
+        const int substr_len = std::clamp(ctx->stack.at(passed_rsbp + 2).to_num_i32().value_or(0), 0, old_length - substr_begin);
 
-        if (auto created_str_p = ctx->heap.add_item(
-            ctx->heap.get_next_id(),
-            DynamicString {
-                ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::str)),
-                Value {ctx->builtins.at(static_cast<unsigned int>(BuiltInObjects::extra_length_key))},
-                temp_substr
-            }); created_str_p) {
-            ctx->stack.at(passed_rsbp - 1) = Value {created_str_p};
-            return true;
+        if (!push_str_slice(ctx, str_this_p, substr_begin, substr_len, passed_rsbp)) {
+            std::println(std::cerr, "Failed to allocate JS sub-string on the heap.");
+            return false;
         }
 
-        ctx->status = VMErrcode::bad_heap_alloc;
-        std::println(std::cerr, "Failed to allocate JS sub-string on the heap.");
-    
-        return false;
+        return true;
     }
 }
\ No newline at end of file
@@ -38,6 +38,10 @@ namespace DerkJS {
             return this;
         }
 
+        [[nodiscard]] auto get_footprint() const noexcept -> std::size_t override {
+            return sizeof(NumberBox) + m_properties.capacity() * sizeof(PropEntry<Value, Value>);
+        }
+
         [[nodiscard]] auto get_class_name() const noexcept -> std::string override {
             return "Number";
         }
@@ -70,7 +74,7 @@ namespace DerkJS {
             if (key.is_prototype_key()) {
                 return PropertyDescriptor<Value> {key, &m_prototype, this};
             } else if (auto property_entry_it = std::find_if(m_properties.begin(), m_properties.end(), [&key](const auto& prop) -> bool {
-                return prop.key == key || prop.key.compare_as_object(key);
+                return prop.key.is_same_key(key);
             }); property_entry_it != m_properties.end()) {
                 return PropertyDescriptor<Value> {key, &property_entry_it->item, this};
             } else if ((m_flags & std::to_underlying(AttrMask::writable)) && allow_filler) {
@@ -9,25 +9,59 @@ module;
 export module runtime.object;
 
 import runtime.value;
+import runtime.slabs;
 
 namespace DerkJS {
     export class Object : public ObjectBase<Value> {
     private:
         PropPool<Value, Value> m_own_properties;
         Value m_prototype;
+        const PropShape* m_shape;
+        PropIndex m_prop_index;
         uint8_t m_flags;
 
     public:
+        /// NOTE: Instances are placed into this type's slab arena, see `./src/derkjs_impl/runtime/slabs.ixx`.
+        [[nodiscard]] static auto operator new(std::size_t size) -> void* {
+            return slab_allocate<Object>(size);
+        }
+
+        static void operator delete(void* ptr, std::size_t size) noexcept {
+            slab_deallocate<Object>(ptr, size);
+        }
+
         /// NOTE: Creates mutable instances of anonymous objects. Pass the `flag_prototype_v | flag_extensible_v` if needed for Foo.prototype!
         Object(ObjectBase<Value>* proto_p, uint8_t flags = std::to_underlying(AttrMask::defaults))
-        : m_own_properties {}, m_prototype {proto_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::configurable)}, m_flags {flags} {
+        : m_own_properties {}, m_prototype {proto_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::configurable)}, m_shape {PropShape::root()}, m_prop_index {}, m_flags {flags} {
             m_prototype.update_flags(m_flags);
         }
 
+        [[nodiscard]] auto get_shape() const noexcept -> const PropShape* override {
+            return m_shape;
+        }
+
+        [[nodiscard]] auto append_shaped_property(const Value& key, const Value& value, const PropShape* next_shape_p) -> Value* override {
+            if ((m_flags & std::to_underlying(AttrMask::writable)) == 0) {
+                return nullptr;
+            }
+
+            auto value_copy = value;
+            value_copy.set_flag<AttrMask::property>();
+
+            auto& new_entry = m_own_properties.emplace_back(key, value_copy, nullptr);
+            m_shape = (index_last_prop(m_own_properties, m_prop_index)) ? nullptr : next_shape_p;
+
+            return &new_entry.item;
+        }
+
         [[nodiscard]] auto get_unique_addr() noexcept -> void* override {
             return this;
         }
 
+        [[nodiscard]] auto get_footprint() const noexcept -> std::size_t override {
+            return sizeof(Object) + m_own_properties.capacity() * sizeof(PropEntry<Value, Value>);
+        }
+
         [[nodiscard]] auto get_class_name() const noexcept -> std::string override {
             return "object";
         }
@@ -59,23 +93,20 @@ namespace DerkJS {
         [[nodiscard]] auto get_property_value(const Value& key, bool allow_filler) -> PropertyDescriptor<Value> override {
             if (key.is_prototype_key()) {
                 return PropertyDescriptor<Value> {key, &m_prototype, this};
-            } else if (auto property_entry_it = std::find_if(m_own_properties.begin(), m_own_properties.end(), [&key](const auto& prop) -> bool {
-                return prop.key == key || prop.key.compare_as_object(key);
-            }); property_entry_it != m_own_properties.end()) {
-                return PropertyDescriptor<Value> {key, &property_entry_it->item, this};
+            } else if (auto property_entry_p = find_own_prop(m_own_properties, m_prop_index, key); property_entry_p) {
+                return PropertyDescriptor<Value> {key, &property_entry_p->item, this};
             } else if ((m_flags & std::to_underlying(AttrMask::writable)) && allow_filler) {
-                return PropertyDescriptor<Value> {
+                auto& filler_entry = m_own_properties.emplace_back(
                     key,
-                    &m_own_properties.emplace_back(
-                        key,
-                        Value {
-                            JSUndefOpt {},
-                            std::to_underlying(AttrMask::writable) | std::to_underlying(AttrMask::property)
-                        },
-                        nullptr
-                    ).item,
-                    this
-                };
+                    Value {
+                        JSUndefOpt {},
+                        std::to_underlying(AttrMask::writable) | std::to_underlying(AttrMask::property)
+                    },
+                    nullptr
+                );
+                m_shape = (index_last_prop(m_own_properties, m_prop_index)) ? nullptr : PropShape::next_of(m_shape, shape_key_text(key));
+
+                return PropertyDescriptor<Value> {key, &filler_entry.item, this};
             } else if (auto prototype_p = m_prototype.to_object(); prototype_p) {
                 return prototype_p->get_property_value(key, allow_filler);
             }
@@ -123,6 +154,8 @@ namespace DerkJS {
             auto self_clone = new Object {m_prototype.to_object()};
 
             self_clone->get_own_prop_pool() = m_own_properties;
+            self_clone->m_shape = m_shape;
+            self_clone->m_prop_index = m_prop_index;
 
             return self_clone;
         }
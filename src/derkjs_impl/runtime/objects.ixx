@@ -3,7 +3,9 @@ module;
 #include <cstdint>
 #include <type_traits>
 #include <utility>
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -48,6 +50,7 @@ export namespace DerkJS {
         enumerable = 0x04,
         accessor = 0x08,
         property = 0x10,
+        interned = 0x20, // only on property keys that point to a canonical string from the VM's `InternTable`
         frozen_property = frozen | property,
         defaults = writable | configurable
     };
@@ -184,16 +187,208 @@ export namespace DerkJS {
         last
     };
 
+    /**
+     * @brief Open-addressing hash index over a `PropPool`'s string-keyed slots for "dictionary mode" objects. The pool vector still owns the entries in insertion order, so enumeration is unchanged- This only maps key hashes to slot indices. Small objects never build one.
+     */
+    class PropIndex {
+    public:
+        /// NOTE: Objects switch into dictionary mode once their own property count reaches this.
+        static constexpr int dictionary_threshold = 32;
+
+    private:
+        struct Bucket {
+            std::size_t hash;
+            int slot; // -1 for empty buckets
+        };
+
+        std::vector<Bucket> m_buckets;
+        int m_count;
+
+        void grow() {
+            std::vector<Bucket> old_buckets = std::move(m_buckets);
+
+            m_buckets.clear();
+            m_buckets.resize((old_buckets.empty()) ? dictionary_threshold * 4 : old_buckets.size() * 2, Bucket {0UL, -1});
+            m_count = 0;
+
+            for (const auto& [old_hash, old_slot] : old_buckets) {
+                if (old_slot != -1) {
+                    insert(old_hash, old_slot);
+                }
+            }
+        }
+
+    public:
+        PropIndex() noexcept
+        : m_buckets {}, m_count {0} {}
+
+        [[nodiscard]] auto is_active() const noexcept -> bool {
+            return !m_buckets.empty();
+        }
+
+        void activate() {
+            if (m_buckets.empty()) {
+                grow();
+            }
+        }
+
+        void insert(std::size_t key_hash, int slot) {
+            //? NOTE: keep the load factor under 1/2 so probe chains stay short.
+            if ((m_count + 1) * 2 > static_cast<int>(m_buckets.size())) {
+                grow();
+            }
+
+            const std::size_t mask = m_buckets.size() - 1;
+
+            for (std::size_t probe_pos = key_hash & mask; ; probe_pos = (probe_pos + 1) & mask) {
+                if (auto& bucket = m_buckets[probe_pos]; bucket.slot == -1) {
+                    bucket = Bucket {key_hash, slot};
+                    ++m_count;
+                    return;
+                }
+            }
+        }
+
+        /// NOTE: Probes for a slot whose key has `key_hash`, letting `is_match(slot)` confirm the actual key. Yields -1 if no slot matched.
+        template <typename MatchFn>
+        [[nodiscard]] auto find_slot(std::size_t key_hash, MatchFn&& is_match) const -> int {
+            if (m_buckets.empty()) {
+                return -1;
+            }
+
+            const std::size_t mask = m_buckets.size() - 1;
+
+            for (std::size_t probe_pos = key_hash & mask; m_buckets[probe_pos].slot != -1; probe_pos = (probe_pos + 1) & mask) {
+                if (const auto& [bucket_hash, bucket_slot] = m_buckets[probe_pos]; bucket_hash == key_hash && is_match(bucket_slot)) {
+                    return bucket_slot;
+                }
+            }
+
+            return -1;
+        }
+    };
+
+    /**
+     * @brief Hidden class of an object's own property layout. Objects adding the same string keys in the same order share one `PropShape`, so a shape and a slot index can replace a linear key search for inline caches. Each thread's shapes live in one transition tree from `PropShape::root()` and are never freed.
+     */
+    class PropShape {
+    public:
+        /// NOTE: Objects growing past this many own properties are in dictionary mode, so they drop their shape and only take uncached lookups.
+        static constexpr int max_tracked_slots = PropIndex::dictionary_threshold;
+
+    private:
+        mutable std::vector<std::unique_ptr<PropShape>> m_transitions;
+        std::string m_key_text;
+        const PropShape* m_parent;
+        int m_slot;
+
+        PropShape(const PropShape* parent_p, std::string_view key_text, int slot)
+        : m_transitions {}, m_key_text (key_text), m_parent {parent_p}, m_slot {slot} {}
+
+    public:
+        PropShape()
+        : m_transitions {}, m_key_text {}, m_parent {nullptr}, m_slot {-1} {}
+
+        [[nodiscard]] static auto root() noexcept -> const PropShape* {
+            //? NOTE: Shape trees are per-thread, as transitions get added while isolates run concurrently.
+            thread_local PropShape root_shape {};
+
+            return &root_shape;
+        }
+
+        /// NOTE: Gives the next shape of `shape_p` after appending a key. Non-string keys (no text) or oversized layouts yield `nullptr`, the shapeless state.
+        [[nodiscard]] static auto next_of(const PropShape* shape_p, std::optional<std::string_view> key_text) -> const PropShape* {
+            if (!shape_p || !key_text || shape_p->get_slot_count() >= max_tracked_slots) {
+                return nullptr;
+            }
+
+            return shape_p->transition(*key_text);
+        }
+
+        [[nodiscard]] auto get_parent() const noexcept -> const PropShape* {
+            return m_parent;
+        }
+
+        [[nodiscard]] auto get_key_text() const noexcept -> std::string_view {
+            return m_key_text;
+        }
+
+        [[nodiscard]] auto get_slot_count() const noexcept -> int {
+            return m_slot + 1;
+        }
+
+        /// NOTE: Finds or creates the child shape for appending `key_text` as the next own property slot.
+        [[nodiscard]] auto transition(std::string_view key_text) const -> const PropShape* {
+            for (const auto& child_p : m_transitions) {
+                if (child_p->m_key_text == key_text) {
+                    return child_p.get();
+                }
+            }
+
+            return m_transitions.emplace_back(std::unique_ptr<PropShape>(new PropShape {this, key_text, m_slot + 1})).get();
+        }
+    };
+
+    /// NOTE: Generational GC state bits within each `ObjectBase` header.
+    enum class GCHeaderFlag : uint8_t {
+        none = 0x00,
+        young = 0x01,       // allocated since the last nursery collection
+        remembered = 0x02,  // old object in the GC's remembered set, as it may reference young objects
+        nursery_live = 0x04 // reached by the current nursery collection
+    };
+
     /**
      * @brief This virtual base class is an interface for all "objects" in DerkJS. Concrete sub-types from `ObjectBase` include `Object`s. Though all objects have a "template" object with the default values to properties of their type-structure- The prototype! For now, let's assume instances are clones of the prototype's "template".
      */
     template <typename V>
     class ObjectBase {
+    private:
+        //? NOTE: GC mark "bits": this object is marked (gray or black) only if this matches the collector's current epoch. See `./src/derkjs_impl/runtime/gc.ixx`.
+        uint32_t m_gc_epoch = 0;
+        uint8_t m_gc_flags = 0;
+
     public:
         virtual ~ObjectBase() = default;
 
+        [[nodiscard]] auto get_gc_epoch() const noexcept -> uint32_t {
+            return m_gc_epoch;
+        }
+
+        void set_gc_epoch(uint32_t epoch) noexcept {
+            m_gc_epoch = epoch;
+        }
+
+        [[nodiscard]] auto has_gc_flag(GCHeaderFlag flag) const noexcept -> bool {
+            return (m_gc_flags & std::to_underlying(flag)) != 0;
+        }
+
+        void set_gc_flag(GCHeaderFlag flag) noexcept {
+            m_gc_flags |= std::to_underlying(flag);
+        }
+
+        void clear_gc_flag(GCHeaderFlag flag) noexcept {
+            m_gc_flags &= ~std::to_underlying(flag);
+        }
+
+        void reset_gc_flags(GCHeaderFlag flag) noexcept {
+            m_gc_flags = std::to_underlying(flag);
+        }
+
+        //? Shape-aware objects expose their hidden class for inline caches. Others stay shapeless and always take uncached lookups.
+        virtual auto get_shape() const noexcept -> const PropShape* {
+            return nullptr;
+        }
+
+        //? Appends an own property when the resulting layout is already known from an inline cache, skipping the key search and shape transition. Yields `nullptr` if unsupported or not writable.
+        virtual auto append_shaped_property([[maybe_unused]] const V& key, [[maybe_unused]] const V& value, [[maybe_unused]] const PropShape* next_shape_p) -> V* {
+            return nullptr;
+        }
+
         virtual auto get_unique_addr() noexcept -> void* = 0;
         virtual auto get_class_name() const noexcept -> std::string = 0;
+
+        /// NOTE: Approximates this object's bytes: its own size plus owned buffers like properties, items, text, or code. Shared ropes count fully for each holder.
+        virtual auto get_footprint() const noexcept -> std::size_t = 0;
         virtual auto get_typename() const noexcept -> std::string_view = 0;
         virtual auto flag(AttrMask flag_mask) const noexcept -> bool = 0;
 
@@ -220,11 +415,12 @@ export namespace DerkJS {
         virtual auto as_string() const -> std::string = 0;
 
         /// virtual auto field_iter() noexcept -> FieldIterator<PropertyDescriptor<V>> = 0;
-        virtual auto opaque_iter() const noexcept -> OpaqueIterator = 0;
+        virtual auto opaque_iter() const -> OpaqueIterator = 0;
 
-        virtual auto operator==(const ObjectBase& other) const noexcept -> bool = 0;
-        virtual auto operator<(const ObjectBase& other) const noexcept -> bool = 0;
-        virtual auto operator>(const ObjectBase& other) const noexcept -> bool = 0;
+        //? NOTE: These may read flattened text of strings, which can allocate, so they're not `noexcept` here.
+        virtual auto operator==(const ObjectBase& other) const -> bool = 0;
+        virtual auto operator<(const ObjectBase& other) const -> bool = 0;
+        virtual auto operator>(const ObjectBase& other) const -> bool = 0;
     };
 
     /**
@@ -242,37 +438,107 @@ export namespace DerkJS {
         /// NOTE: This is for String.prototype.indexOf()
         virtual auto find_substr_pos(const StringBase* other_view) const noexcept -> int = 0;
 
-        virtual auto as_str_view() const noexcept -> std::string_view = 0;
+        /// NOTE: Rope-backed strings flatten here on first read, which allocates.
+        virtual auto as_str_view() const -> std::string_view = 0;
+
+        /// NOTE: This is the hash of `as_str_view()`, which is cached since property key lookups and interning use it often.
+        virtual auto get_hash() const -> std::size_t = 0;
     };
 
     template <typename ItemBase> requires (std::is_polymorphic_v<ItemBase>)
     class PolyPool {
     public:
-        // ObjectOverhead ~= sizeof(decltype(PropPool<V, V>::at(0))) + sizeof(Value) + <possible-metadata> = 32 + 16 + 8;
-        static constexpr std::size_t object_overhead = 32UL + 24UL + 16UL + 8UL;
-        static constexpr int max_id = 32767;
+        static constexpr int min_growth = 16;
 
     private:
         std::vector<std::unique_ptr<ItemBase>> m_items;
+        std::vector<std::size_t> m_slot_bytes; // each item's footprint as last measured, so removals subtract what was added
         std::vector<int> m_free_slots;
-        std::size_t m_overhead;
+        std::vector<int> m_nursery; // slot IDs of young items in allocation order, bumped on each add
+        std::size_t m_overhead; // bytes of all items, see `ObjectBase::get_footprint()`
+        std::size_t m_allocated_bytes; // total bytes ever added, for allocation rates
+        std::size_t m_allocated_count;
         int m_next_id;
-        int m_id_max;
+        int m_newest_id; // slot of the last added item, which may be a recycled one
         int m_last_tenured_id; // mark the end of preloaded native objects, etc.
+        uint32_t m_alloc_epoch; // GC epoch given to new items, so the collector decides if they start marked
+
+        /// NOTE: Recycles the newest free slot, or else takes a fresh one by growing the slot table geometrically. Growth only moves the owning pointers, so item addresses stay stable.
+        [[nodiscard]] auto claim_slot() -> int {
+            if (!m_free_slots.empty()) {
+                m_newest_id = m_free_slots.back();
+                m_free_slots.pop_back();
+
+                return m_newest_id;
+            }
+
+            if (const int slot_count = m_items.size(); m_next_id >= slot_count) {
+                m_items.resize(std::max(min_growth, slot_count * 2));
+                m_slot_bytes.resize(m_items.size());
+            }
+
+            m_newest_id = m_next_id++;
+
+            return m_newest_id;
+        }
+
+        /// NOTE: Initializes a newly placed item's GC header & nursery entry, and counts its bytes.
+        void admit_item(int slot_id) {
+            const auto item_bytes = m_items[slot_id]->get_footprint();
+
+            m_items[slot_id]->set_gc_epoch(m_alloc_epoch);
+            m_items[slot_id]->reset_gc_flags(GCHeaderFlag::young);
+            m_nursery.emplace_back(slot_id);
+
+            m_overhead += item_bytes - m_slot_bytes[slot_id];
+            m_slot_bytes[slot_id] = item_bytes;
+            m_allocated_bytes += item_bytes;
+            ++m_allocated_count;
+        }
 
     public:
         PolyPool()
-        : m_items {}, m_free_slots {}, m_overhead {0UL}, m_next_id {0}, m_id_max {0}, m_last_tenured_id {-1} {}
+        : m_items {}, m_slot_bytes {}, m_free_slots {}, m_nursery {}, m_overhead {0UL}, m_allocated_bytes {0UL}, m_allocated_count {0UL}, m_next_id {0}, m_newest_id {-1}, m_last_tenured_id {-1}, m_alloc_epoch {0} {}
 
         PolyPool(int capacity)
-        : m_items {}, m_free_slots {}, m_overhead {0UL}, m_next_id {0}, m_id_max {capacity}, m_last_tenured_id {-1} {
-            m_items.reserve(capacity);
-            m_items.resize(capacity);
+        : m_items {}, m_slot_bytes {}, m_free_slots {}, m_nursery {}, m_overhead {0UL}, m_allocated_bytes {0UL}, m_allocated_count {0UL}, m_next_id {0}, m_newest_id {-1}, m_last_tenured_id {-1}, m_alloc_epoch {0} {
+            //? NOTE: The capacity is just an initial slot count now, since the pool grows on demand.
+            m_items.resize((capacity > 0) ? capacity : 0);
+            m_slot_bytes.resize(m_items.size());
         }
 
+        /// NOTE: Gives the bytes of all items, which may lag behind objects growing after they were added until `remeasure_item()`.
         [[nodiscard]] auto get_overhead() const noexcept -> std::size_t {
             return m_overhead;
         }
+
+        [[nodiscard]] auto get_allocated_bytes() const noexcept -> std::size_t {
+            return m_allocated_bytes;
+        }
+
+        [[nodiscard]] auto get_allocated_count() const noexcept -> std::size_t {
+            return m_allocated_count;
+        }
+
+        [[nodiscard]] auto get_slot_capacity() const noexcept -> int {
+            return m_items.size();
+        }
+
+        [[nodiscard]] auto get_free_slot_count() const noexcept -> int {
+            return m_free_slots.size();
+        }
+
+        /// NOTE: Updates a live item's counted bytes, e.g for the GC's sweep once the item's properties or items have grown.
+        void remeasure_item(int id) noexcept {
+            if (id < 0 || id >= static_cast<int>(m_items.size()) || !m_items[id]) {
+                return;
+            }
+
+            const auto item_bytes = m_items[id]->get_footprint();
+
+            m_overhead += item_bytes - m_slot_bytes[id];
+            m_slot_bytes[id] = item_bytes;
+        }
     
         [[nodiscard]] auto view_items() const noexcept -> const std::vector<std::unique_ptr<ItemBase>>& {
             return m_items;
@@ -284,22 +550,46 @@ export namespace DerkJS {
 
         void tenure_items() noexcept {
             m_last_tenured_id = m_next_id;
+            promote_nursery();
         }
 
-        [[nodiscard]] auto get_next_id() noexcept -> int {
-            if (m_free_slots.empty()) {
-                return (m_next_id < m_id_max) ? m_next_id : -1;
+        [[nodiscard]] auto get_nursery() const noexcept -> const std::vector<int>& {
+            return m_nursery;
+        }
+
+        /// NOTE: Makes every young item old, e.g for preloaded objects or after a nursery collection has reaped the dead ones.
+        void promote_nursery() noexcept {
+            for (const auto young_id : m_nursery) {
+                if (auto& item_sp = m_items[young_id]; item_sp) {
+                    item_sp->clear_gc_flag(GCHeaderFlag::young);
+                    item_sp->clear_gc_flag(GCHeaderFlag::nursery_live);
+                }
             }
 
-            const int recycled_id = m_free_slots.back();
-            m_free_slots.pop_back();
+            m_nursery.clear();
+        }
+
+        void set_alloc_epoch(uint32_t epoch) noexcept {
+            m_alloc_epoch = epoch;
+        }
+
+        /// NOTE: Gives the end of all slot IDs ever used, within which the GC sweeps.
+        [[nodiscard]] auto get_used_extent() const noexcept -> int {
+            return m_next_id;
+        }
+
+        /// NOTE: Peeks the slot ID which the next `add_item()` will claim, without claiming it.
+        [[nodiscard]] auto get_next_id() const noexcept -> int {
+            if (m_free_slots.empty()) {
+                return m_next_id;
+            }
 
-            return recycled_id;
+            return m_free_slots.back();
         }
 
         [[nodiscard]] auto get_newest_item() noexcept -> ItemBase* {
-            if (m_next_id > 0) {
-                return m_items[m_next_id - 1].get();
+            if (m_newest_id >= 0) {
+                return m_items[m_newest_id].get();
             }
 
             return nullptr;
@@ -322,6 +612,7 @@ export namespace DerkJS {
             }
 
             m_items[id] = std::make_unique<item_kind_type>(std::forward<item_kind_type>(item));
+            admit_item(id);
 
             return true;
         }
@@ -333,6 +624,7 @@ export namespace DerkJS {
             }
 
             m_items[id] = std::unique_ptr<ItemKind>(item_p);
+            admit_item(id);
 
             return true;
         }
@@ -341,78 +633,59 @@ export namespace DerkJS {
         [[maybe_unused]] auto add_item(int id, ItemKind&& item) -> ItemBase* {
             using item_kind_type = std::remove_cvref_t<ItemKind>;
 
-            if (id < 0 || id >= static_cast<int>(m_items.size())) {
+            if (id < 0) {
                 return nullptr;
             }
 
-            int slot_id;
-
-            if (!m_free_slots.empty()) {
-                slot_id = m_free_slots.back();
-                m_free_slots.pop_back();
-            } else {
-                slot_id = m_next_id;
-                ++m_next_id;
-            }
+            const int slot_id = claim_slot();
 
             m_items[slot_id] = std::make_unique<item_kind_type>(std::forward<item_kind_type>(item));
-            m_overhead += object_overhead;
+            admit_item(slot_id);
 
             return m_items[slot_id].get();
         }
 
         template <typename ItemKind> requires (std::is_base_of_v<ItemBase, ItemKind>)
         [[maybe_unused]] auto add_item(int id, ItemKind* item_p) -> ItemBase* {
-            if (id < 0 || id >= static_cast<int>(m_items.size())) {
+            if (id < 0) {
                 return nullptr;
             }
 
-            int slot_id;
-
-            if (!m_free_slots.empty()) {
-                slot_id = m_free_slots.back();
-                m_free_slots.pop_back();
-            } else {
-                slot_id = m_next_id;
-                ++m_next_id;
-            }
+            const int slot_id = claim_slot();
 
             m_items[slot_id] = std::unique_ptr<ItemKind>(item_p);
-            m_overhead += object_overhead;
+            admit_item(slot_id);
 
             return m_items[slot_id].get();
         }
 
         /// NOTE: This overload only exists for the `Driver` to insert property values within insertion of native objects. Please see `./src/derkjs_impl/core/driver.ixx ~ line:138`!
         [[maybe_unused]] auto add_item(int id, std::unique_ptr<ItemBase> item_sp) -> ItemBase* {
-            if (id < 0 || id >= static_cast<int>(m_items.size())) {
+            if (id < 0) {
                 return nullptr;
             }
 
-            int slot_id;
-
-            if (!m_free_slots.empty()) {
-                slot_id = m_free_slots.back();
-                m_free_slots.pop_back();
-            } else {
-                slot_id = m_next_id;
-                ++m_next_id;
-            }
+            const int slot_id = claim_slot();
 
             m_items[slot_id] = std::move(item_sp);
-            m_overhead += object_overhead;
+            admit_item(slot_id);
 
             return m_items[slot_id].get();
         }
 
+        [[nodiscard]] auto is_tenured(int id) const noexcept -> bool {
+            return id <= m_last_tenured_id;
+        }
+
         [[maybe_unused]] auto remove_item(int id) -> bool {
-            if (id < 0 || id >= static_cast<int>(m_items.size()) || id <= m_last_tenured_id) {
+            if (id < 0 || id >= static_cast<int>(m_items.size()) || is_tenured(id)) {
                 return false;
             }
 
             m_items[id] = {};
             m_free_slots.emplace_back(id);
-            m_overhead -= object_overhead;
+            m_overhead -= m_slot_bytes[id];
+            m_slot_bytes[id] = 0;
 
             return true;
         }
@@ -1,8 +1,11 @@
 module;
 
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <algorithm>
+#include <optional>
+#include <span>
 
 export module runtime.op_handlers;
 
@@ -77,12 +80,30 @@ namespace DerkJS {
     inline void op_jump(ExternVMCtx& ctx);
     inline void op_object_call(ExternVMCtx& ctx);
     inline void op_ctor_call(ExternVMCtx& ctx);
+    inline void op_tail_call(ExternVMCtx& ctx);
     inline void op_ret(ExternVMCtx& ctx);
     inline void op_throw(ExternVMCtx& ctx);
     inline void op_catch(ExternVMCtx& ctx);
     inline void op_halt(ExternVMCtx& ctx);
+    inline void op_add_local_const(ExternVMCtx& ctx);
+    inline void op_sub_local_const(ExternVMCtx& ctx);
+    inline void op_get_prop_const(ExternVMCtx& ctx);
+    inline void op_jump_else_strict_eq(ExternVMCtx& ctx);
+    inline void op_jump_else_strict_ne(ExternVMCtx& ctx);
+    inline void op_jump_else_lt(ExternVMCtx& ctx);
+    inline void op_jump_else_lte(ExternVMCtx& ctx);
+    inline void op_jump_else_gt(ExternVMCtx& ctx);
+    inline void op_jump_else_gte(ExternVMCtx& ctx);
+    inline void op_add_i32(ExternVMCtx& ctx);
+    inline void op_add_f64(ExternVMCtx& ctx);
+    inline void op_sub_i32(ExternVMCtx& ctx);
+    inline void op_sub_f64(ExternVMCtx& ctx);
+    inline void op_test_lt_i32(ExternVMCtx& ctx);
+    inline void op_jump_else_lt_i32(ExternVMCtx& ctx);
+    inline void op_add_local_const_i32(ExternVMCtx& ctx);
+    inline void op_sub_local_const_i32(ExternVMCtx& ctx);
     export inline void dispatch_op(ExternVMCtx& ctx);
-    export inline void sub_eval_error_ctor(ExternVMCtx& ctx, bool in_try_block_flag);
+    export inline void sub_eval_error_ctor(ExternVMCtx& ctx);
 
     using tco_opcode_fn = void(*)(ExternVMCtx&);
     constexpr tco_opcode_fn tco_opcodes[static_cast<std::size_t>(Opcode::last)] = {
@@ -93,11 +114,56 @@ namespace DerkJS {
         op_numify, op_strcat, op_pre_inc, op_pre_dec, op_post_inc, op_post_dec,
         op_mod, op_mul, op_div, op_add, op_sub,
         op_test_falsy, op_test_strict_eq, op_test_strict_ne, op_test_lt, op_test_lte, op_test_gt, op_test_gte, op_cmp_protos,
-        op_jump_else, op_jump_if, op_jump, op_object_call, op_ctor_call, op_ret,
+        op_jump_else, op_jump_if, op_jump, op_object_call, op_ctor_call, op_tail_call, op_ret,
         op_throw, op_catch,
-        op_halt
+        op_halt,
+        op_add_local_const, op_sub_local_const, op_get_prop_const,
+        op_jump_else_strict_eq, op_jump_else_strict_ne, op_jump_else_lt, op_jump_else_lte, op_jump_else_gt, op_jump_else_gte,
+        op_add_i32, op_add_f64, op_sub_i32, op_sub_f64, op_test_lt_i32, op_jump_else_lt_i32, op_add_local_const_i32, op_sub_local_const_i32
     };
 
+    [[nodiscard]] constexpr auto feedback_of(const Value& operand) noexcept -> uint8_t {
+        switch (operand.get_tag()) {
+            case ValueTag::num_i32: return std::to_underlying(TypeFeedback::i32);
+            case ValueTag::num_f64: return std::to_underlying(TypeFeedback::f64);
+            default: return std::to_underlying(TypeFeedback::other);
+        }
+    }
+
+    /// NOTE: The code buffers are mutable vectors owned by the `Program` or by each `Lambda`, but the VM only reads them via const pointers. Quickening rewrites just the current instruction in place.
+    [[nodiscard]] inline auto current_site(ExternVMCtx& ctx) noexcept -> Instruction& {
+        return const_cast<Instruction&>(*ctx.rip_p);
+    }
+
+    /**
+     * @brief Counts a safepoint (a backward jump or a call) against the time slice, suspending the VM once it runs out. The host resumes by setting the status back to pending & re-dispatching, since `RIP` and the frames are already past the safepoint.
+     * @note Only the host's dispatch yields: a nested dispatch for a native's callback can't be resumed once the native returns.
+     */
+    inline void tick_safepoint(ExternVMCtx& ctx) noexcept {
+        if (ctx.slice_budget > 0 && ctx.status == VMErrcode::pending && ctx.ending_frame_depth == ctx.slice_frame_depth && --ctx.dispatch_allowance <= 0) {
+            ctx.status = VMErrcode::suspended;
+        }
+    }
+
+    /// NOTE: Records the operand types seen by a generic instruction, quickening it while they've all been one number kind. Widened feedback never quickens again, so sites can't flip-flop.
+    inline void observe_operands(ExternVMCtx& ctx, const Value& lhs, const Value& rhs, Opcode i32_op, Opcode f64_op) noexcept {
+        auto& site = current_site(ctx);
+        site.feedback |= feedback_of(lhs) | feedback_of(rhs);
+
+        if (site.feedback == std::to_underlying(TypeFeedback::i32)) {
+            site.op = i32_op;
+        } else if (site.feedback == std::to_underlying(TypeFeedback::f64)) {
+            site.op = f64_op;
+        }
+    }
+
+    /// NOTE: Reverts a quickened instruction which saw unexpected operands. The caller then re-dispatches it without advancing RIP, so the generic opcode handles these operands.
+    inline void deopt_site(ExternVMCtx& ctx, const Value& lhs, const Value& rhs, Opcode generic_op) noexcept {
+        auto& site = current_site(ctx);
+        site.feedback |= feedback_of(lhs) | feedback_of(rhs);
+        site.op = generic_op;
+    }
+
     inline void op_nop(ExternVMCtx& ctx) {
         ctx.rip_p++;
 
@@ -140,6 +206,8 @@ namespace DerkJS {
     }
 
     inline void op_store_upval(ExternVMCtx& ctx) {
+        ctx.gc.write_barrier(ctx.frames.back().capture_p, ctx.stack[ctx.rsp - 1]);
+
         if (auto new_upval_p = ctx.frames.back().capture_p->set_property_value(ctx.stack[ctx.rsp], ctx.stack[ctx.rsp - 1]); new_upval_p) {
             new_upval_p->clear_flag<AttrMask::configurable>();
             ctx.rip_p++;
@@ -193,6 +261,7 @@ namespace DerkJS {
         auto& dest_val_ref = ctx.stack[ctx.rsp - 1];
 
         if (dest_val_ref.is_assignable_ref()) {
+            ctx.write_barrier_at(dest_val_ref.get_value_ref(), ctx.stack[ctx.rsp]);
             *dest_val_ref.get_value_ref() = ctx.stack[ctx.rsp];
         }
 
@@ -240,8 +309,6 @@ namespace DerkJS {
     }
 
     inline void op_try_del(ExternVMCtx& ctx) {
-        const auto a0 = ctx.rip_p->args[0];
-
         if (auto& target_value = ctx.stack.at(ctx.rsp); target_value.get_tag() != ValueTag::val_ref) {
             target_value = Value {true};
             ctx.rip_p++;
@@ -250,8 +317,7 @@ namespace DerkJS {
             target_value = Value {true};
             ctx.rip_p++;
         } else if (ctx.prepare_error("Invalid delete on non-configurable property.", std::to_underlying(BuiltInObjects::type_error_ctor))) {
-            sub_eval_error_ctor(ctx, a0 == 1);
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), a0 == 1);
+            sub_eval_error_ctor(ctx);
         }
 
         TCO_ATTR
@@ -278,7 +344,7 @@ namespace DerkJS {
     }
 
     inline void op_put_obj_dud(ExternVMCtx& ctx) {
-        ctx.gc(ctx.heap, ctx.stack, ctx.rsp);
+        ctx.collect_garbage();
 
         auto obj_ref_p = ctx.heap.add_item(ctx.heap.get_next_id(), Object {
             /// NOTE: {}.__proto__ === Object.prototype
@@ -298,7 +364,7 @@ namespace DerkJS {
     }
 
     inline void op_make_arr(ExternVMCtx& ctx) {
-        ctx.gc(ctx.heap, ctx.stack, ctx.rsp);
+        ctx.collect_garbage();
 
         const auto a0 = ctx.rip_p->args[0];
         auto array_p = new Array {
@@ -337,21 +403,44 @@ namespace DerkJS {
         return dispatch_op(ctx);
     }
 
+    /// NOTE: Shared by `djs_get_prop` & its fused variant: replaces the target reference under the key on top with the property's value reference. Gives false without side effects for a non-object target.
+    [[nodiscard]] inline auto sub_get_prop(ExternVMCtx& ctx, int16_t cache_id, bool should_default) -> bool {
+        ObjectBase<Value>* target_obj_p = ctx.stack[ctx.rsp - 1].to_object();
+
+        if (!target_obj_p) {
+            return false;
+        }
+
+        ctx.interns.intern_key(ctx.stack[ctx.rsp]);
+
+        const ObjectBase<Value>* key_p = ctx.stack[ctx.rsp].to_object();
+
+        if (auto cached_item_p = ctx.probe_prop_cache(cache_id, target_obj_p, key_p); cached_item_p) {
+            ctx.stack[ctx.rsp - 1] = Value {cached_item_p};
+        } else {
+            auto property_desc = target_obj_p->get_property_value(
+                ctx.stack.at(ctx.rsp), // special prototype key from previous opcode `put_proto_key`
+                should_default
+            );
+
+            ctx.fill_prop_cache(cache_id, target_obj_p, key_p, property_desc.ref_value(), should_default);
+            ctx.stack.at(ctx.rsp - 1) = property_desc.get_value();
+        }
+
+        ctx.rsp--;
+
+        return true;
+    }
+
     inline void op_get_prop(ExternVMCtx& ctx) {
-        auto& target_ref = ctx.stack.at(ctx.rsp - 1);
         const auto a0 = ctx.rip_p->args[0];
         const auto a1 = ctx.rip_p->args[1];
+        const bool should_default = a1 & std::to_underlying(PropAccessFlags::should_default);
 
-        if (ObjectBase<Value>* target_obj_p = target_ref.to_object(); target_obj_p) {
-            ctx.stack.at(ctx.rsp - 1) = target_obj_p->get_property_value(
-                ctx.stack.at(ctx.rsp), // special prototype key from previous opcode `put_proto_key`
-                a0
-            ).get_value();
-            ctx.rsp--;
+        if (sub_get_prop(ctx, a0, should_default)) {
             ctx.rip_p++;
         } else if (ctx.prepare_error("Invalid property access of undefined / primitive.", std::to_underlying(BuiltInObjects::type_error_ctor))) {
-            sub_eval_error_ctor(ctx, a1 == 1);
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), a1 == 1);
+            sub_eval_error_ctor(ctx);
         }
 
         TCO_ATTR
@@ -359,13 +448,28 @@ namespace DerkJS {
     }
 
     inline void op_put_prop(ExternVMCtx& ctx) {
-        if (
-            auto target_object_p = ctx.stack[ctx.rsp - 2].to_object();
-            target_object_p != nullptr && target_object_p->set_property_value(
-                ctx.stack[ctx.rsp - 1], // property key
-                ctx.stack[ctx.rsp]      // property's new value
-            ) != nullptr
-        ) {
+        const auto a0 = ctx.rip_p->args[0];
+        auto target_object_p = ctx.stack[ctx.rsp - 2].to_object();
+        Value* stored_item_p = nullptr;
+
+        if (target_object_p != nullptr) {
+            ctx.interns.intern_key(ctx.stack[ctx.rsp - 1]);
+            ctx.gc.write_barrier(target_object_p, ctx.stack[ctx.rsp]);
+            stored_item_p = ctx.store_prop_cached(a0, target_object_p, ctx.stack[ctx.rsp - 1], ctx.stack[ctx.rsp]);
+
+            if (!stored_item_p) {
+                const PropShape* old_shape_p = target_object_p->get_shape();
+
+                stored_item_p = target_object_p->set_property_value(
+                    ctx.stack[ctx.rsp - 1], // property key
+                    ctx.stack[ctx.rsp]      // property's new value
+                );
+
+                ctx.fill_store_cache(a0, target_object_p, ctx.stack[ctx.rsp - 1].to_object(), old_shape_p, stored_item_p);
+            }
+        }
+
+        if (stored_item_p != nullptr) {
             ctx.rsp--;
             ctx.rsp--;
             ctx.rip_p++;
@@ -400,14 +504,14 @@ namespace DerkJS {
     }
 
     inline void op_strcat(ExternVMCtx& ctx) {
-        ctx.gc(ctx.heap, ctx.stack, ctx.rsp);
+        ctx.collect_garbage();
 
         /// NOTE: For making TCO possible, just allocate the new string on the heap via raw ptr to avoid non-trivial destructor problems. The heap will manage that anyways.
+        //? NOTE: The result is a rope sharing both operands' text, so building strings by repeated `+` doesn't re-copy the whole prefix each time.
         auto result_p = new DynamicString {
             ctx.stack[ctx.rsp].to_object()->get_prototype(),
             Value {ctx.builtins[static_cast<unsigned int>(BuiltInObjects::extra_length_key)]},
-            ctx.stack[ctx.rsp].to_string()};
-        result_p->append_back(ctx.stack[ctx.rsp - 1].to_string());
+            concat_ropes(rope_of(ctx.stack[ctx.rsp]), rope_of(ctx.stack[ctx.rsp - 1]))};
 
         if (auto temp_str_p = ctx.heap.add_item(ctx.heap.get_next_id(), result_p); !temp_str_p) {
             ctx.status = VMErrcode::bad_heap_alloc;
@@ -422,14 +526,11 @@ namespace DerkJS {
     }
 
     inline void op_pre_inc(ExternVMCtx& ctx) {
-        const auto a0 = ctx.rip_p->args[0];
-
         if (auto arg_ref_p = ctx.stack.at(ctx.rsp).get_value_ref(); arg_ref_p != nullptr) {
             ctx.stack.at(ctx.rsp) = arg_ref_p->increment().deep_clone();
             ctx.rip_p++;
         } else if (ctx.prepare_error("Invalid target of prefix increment.", std::to_underlying(BuiltInObjects::ref_error_ctor))) {
-            sub_eval_error_ctor(ctx, a0 == 1);
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), a0 == 1);
+            sub_eval_error_ctor(ctx);
         } else {
             ctx.status = VMErrcode::bad_operation;
         }
@@ -439,14 +540,11 @@ namespace DerkJS {
     }
 
     inline void op_pre_dec(ExternVMCtx& ctx) {
-        const auto a0 = ctx.rip_p->args[0];
-
         if (auto arg_ref_p = ctx.stack.at(ctx.rsp).get_value_ref(); arg_ref_p != nullptr) {
             ctx.stack.at(ctx.rsp) = arg_ref_p->decrement().deep_clone();
             ctx.rip_p++;
         } else if (ctx.prepare_error("Invalid target of prefix decrement.", std::to_underlying(BuiltInObjects::ref_error_ctor))) {
-            sub_eval_error_ctor(ctx, a0 == 1);
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), a0 == 1);
+            sub_eval_error_ctor(ctx);
         } else {
             ctx.status = VMErrcode::bad_operation;
         }
@@ -456,15 +554,12 @@ namespace DerkJS {
     }
 
     inline void op_post_inc(ExternVMCtx& ctx) {
-        const auto a0 = ctx.rip_p->args[0];
-
         if (auto arg_ref_p = ctx.stack.at(ctx.rsp).get_value_ref(); arg_ref_p != nullptr) {
             ctx.stack.at(ctx.rsp) = arg_ref_p->deep_clone();
             arg_ref_p->increment();
             ctx.rip_p++;
         } else if (ctx.prepare_error("Invalid target of postfix increment.", std::to_underlying(BuiltInObjects::ref_error_ctor))) {
-            sub_eval_error_ctor(ctx, a0 == 1);
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), a0 == 1);
+            sub_eval_error_ctor(ctx);
         } else {
             ctx.status = VMErrcode::bad_operation;
         }
@@ -474,15 +569,12 @@ namespace DerkJS {
     }
 
     inline void op_post_dec(ExternVMCtx& ctx) {
-        const auto a0 = ctx.rip_p->args[0];
-
         if (auto arg_ref_p = ctx.stack.at(ctx.rsp).get_value_ref(); arg_ref_p != nullptr) {
             ctx.stack.at(ctx.rsp) = arg_ref_p->deep_clone();
             arg_ref_p->decrement();
             ctx.rip_p++;
         } else if (ctx.prepare_error("Invalid target of postfix decrement.", std::to_underlying(BuiltInObjects::ref_error_ctor))) {
-            sub_eval_error_ctor(ctx, a0 == 1);
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), a0 == 1);
+            sub_eval_error_ctor(ctx);
         } else {
             ctx.status = VMErrcode::bad_operation;
         }
@@ -492,8 +584,9 @@ namespace DerkJS {
     }
 
     inline void op_mod(ExternVMCtx& ctx) {
-        std::swap_ranges(reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp), reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp) + sizeof(Value), reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp - 1));
-        ctx.stack[ctx.rsp - 1] %= ctx.stack[ctx.rsp];
+        //? NOTE: The LHS temporary on top is about to be popped anyway, so it's the accumulator before being moved down.
+        ctx.stack[ctx.rsp] %= ctx.stack[ctx.rsp - 1];
+        ctx.stack[ctx.rsp - 1] = ctx.stack[ctx.rsp];
         ctx.rsp--;
         ctx.rip_p++;
 
@@ -511,8 +604,8 @@ namespace DerkJS {
     }
 
     inline void op_div(ExternVMCtx& ctx) {
-        std::swap_ranges(reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp), reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp) + sizeof(Value), reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp - 1));
-        ctx.stack[ctx.rsp - 1] /= ctx.stack[ctx.rsp];
+        ctx.stack[ctx.rsp] /= ctx.stack[ctx.rsp - 1];
+        ctx.stack[ctx.rsp - 1] = ctx.stack[ctx.rsp];
         ctx.rsp--;
         ctx.rip_p++;
 
@@ -521,6 +614,7 @@ namespace DerkJS {
     }
 
     inline void op_add(ExternVMCtx& ctx) {
+        observe_operands(ctx, ctx.stack[ctx.rsp], ctx.stack[ctx.rsp - 1], Opcode::djs_add_i32, Opcode::djs_add_f64);
         ctx.stack[ctx.rsp - 1] += ctx.stack[ctx.rsp]; // commutativity of the PLUS operator allows avoidance of std::swap
         ctx.rsp--;
         ctx.rip_p++;
@@ -530,8 +624,9 @@ namespace DerkJS {
     }
 
     inline void op_sub(ExternVMCtx& ctx) {
-        std::swap_ranges(reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp), reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp) + sizeof(Value), reinterpret_cast<std::byte*>(ctx.stack.data() + ctx.rsp - 1));
-        ctx.stack[ctx.rsp - 1] -= ctx.stack[ctx.rsp];
+        observe_operands(ctx, ctx.stack[ctx.rsp], ctx.stack[ctx.rsp - 1], Opcode::djs_sub_i32, Opcode::djs_sub_f64);
+        ctx.stack[ctx.rsp] -= ctx.stack[ctx.rsp - 1];
+        ctx.stack[ctx.rsp - 1] = ctx.stack[ctx.rsp];
         ctx.rsp--;
         ctx.rip_p++;
 
@@ -567,6 +662,7 @@ namespace DerkJS {
     }
 
     inline void op_test_lt(ExternVMCtx& ctx) {
+        observe_operands(ctx, ctx.stack[ctx.rsp], ctx.stack[ctx.rsp - 1], Opcode::djs_test_lt_i32, Opcode::djs_test_lt);
         ctx.stack[ctx.rsp - 1] = ctx.stack[ctx.rsp - 1] > ctx.stack[ctx.rsp]; // IF x < y THEN y > x
         ctx.rsp--;
         ctx.rip_p++;
@@ -624,6 +720,10 @@ namespace DerkJS {
 
     inline void op_jump_else(ExternVMCtx& ctx) {
         if (!ctx.stack[ctx.rsp]) {
+            if (ctx.rip_p->args[0] < 0) {
+                tick_safepoint(ctx);
+            }
+
             ctx.rip_p += ctx.rip_p->args[0];
         } else {
             ctx.rsp--;
@@ -636,6 +736,10 @@ namespace DerkJS {
 
     inline void op_jump_if(ExternVMCtx& ctx) {
         if (ctx.stack[ctx.rsp]) {
+            if (ctx.rip_p->args[0] < 0) {
+                tick_safepoint(ctx);
+            }
+
             ctx.rip_p += ctx.rip_p->args[0];
         } else {
             ctx.rsp--;
@@ -647,6 +751,10 @@ namespace DerkJS {
     }
 
     inline void op_jump(ExternVMCtx& ctx) {
+        if (ctx.rip_p->args[0] < 0) {
+            tick_safepoint(ctx);
+        }
+
         ctx.rip_p += ctx.rip_p->args[0];
 
         TCO_ATTR
@@ -658,8 +766,8 @@ namespace DerkJS {
         const auto a1 = ctx.rip_p->args[1];
 
         if (auto callable_ptr = ctx.stack.at(ctx.rsp - a0).to_object(); callable_ptr != nullptr && callable_ptr->call(&ctx, a0, a1)) {
-            ; // ok
-        } else {
+            tick_safepoint(ctx);
+        } else if (ctx.status != VMErrcode::stack_overflow) {
             ctx.status = VMErrcode::bad_operation;
         }
 
@@ -670,8 +778,8 @@ namespace DerkJS {
     inline void op_ctor_call(ExternVMCtx& ctx) {
         const auto a0 = ctx.rip_p->args[0];
         if (auto callable_ptr = ctx.stack.at(ctx.rsp - a0).to_object(); callable_ptr != nullptr && callable_ptr->call_as_ctor(&ctx, a0)) {
-            ;
-        } else {
+            tick_safepoint(ctx);
+        } else if (ctx.status != VMErrcode::stack_overflow) {
             ctx.status = VMErrcode::bad_operation;
         }
 
@@ -679,8 +787,91 @@ namespace DerkJS {
         return dispatch_op(ctx);
     }
 
+    /// NOTE: Checks if a tail call may replace the current frame: it must be a normal call from a function (not the top-level) and outside of every `try` block, since the frame's handlers would be lost.
+    [[nodiscard]] inline auto can_reuse_frame(const ExternVMCtx& ctx) noexcept -> bool {
+        if (ctx.frames.size() < 2) {
+            return false;
+        }
+
+        const auto& current_frame = ctx.frames.back();
+
+        if (!current_frame.m_code_bp || (current_frame.m_flags & std::to_underlying(CallFlags::is_ctor))) {
+            return false;
+        }
+
+        const int call_pos = ctx.rip_p - current_frame.m_code_bp;
+
+        return std::none_of(current_frame.m_handlers.begin(), current_frame.m_handlers.end(), [call_pos](const ExceptionRange& handler) noexcept {
+            return call_pos >= handler.try_begin && call_pos < handler.try_end;
+        });
+    }
+
+    /**
+     * @brief Does a call in return position by first sliding `<thisArg> <callee> <args...>` down over the current frame's window. A bytecode callee's new frame then takes over the current frame's return address & caller RSBP, so the caller gets the result directly and recursion stays at a constant depth.
+     * @note Native callees just return into the following `djs_ret`, whose result slot is already the current frame's. Moved references into the discarded window are dereferenced first.
+     */
+    inline void op_tail_call(ExternVMCtx& ctx) {
+        const auto a0 = ctx.rip_p->args[0];
+        const auto a1 = ctx.rip_p->args[1];
+        auto callable_ptr = ctx.stack.at(ctx.rsp - a0).to_object();
+
+        if (!callable_ptr) {
+            ctx.status = VMErrcode::bad_operation;
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        const bool reuses_frame = can_reuse_frame(ctx);
+
+        if (reuses_frame) {
+            const int32_t window_src = ctx.rsp - a0 - 1;
+            const int32_t window_dest = ctx.frames.back().m_callee_sbp - 1;
+            const Value* discarded_begin_p = ctx.stack.data() + window_dest;
+            const Value* discarded_end_p = ctx.stack.data() + ctx.rsp + 1;
+
+            //? NOTE: All references are resolved before any slot is overwritten by the move.
+            for (int32_t slot_offset = 0; slot_offset <= a0 + 1; slot_offset++) {
+                if (auto& moved_value = ctx.stack[window_src + slot_offset]; moved_value.get_value_ref() >= discarded_begin_p && moved_value.get_value_ref() < discarded_end_p) {
+                    moved_value = moved_value.deep_clone();
+                }
+            }
+
+            std::copy(ctx.stack.begin() + window_src, ctx.stack.begin() + window_src + a0 + 2, ctx.stack.begin() + window_dest);
+
+            ctx.rsp = window_dest + a0 + 1;
+        }
+
+        const std::size_t old_frame_count = ctx.frames.size();
+
+        if (!callable_ptr->call(&ctx, a0, a1)) {
+            if (ctx.status != VMErrcode::stack_overflow) {
+                ctx.status = VMErrcode::bad_operation;
+            }
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        //? NOTE: A bytecode callee pushed its frame above the current one, which is then spliced out.
+        if (reuses_frame && ctx.frames.size() > old_frame_count) {
+            const auto replaced_frame = ctx.frames[old_frame_count - 1];
+            auto& callee_frame = ctx.frames.back();
+
+            callee_frame.m_caller_ret_ip = replaced_frame.m_caller_ret_ip;
+            callee_frame.m_caller_sbp = replaced_frame.m_caller_sbp;
+            ctx.frames[old_frame_count - 1] = callee_frame;
+            ctx.frames.pop_back();
+        }
+
+        tick_safepoint(ctx);
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
     inline void op_ret(ExternVMCtx& ctx) {
-        const auto& [caller_ret_ip, caller_addr, caller_capture_p, pack_object_p, callee_sbp, caller_sbp, calling_flags] = ctx.frames.back();
+        const auto& [caller_ret_ip, caller_addr, caller_capture_p, pack_object_p, callee_sbp, caller_sbp, calling_flags, callee_code_bp, callee_handlers] = ctx.frames.back();
 
         if (const auto a0 = ctx.rip_p->args[0]; a0 == 0) {
             ctx.stack.at(callee_sbp - 1) = ctx.stack.at(ctx.rsp);
@@ -707,13 +898,19 @@ namespace DerkJS {
 
     // TODO: refactor to call ErrorXYZ ctor, using IDs to select a built-in Error ctor to invoke with the stack top.
     inline void op_throw(ExternVMCtx& ctx) {
-        const auto a0 = ctx.rip_p->args[0];
+        const auto throw_site_p = ctx.rip_p;
+        const auto throw_frame_n = ctx.frames.size();
 
         //? NOTEs: index ctx.builtins for the Error ctor with an `a1` as index of the built-in object pointer array.
         if (auto thrown_value_as_obj = ctx.stack.at(ctx.rsp).to_object(); thrown_value_as_obj != nullptr && thrown_value_as_obj->get_class_name() == "Error") {
-            ctx.status = ctx.try_recover(thrown_value_as_obj, a0 == 1);
+            ctx.status = ctx.try_recover(thrown_value_as_obj);
         } else if (auto error_ctor_ptr = ctx.builtins.at(std::to_underlying(BuiltInObjects::error_ctor)); error_ctor_ptr->call_as_ctor(&ctx, 1)) {
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), a0 == 1);
+            //? NOTE: A native ctor already returned past the throw site, but a bytecode ctor's new frame just unwinds back to it.
+            if (ctx.frames.size() == throw_frame_n) {
+                ctx.rip_p = throw_site_p;
+            }
+
+            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object());
         } else {
             ctx.status = VMErrcode::bad_operation;
         }
@@ -736,25 +933,350 @@ namespace DerkJS {
         return dispatch_op(ctx);
     }
 
+    inline void op_add_local_const(ExternVMCtx& ctx) {
+        observe_operands(ctx, ctx.stack[ctx.rsbp + ctx.rip_p->args[1]], ctx.consts_view[ctx.rip_p->args[0]], Opcode::djs_add_local_const_i32, Opcode::djs_add_local_const);
+
+        //? NOTE: Same operand order as the unfused `djs_add`: the constant (RHS) is the accumulator.
+        ctx.stack[ctx.rsp + 1] = ctx.consts_view[ctx.rip_p->args[0]];
+        ctx.stack[ctx.rsp + 1] += ctx.stack[ctx.rsbp + ctx.rip_p->args[1]];
+        ctx.rsp++;
+        ctx.rip_p += 3;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_sub_local_const(ExternVMCtx& ctx) {
+        observe_operands(ctx, ctx.stack[ctx.rsbp + ctx.rip_p->args[1]], ctx.consts_view[ctx.rip_p->args[0]], Opcode::djs_sub_local_const_i32, Opcode::djs_sub_local_const);
+        ctx.stack[ctx.rsp + 1] = ctx.stack[ctx.rsbp + ctx.rip_p->args[1]];
+        ctx.stack[ctx.rsp + 1] -= ctx.consts_view[ctx.rip_p->args[0]];
+        ctx.rsp++;
+        ctx.rip_p += 3;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_get_prop_const(ExternVMCtx& ctx) {
+        const auto& get_prop_args = ctx.rip_p[1].args;
+        const bool should_default = get_prop_args[1] & std::to_underlying(PropAccessFlags::should_default);
+
+        ctx.stack[ctx.rsp + 1] = ctx.consts_view[ctx.rip_p->args[0]];
+        ctx.rsp++;
+
+        //? NOTE: Invalid targets just fall through to the kept `djs_get_prop`, which throws the usual error.
+        if (sub_get_prop(ctx, get_prop_args[0], should_default)) {
+            ctx.rip_p += 2;
+        } else {
+            ctx.rip_p++;
+        }
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    /// NOTE: Shared by the fused compare & `djs_jump_else` opcodes, doing exactly what the unfused pair would, including the safepoint of a backward jump. The comparison takes the (RHS, LHS) stack slots.
+    template <typename Compare>
+    inline void sub_jump_else_cmp(ExternVMCtx& ctx, Compare&& cmp) {
+        ctx.stack[ctx.rsp - 1] = Value {cmp(ctx.stack[ctx.rsp - 1], ctx.stack[ctx.rsp])};
+        ctx.rsp--;
+
+        if (!ctx.stack[ctx.rsp]) {
+            if (ctx.rip_p->args[0] < 0) {
+                tick_safepoint(ctx);
+            }
+
+            ctx.rip_p += ctx.rip_p->args[0];
+        } else {
+            ctx.rsp--;
+            ctx.rip_p += 2;
+        }
+    }
+
+    inline void op_jump_else_strict_eq(ExternVMCtx& ctx) {
+        sub_jump_else_cmp(ctx, [](const Value& rhs, const Value& lhs) { return rhs == lhs; });
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_jump_else_strict_ne(ExternVMCtx& ctx) {
+        sub_jump_else_cmp(ctx, [](const Value& rhs, const Value& lhs) { return rhs != lhs; });
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_jump_else_lt(ExternVMCtx& ctx) {
+        observe_operands(ctx, ctx.stack[ctx.rsp], ctx.stack[ctx.rsp - 1], Opcode::djs_jump_else_lt_i32, Opcode::djs_jump_else_lt);
+        sub_jump_else_cmp(ctx, [](const Value& rhs, const Value& lhs) { return rhs > lhs; });
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_jump_else_lte(ExternVMCtx& ctx) {
+        sub_jump_else_cmp(ctx, [](const Value& rhs, const Value& lhs) { return rhs >= lhs; });
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_jump_else_gt(ExternVMCtx& ctx) {
+        sub_jump_else_cmp(ctx, [](const Value& rhs, const Value& lhs) { return rhs < lhs; });
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_jump_else_gte(ExternVMCtx& ctx) {
+        sub_jump_else_cmp(ctx, [](const Value& rhs, const Value& lhs) { return rhs <= lhs; });
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_add_i32(ExternVMCtx& ctx) {
+        auto& rhs = ctx.stack[ctx.rsp - 1];
+        const auto& lhs = ctx.stack[ctx.rsp];
+
+        if (rhs.get_tag() != ValueTag::num_i32 || lhs.get_tag() != ValueTag::num_i32) {
+            deopt_site(ctx, lhs, rhs, Opcode::djs_add);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        rhs.add_i32(lhs.as_i32_unchecked());
+        ctx.rsp--;
+        ctx.rip_p++;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_add_f64(ExternVMCtx& ctx) {
+        auto& rhs = ctx.stack[ctx.rsp - 1];
+        const auto& lhs = ctx.stack[ctx.rsp];
+
+        if (rhs.get_tag() != ValueTag::num_f64 || lhs.get_tag() != ValueTag::num_f64) {
+            deopt_site(ctx, lhs, rhs, Opcode::djs_add);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        rhs.add_f64(lhs.as_f64_unchecked());
+        ctx.rsp--;
+        ctx.rip_p++;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_sub_i32(ExternVMCtx& ctx) {
+        const auto& rhs = ctx.stack[ctx.rsp - 1];
+        auto& lhs = ctx.stack[ctx.rsp];
+
+        if (rhs.get_tag() != ValueTag::num_i32 || lhs.get_tag() != ValueTag::num_i32) {
+            deopt_site(ctx, lhs, rhs, Opcode::djs_sub);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        lhs.sub_i32(rhs.as_i32_unchecked());
+        ctx.stack[ctx.rsp - 1] = lhs;
+        ctx.rsp--;
+        ctx.rip_p++;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_sub_f64(ExternVMCtx& ctx) {
+        const auto& rhs = ctx.stack[ctx.rsp - 1];
+        auto& lhs = ctx.stack[ctx.rsp];
+
+        if (rhs.get_tag() != ValueTag::num_f64 || lhs.get_tag() != ValueTag::num_f64) {
+            deopt_site(ctx, lhs, rhs, Opcode::djs_sub);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        lhs.sub_f64(rhs.as_f64_unchecked());
+        ctx.stack[ctx.rsp - 1] = lhs;
+        ctx.rsp--;
+        ctx.rip_p++;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_test_lt_i32(ExternVMCtx& ctx) {
+        const auto& rhs = ctx.stack[ctx.rsp - 1];
+        const auto& lhs = ctx.stack[ctx.rsp];
+
+        if (rhs.get_tag() != ValueTag::num_i32 || lhs.get_tag() != ValueTag::num_i32) {
+            deopt_site(ctx, lhs, rhs, Opcode::djs_test_lt);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        ctx.stack[ctx.rsp - 1] = Value {lhs.as_i32_unchecked() < rhs.as_i32_unchecked()};
+        ctx.rsp--;
+        ctx.rip_p++;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_jump_else_lt_i32(ExternVMCtx& ctx) {
+        if (ctx.stack[ctx.rsp - 1].get_tag() != ValueTag::num_i32 || ctx.stack[ctx.rsp].get_tag() != ValueTag::num_i32) {
+            deopt_site(ctx, ctx.stack[ctx.rsp], ctx.stack[ctx.rsp - 1], Opcode::djs_jump_else_lt);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        sub_jump_else_cmp(ctx, [](const Value& rhs, const Value& lhs) noexcept { return lhs.as_i32_unchecked() < rhs.as_i32_unchecked(); });
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_add_local_const_i32(ExternVMCtx& ctx) {
+        const auto& local_value = ctx.stack[ctx.rsbp + ctx.rip_p->args[1]];
+        const auto& const_value = ctx.consts_view[ctx.rip_p->args[0]];
+
+        if (local_value.get_tag() != ValueTag::num_i32 || const_value.get_tag() != ValueTag::num_i32) {
+            deopt_site(ctx, local_value, const_value, Opcode::djs_add_local_const);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        ctx.stack[ctx.rsp + 1] = const_value;
+        ctx.stack[ctx.rsp + 1].add_i32(local_value.as_i32_unchecked());
+        ctx.rsp++;
+        ctx.rip_p += 3;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
+    inline void op_sub_local_const_i32(ExternVMCtx& ctx) {
+        const auto& local_value = ctx.stack[ctx.rsbp + ctx.rip_p->args[1]];
+        const auto& const_value = ctx.consts_view[ctx.rip_p->args[0]];
+
+        if (local_value.get_tag() != ValueTag::num_i32 || const_value.get_tag() != ValueTag::num_i32) {
+            deopt_site(ctx, local_value, const_value, Opcode::djs_sub_local_const);
+
+            TCO_ATTR
+            return dispatch_op(ctx);
+        }
+
+        ctx.stack[ctx.rsp + 1] = local_value;
+        ctx.stack[ctx.rsp + 1].sub_i32(const_value.as_i32_unchecked());
+        ctx.rsp++;
+        ctx.rip_p += 3;
+
+        TCO_ATTR
+        return dispatch_op(ctx);
+    }
+
     export inline void dispatch_op(ExternVMCtx& ctx) {
-        if (ctx.status != VMErrcode::pending /* || ctx.dispatch_allowance == 0*/) {
+        if (ctx.status != VMErrcode::pending) {
             return;
         }
 
+#ifdef DERKJS_PROFILE
+        ctx.profiler.sample(ctx.rip_p, ctx.frames.back().m_code_bp);
+#endif
+
         TCO_ATTR
         return tco_opcodes[ctx.rip_p->op](ctx);
     }
 
-    export inline void sub_eval_error_ctor(ExternVMCtx& ctx, bool in_try_block_flag) {
+    export inline void sub_eval_error_ctor(ExternVMCtx& ctx) {
         const auto old_vm_frame_n = ctx.ending_frame_depth;
+        const auto throw_site_p = ctx.rip_p;
         ctx.ending_frame_depth = ctx.frames.size();
 
         if (ctx.stack.at(ctx.rsp - 1).to_object()->call_as_ctor(&ctx, 1)) {
             dispatch_op(ctx);
             ctx.ending_frame_depth = old_vm_frame_n;
-            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object(), in_try_block_flag);
+            //? NOTE: The ctor call returned just past the throw site, but handler lookup needs the site itself.
+            ctx.rip_p = throw_site_p;
+            ctx.status = ctx.try_recover(ctx.stack.at(ctx.rsp).to_object());
         } else {
             ctx.status = VMErrcode::bad_operation;
         }
     }
+
+    /**
+     * @brief Calls a JS or native function from inside a native, like `Function.prototype.call` but without touching the native's own stack slots. The call is laid out above RSP as `<thisArg> <callee> <args...>` and runs until its frame returns.
+     * @return The callee's result, or nothing if it was not callable, the stack is full, or the callback failed. For failures, `ctx.status` keeps the error, which is `VMErrcode::stack_overflow` past `ExternVMCtx::max_reentry_depth` nested calls.
+     */
+    export [[nodiscard]] inline auto call_reentrant(ExternVMCtx& ctx, ObjectBase<Value>* callee_p, const Value& this_arg, std::span<const Value> args) -> std::optional<Value> {
+        const auto old_vm_frame_n = ctx.ending_frame_depth;
+        const auto old_vm_status = ctx.status;
+        const auto old_rip_p = ctx.rip_p;
+        const int32_t old_rsp = ctx.rsp;
+
+        if (!callee_p) {
+            return {};
+        } else if (ctx.reentry_depth >= ExternVMCtx::max_reentry_depth || !ctx.reserve_stack(static_cast<std::size_t>(old_rsp) + 3 + args.size())) {
+            ctx.status = VMErrcode::stack_overflow;
+            return {};
+        }
+
+        ++ctx.reentry_depth;
+
+        ctx.stack[++ctx.rsp] = this_arg;
+        ctx.stack[++ctx.rsp] = Value {callee_p};
+
+        for (const auto& arg : args) {
+            ctx.stack[++ctx.rsp] = arg;
+        }
+
+        ctx.ending_frame_depth = ctx.frames.size();
+        ctx.status = VMErrcode::pending;
+
+        if (!callee_p->call(&ctx, static_cast<int>(args.size()), true)) {
+            //? NOTE: Callees which failed by an error like `VMErrcode::stack_overflow` keep it for the caller to report.
+            if (ctx.status == VMErrcode::pending) {
+                ctx.status = old_vm_status;
+            }
+
+            --ctx.reentry_depth;
+            ctx.ending_frame_depth = old_vm_frame_n;
+            ctx.rsp = old_rsp;
+            ctx.rip_p = old_rip_p;
+            return {};
+        }
+
+        //? NOTE: Native callees already returned, but bytecode callees just pushed their frame.
+        if (ctx.frames.size() > ctx.ending_frame_depth) {
+            dispatch_op(ctx);
+        }
+
+        --ctx.reentry_depth;
+
+        if (ctx.status != VMErrcode::ok && ctx.status != VMErrcode::pending) {
+            ctx.ending_frame_depth = old_vm_frame_n;
+            return {};
+        }
+
+        auto result = ctx.stack[old_rsp + 1].deep_clone();
+
+        ctx.ending_frame_depth = old_vm_frame_n;
+        ctx.status = old_vm_status;
+        ctx.rsp = old_rsp;
+        ctx.rip_p = old_rip_p;
+
+        return result;
+    }
 }
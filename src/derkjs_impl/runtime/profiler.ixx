@@ -0,0 +1,194 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <flat_map>
+#include <format>
+#include <print>
+
+export module runtime.profiler;
+
+import runtime.bytecode;
+
+export namespace DerkJS {
+#ifdef DERKJS_PROFILE
+    /// NOTE: Whether `dispatch_op()` feeds the profiler, which only a `DERKJS_PROFILE` build does.
+    constexpr bool profiling_built_in = true;
+#else
+    constexpr bool profiling_built_in = false;
+#endif
+
+    /// NOTE: Reads the CPU's cycle counter if Clang exposes it, or else the steady clock's ticks.
+    [[nodiscard]] inline auto read_cycles() noexcept -> uint64_t {
+#ifdef __has_builtin
+#if __has_builtin(__builtin_readcyclecounter)
+        return __builtin_readcyclecounter();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    struct ProfileStats {
+        uint64_t count;
+        uint64_t cycles;
+    };
+
+    /// NOTE: Stats of one instruction, plus the code buffer it's in for grouping by function.
+    struct SiteStats {
+        const Instruction* code_bp;
+        ProfileStats stats;
+    };
+
+    /**
+     * @brief Counts dispatches & cycles per opcode, per function (code buffer), and per instruction site. Each sample charges the cycles since the previous sample to the previous instruction, so a native's time is charged to its calling instruction.
+     * @note The bytecode has no line table, so sites are reported as code offsets in their function instead of source lines. After a native's nested callback returns, the rest of the native's time goes to that callback's return.
+     */
+    class OpProfiler {
+    public:
+        static constexpr std::size_t default_report_rows = 12;
+
+    private:
+        std::array<ProfileStats, static_cast<std::size_t>(Opcode::last)> m_op_stats;
+        std::unordered_map<const Instruction*, ProfileStats> m_fn_stats;
+        std::unordered_map<const Instruction*, SiteStats> m_site_stats;
+        const Instruction* m_last_site_p;
+        const Instruction* m_last_code_bp;
+        uint64_t m_last_cycles;
+        Opcode m_last_op;
+
+        void charge_last(uint64_t now_cycles) {
+            if (!m_last_site_p) {
+                return;
+            }
+
+            const auto elapsed = now_cycles - m_last_cycles;
+
+            m_op_stats[static_cast<std::size_t>(m_last_op)].cycles += elapsed;
+            m_fn_stats[m_last_code_bp].cycles += elapsed;
+            m_site_stats[m_last_site_p].stats.cycles += elapsed;
+        }
+
+        template <typename Key, typename Stats, typename StatsOf>
+        [[nodiscard]] static auto hottest(const std::unordered_map<Key, Stats>& table, StatsOf&& stats_of, std::size_t row_limit) -> std::vector<std::pair<Key, Stats>> {
+            std::vector<std::pair<Key, Stats>> rows {table.begin(), table.end()};
+
+            std::ranges::sort(rows, [&stats_of](const auto& lhs, const auto& rhs) {
+                return stats_of(lhs.second).cycles > stats_of(rhs.second).cycles;
+            });
+
+            if (rows.size() > row_limit) {
+                rows.resize(row_limit);
+            }
+
+            return rows;
+        }
+
+    public:
+        OpProfiler()
+        : m_op_stats {}, m_fn_stats {}, m_site_stats {}, m_last_site_p {nullptr}, m_last_code_bp {nullptr}, m_last_cycles {0}, m_last_op {Opcode::djs_nop} {}
+
+        /// NOTE: Called before each dispatch of `site_p`, whose function's code starts at `code_bp`.
+        void sample(const Instruction* site_p, const Instruction* code_bp) {
+            const auto now_cycles = read_cycles();
+
+            charge_last(now_cycles);
+
+            m_op_stats[static_cast<std::size_t>(site_p->op)].count++;
+            m_fn_stats[code_bp].count++;
+
+            auto& site_stats = m_site_stats[site_p];
+            site_stats.code_bp = code_bp;
+            site_stats.stats.count++;
+
+            m_last_site_p = site_p;
+            m_last_code_bp = code_bp;
+            m_last_op = site_p->op;
+            m_last_cycles = read_cycles(); // excludes the profiler's own bookkeeping
+        }
+
+        /// NOTE: Charges the final instruction once the VM stops.
+        void stop() {
+            charge_last(read_cycles());
+            m_last_site_p = nullptr;
+        }
+
+        [[nodiscard]] auto empty() const noexcept -> bool {
+            return m_fn_stats.empty();
+        }
+
+        /**
+         * @brief Prints the hottest opcodes, functions, & instruction sites by cycles.
+         * @param fn_names Labels functions by their code buffer. Unlabeled ones show their address, e.g for collected functions.
+         */
+        void print_report(const std::flat_map<const Instruction*, std::string>& fn_names, std::size_t row_limit = default_report_rows) const {
+            uint64_t total_cycles = 0;
+            uint64_t total_count = 0;
+
+            for (const auto& [op_count, op_cycles] : m_op_stats) {
+                total_cycles += op_cycles;
+                total_count += op_count;
+            }
+
+            const auto percent_of = [total_cycles](uint64_t cycles) noexcept -> double {
+                return (total_cycles > 0) ? 100.0 * static_cast<double>(cycles) / static_cast<double>(total_cycles) : 0.0;
+            };
+
+            const auto name_of = [&fn_names](const Instruction* code_bp) -> std::string {
+                if (auto name_it = fn_names.find(code_bp); name_it != fn_names.end()) {
+                    return name_it->second;
+                }
+
+                return std::format("function@{}", static_cast<const void*>(code_bp));
+            };
+
+            std::println("\n\x1b[1;33mProfile:\x1b[0m\n\nDispatches: {}\nCycles: {}\n", total_count, total_cycles);
+
+            std::println("\x1b[1;33mHot Opcodes:\x1b[0m\n");
+
+            std::vector<std::size_t> op_ids (m_op_stats.size());
+
+            for (std::size_t op_id = 0; op_id < op_ids.size(); op_id++) {
+                op_ids[op_id] = op_id;
+            }
+
+            std::ranges::sort(op_ids, [this](std::size_t lhs, std::size_t rhs) {
+                return m_op_stats[lhs].cycles > m_op_stats[rhs].cycles;
+            });
+
+            for (std::size_t row = 0; row < std::min(row_limit, op_ids.size()) && m_op_stats[op_ids[row]].count > 0; row++) {
+                const auto& [op_count, op_cycles] = m_op_stats[op_ids[row]];
+                std::println("{:<28} count: {:<12} cycles: {:<14} ({:.1f}%)", opcode_names.at(op_ids[row]), op_count, op_cycles, percent_of(op_cycles));
+            }
+
+            std::println("\n\x1b[1;33mHot Functions:\x1b[0m\n");
+
+            for (const auto& [code_bp, fn_stats] : hottest(m_fn_stats, [](const ProfileStats& stats) noexcept { return stats; }, row_limit)) {
+                std::println("{:<28} count: {:<12} cycles: {:<14} ({:.1f}%)", name_of(code_bp), fn_stats.count, fn_stats.cycles, percent_of(fn_stats.cycles));
+            }
+
+            std::println("\n\x1b[1;33mHot Sites:\x1b[0m\n");
+
+            for (const auto& [site_p, site_stats] : hottest(m_site_stats, [](const SiteStats& stats) noexcept { return stats.stats; }, row_limit)) {
+                std::println(
+                    "{:<28} {:<24} count: {:<12} cycles: {:<14} ({:.1f}%)",
+                    std::format("{}+{}", name_of(site_stats.code_bp), site_p - site_stats.code_bp),
+                    opcode_names.at(static_cast<std::size_t>(site_p->op)),
+                    site_stats.stats.count,
+                    site_stats.stats.cycles,
+                    percent_of(site_stats.stats.cycles)
+                );
+            }
+        }
+    };
+}
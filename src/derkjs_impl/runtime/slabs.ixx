@@ -0,0 +1,111 @@
+module;
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <vector>
+
+export module runtime.slabs;
+
+export namespace DerkJS {
+    /// NOTE: Slab slots are rounded up to multiples of this, which also covers the alignment of all heap object types.
+    constexpr std::size_t slab_alignment = alignof(std::max_align_t);
+
+    template <typename T>
+    constexpr std::size_t slab_size_class_v = (sizeof(T) + slab_alignment - 1) / slab_alignment * slab_alignment;
+
+    /**
+     * @brief Fixed-size slot allocator carving slabs of `slots_per_slab` slots. Freed slots go onto an intrusive free list, so reuse is LIFO & O(1). Slabs are only released when the arena is destroyed.
+     * @tparam SlotSize A size class from `slab_size_class_v`.
+     */
+    template <std::size_t SlotSize>
+    class SlabArena {
+    public:
+        static constexpr std::size_t slots_per_slab = 256;
+
+    private:
+        struct FreeSlot {
+            FreeSlot* next_p;
+        };
+
+        static_assert(SlotSize >= sizeof(FreeSlot) && SlotSize % slab_alignment == 0, "Invalid slab size class.");
+
+        std::vector<std::unique_ptr<std::byte[]>> m_slabs;
+        FreeSlot* m_free_p;
+        std::size_t m_live_count;
+
+        void add_slab() {
+            auto& slab_sp = m_slabs.emplace_back(std::make_unique_for_overwrite<std::byte[]>(SlotSize * slots_per_slab));
+
+            //? NOTE: Thread slots in reverse, so allocations from a fresh slab go in address order.
+            for (std::size_t slot_pos = slots_per_slab; slot_pos > 0; slot_pos--) {
+                m_free_p = ::new (slab_sp.get() + (slot_pos - 1) * SlotSize) FreeSlot {m_free_p};
+            }
+        }
+
+    public:
+        SlabArena()
+        : m_slabs {}, m_free_p {nullptr}, m_live_count {0} {}
+
+        SlabArena(const SlabArena&) = delete;
+        SlabArena& operator=(const SlabArena&) = delete;
+
+        [[nodiscard]] auto get_slab_count() const noexcept -> std::size_t {
+            return m_slabs.size();
+        }
+
+        [[nodiscard]] auto get_live_count() const noexcept -> std::size_t {
+            return m_live_count;
+        }
+
+        [[nodiscard]] auto allocate() -> void* {
+            if (!m_free_p) {
+                add_slab();
+            }
+
+            auto slot_p = m_free_p;
+            m_free_p = slot_p->next_p;
+            ++m_live_count;
+
+            return slot_p;
+        }
+
+        void deallocate(void* slot_p) noexcept {
+            m_free_p = ::new (slot_p) FreeSlot {m_free_p};
+            --m_live_count;
+        }
+    };
+
+    /// NOTE: Gives the calling thread's slab arena for all exact `T` instances. Arenas are per-thread since each isolate's objects are made & freed on its own thread, so no locking is needed.
+    template <typename T>
+    [[nodiscard]] auto slab_arena_of() -> SlabArena<slab_size_class_v<T>>& {
+        static_assert(alignof(T) <= slab_alignment, "Over-aligned types cannot use slabs.");
+
+        thread_local SlabArena<slab_size_class_v<T>> arena;
+
+        return arena;
+    }
+
+    /// NOTE: For a class-specific `operator new` of `T`. Any unexpected size e.g from a subclass without its own slab just goes to the global heap.
+    template <typename T>
+    [[nodiscard]] auto slab_allocate(std::size_t size) -> void* {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+
+        return slab_arena_of<T>().allocate();
+    }
+
+    /// NOTE: For a class-specific `operator delete` of `T`, which must mirror `slab_allocate<T>()`.
+    template <typename T>
+    void slab_deallocate(void* ptr, std::size_t size) noexcept {
+        if (!ptr) {
+            return;
+        } else if (size != sizeof(T)) {
+            ::operator delete(ptr, size);
+            return;
+        }
+
+        slab_arena_of<T>().deallocate(ptr);
+    }
+}
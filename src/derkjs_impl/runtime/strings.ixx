@@ -2,6 +2,10 @@ module;
 
 #include <utility>
 #include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -9,19 +13,188 @@ module;
 export module runtime.strings;
 
 import runtime.value;
+import runtime.slabs;
 
 export namespace DerkJS {
+    struct RopeNode;
+
+    using RopePtr = std::shared_ptr<const RopeNode>;
+
+    /**
+     * @brief Immutable node of a concatenation tree. Leaves own their text and inner nodes just share their children, so concatenating two ropes is O(1) and copies no characters.
+     * @note Slices only have a `left` leaf, whose text they view from `offset`. Ropes are not heap objects: shared ownership keeps node text alive for every string that uses it (even after the parent string is swept), so the GC never traces them.
+     */
+    struct RopeNode {
+        /// NOTE: Deeper concatenations flatten their deeper side first. This bounds the recursion of node destructors and flattening's work stack.
+        static constexpr int max_depth = 256;
+
+        RopePtr left;
+        RopePtr right;
+        std::string leaf;
+        std::size_t offset;
+        std::size_t length;
+        int depth;
+
+        [[nodiscard]] auto is_leaf() const noexcept -> bool {
+            return !left;
+        }
+
+        [[nodiscard]] auto is_slice() const noexcept -> bool {
+            return left && !right;
+        }
+
+        /// NOTE: Only valid for leaves and slices.
+        [[nodiscard]] auto view_text() const noexcept -> std::string_view {
+            if (is_slice()) {
+                return std::string_view {left->leaf}.substr(offset, length);
+            }
+
+            return leaf;
+        }
+
+        /// NOTE: Appends all text in order without recursion.
+        void flatten_into(std::string& out) const {
+            std::vector<const RopeNode*> pending {this};
+
+            while (!pending.empty()) {
+                auto node_p = pending.back();
+                pending.pop_back();
+
+                if (node_p->is_leaf() || node_p->is_slice()) {
+                    out.append_range(node_p->view_text());
+                } else {
+                    pending.push_back(node_p->right.get());
+                    pending.push_back(node_p->left.get());
+                }
+            }
+        }
+    };
+
+    [[nodiscard]] auto make_rope_leaf(std::string s) -> RopePtr {
+        const auto leaf_length = s.length();
+
+        return std::make_shared<const RopeNode>(RopeNode {
+            .left = nullptr,
+            .right = nullptr,
+            .leaf = std::move(s),
+            .offset = 0,
+            .length = leaf_length,
+            .depth = 0
+        });
+    }
+
+    /// NOTE: `source` must be a leaf or slice, and the range must be within its text. Slices of slices just view the same leaf.
+    [[nodiscard]] auto make_rope_slice(RopePtr source, std::size_t offset, std::size_t length) -> RopePtr {
+        if (offset == 0 && length == source->length) {
+            return source;
+        } else if (source->is_slice()) {
+            offset += source->offset;
+            source = source->left;
+        }
+
+        return std::make_shared<const RopeNode>(RopeNode {
+            .left = std::move(source),
+            .right = nullptr,
+            .leaf = {},
+            .offset = offset,
+            .length = length,
+            .depth = 0
+        });
+    }
+
+    [[nodiscard]] auto concat_ropes(RopePtr lhs, RopePtr rhs) -> RopePtr {
+        if (lhs->length == 0) {
+            return rhs;
+        } else if (rhs->length == 0) {
+            return lhs;
+        }
+
+        for (auto side_p : {&lhs, &rhs}) {
+            if (auto& side = *side_p; side->depth >= RopeNode::max_depth) {
+                std::string flat_side;
+                flat_side.reserve(side->length);
+                side->flatten_into(flat_side);
+                side = make_rope_leaf(std::move(flat_side));
+            }
+        }
+
+        const auto total_length = lhs->length + rhs->length;
+        const auto total_depth = std::max(lhs->depth, rhs->depth) + 1;
+
+        return std::make_shared<const RopeNode>(RopeNode {
+            .left = std::move(lhs),
+            .right = std::move(rhs),
+            .leaf = {},
+            .offset = 0,
+            .length = total_length,
+            .depth = total_depth
+        });
+    }
+
+    /// NOTE: Concatenates pieces [first, last) as a balanced tree, so the result's depth is only logarithmic in the piece count.
+    [[nodiscard]] auto concat_rope_range(const std::vector<RopePtr>& pieces, std::size_t first, std::size_t last) -> RopePtr {
+        if (first >= last) {
+            return make_rope_leaf({});
+        } else if (last - first == 1) {
+            return pieces[first];
+        }
+
+        const auto middle = first + (last - first) / 2;
+
+        return concat_ropes(concat_rope_range(pieces, first, middle), concat_rope_range(pieces, middle, last));
+    }
+
     /// NOTE: create special copy, move, and destructor ops since std::unique_ptr may recursively release in the destructor.
     class DynamicString : public ObjectBase<Value>, public StringBase {
     private:
         PropPool<Value, Value> m_own_properties;
         std::string m_data;
+        mutable RopePtr m_rope; // if set, this holds the text instead of `m_data`: concatenations flatten into a leaf on first read
         Value m_prototype;
+        mutable std::optional<std::size_t> m_hash; // cached hash of the text, reset on any append
         uint8_t m_flags;
 
+        /// NOTE: Replaces a concatenation rope with one leaf of its text.
+        void flatten_rope() const {
+            if (m_rope && !m_rope->is_leaf() && !m_rope->is_slice()) {
+                std::string flat_text;
+                flat_text.reserve(m_rope->length);
+                m_rope->flatten_into(flat_text);
+                m_rope = make_rope_leaf(std::move(flat_text));
+            }
+        }
+
+        [[nodiscard]] auto flat_view() const -> std::string_view {
+            if (!m_rope) {
+                return m_data;
+            }
+
+            flatten_rope();
+
+            return m_rope->view_text();
+        }
+
+        /// NOTE: Appends need owned text, so a shared rope is copied out first.
+        void detach_rope() {
+            if (m_rope) {
+                m_data.clear();
+                m_rope->flatten_into(m_data);
+                m_rope.reset();
+            }
+        }
+
     public:
+        /// NOTE: Instances are placed into this type's slab arena, see `./src/derkjs_impl/runtime/slabs.ixx`.
+        [[nodiscard]] static auto operator new(std::size_t size) -> void* {
+            return slab_allocate<DynamicString>(size);
+        }
+
+        static void operator delete(void* ptr, std::size_t size) noexcept {
+            slab_deallocate<DynamicString>(ptr, size);
+        }
+
         DynamicString(ObjectBase<Value>* prototype_p, const Value& length_key, std::string s)
-        : m_own_properties {}, m_data (std::move(s)), m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_flags {std::to_underlying(AttrMask::defaults)} {
+        : m_own_properties {}, m_data (std::move(s)), m_rope {}, m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_hash {}, m_flags {std::to_underlying(AttrMask::defaults)} {
             m_prototype.update_flags(m_flags);
 
             if (length_key.is_valid_object_ref()) {
@@ -34,7 +207,7 @@ export namespace DerkJS {
         }
 
         explicit DynamicString(ObjectBase<Value>* prototype_p, const Value& length_key, std::string_view sv)
-        : m_own_properties {}, m_data {}, m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_flags {std::to_underlying(AttrMask::defaults)} {
+        : m_own_properties {}, m_data {}, m_rope {}, m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_hash {}, m_flags {std::to_underlying(AttrMask::defaults)} {
             m_data.append_range(sv);
 
             if (length_key.is_valid_object_ref()) {
@@ -46,7 +219,44 @@ export namespace DerkJS {
             }
         }
 
+        explicit DynamicString(ObjectBase<Value>* prototype_p, const Value& length_key, RopePtr rope)
+        : m_own_properties {}, m_data {}, m_rope (std::move(rope)), m_prototype {prototype_p, std::to_underlying(AttrMask::defaults) | std::to_underlying(AttrMask::property)}, m_hash {}, m_flags {std::to_underlying(AttrMask::defaults)} {
+            m_prototype.update_flags(m_flags);
+
+            if (length_key.is_valid_object_ref()) {
+                m_own_properties.emplace_back(PropEntry<Value, Value> {
+                    .key = length_key,
+                    .item = Value {static_cast<int>(m_rope->length), std::to_underlying(AttrMask::frozen) | std::to_underlying(AttrMask::property)},
+                    .handler_p = nullptr
+                });
+            }
+        }
+
         /// Specific helper methods
+        /// NOTE: Flat strings at least this long move their text into a shared leaf instead of copying it. Their buffer stays put, unlike short strings' inline buffers, so views of it stay valid.
+        static constexpr std::size_t min_shared_leaf_length = 64;
+
+        /// NOTE: Gives this text as a shareable rope for `op_strcat` and `Array.prototype.join`. Only short flat strings pay a copy here.
+        [[nodiscard]] auto share_rope() -> RopePtr {
+            if (m_rope) {
+                return m_rope;
+            } else if (m_data.length() < min_shared_leaf_length) {
+                return make_rope_leaf(m_data);
+            }
+
+            m_rope = make_rope_leaf(std::move(m_data));
+            m_data.clear();
+
+            return m_rope;
+        }
+
+        /// NOTE: For `String.prototype.substring()` etc., this makes a slice viewing this text without copying it. The range must be within this string.
+        [[nodiscard]] auto share_slice(std::size_t offset, std::size_t length) -> RopePtr {
+            flatten_rope();
+
+            return make_rope_slice(share_rope(), offset, length);
+        }
+
         void patch_length_property(const Value& length_key, int length) {
             m_own_properties.emplace_back(PropEntry<Value, Value> {
                 .key = length_key,
@@ -61,6 +271,10 @@ export namespace DerkJS {
             return this;
         }
 
+        [[nodiscard]] auto get_footprint() const noexcept -> std::size_t override {
+            return sizeof(DynamicString) + m_own_properties.capacity() * sizeof(PropEntry<Value, Value>) + m_data.capacity() + ((m_rope) ? m_rope->length : 0);
+        }
+
         [[nodiscard]] auto get_class_name() const noexcept -> std::string override {
             return "string";
         }
@@ -93,7 +307,7 @@ export namespace DerkJS {
             if (key.is_prototype_key()) {
                 return PropertyDescriptor<Value> {key, &m_prototype, this};
             } else if (auto property_entry_it = std::find_if(m_own_properties.begin(), m_own_properties.end(), [&key](const auto& prop) -> bool {
-                return prop.key == key || prop.key.compare_as_object(key);
+                return prop.key.is_same_key(key);
             }); property_entry_it != m_own_properties.end()) {
                 return PropertyDescriptor<Value> {key, &property_entry_it->item, this};
             } else if ((m_flags & std::to_underlying(AttrMask::writable)) && allow_filler) {
@@ -160,19 +374,21 @@ export namespace DerkJS {
 
         /// NOTE: For default printing of objects, etc. to the console (stdout). 
         [[nodiscard]] auto as_string() const -> std::string override {
-            return m_data;
+            return std::string {flat_view()};
         }
 
-        [[nodiscard]] auto opaque_iter() const noexcept -> OpaqueIterator override {
-            return OpaqueIterator {reinterpret_cast<const std::byte*>(m_data.data()), m_data.size() * sizeof(std::string::value_type)};
+        [[nodiscard]] auto opaque_iter() const -> OpaqueIterator override {
+            const auto text = flat_view();
+
+            return OpaqueIterator {reinterpret_cast<const std::byte*>(text.data()), text.size() * sizeof(std::string::value_type)};
         }
 
-        [[nodiscard]] auto operator==(const ObjectBase& other) const noexcept -> bool override {
+        [[nodiscard]] auto operator==(const ObjectBase& other) const -> bool override {
             if (this == &other) {
                 return true;
             }
 
-            OpaqueIterator self_it {reinterpret_cast<const std::byte*>(m_data.data()), m_data.length() * sizeof(std::string::value_type)};
+            OpaqueIterator self_it = opaque_iter();
             OpaqueIterator other_it = other.opaque_iter();
 
             if (self_it.count() != other_it.count()) {
@@ -191,32 +407,37 @@ export namespace DerkJS {
             return true;
         }
 
-        [[nodiscard]] auto operator<(const ObjectBase& other) const noexcept -> bool override {
-            return m_data < other.as_string();
+        [[nodiscard]] auto operator<(const ObjectBase& other) const -> bool override {
+            return flat_view() < other.as_string();
         }
 
-        [[nodiscard]] auto operator>(const ObjectBase& other) const noexcept -> bool override {
-            return m_data > other.as_string();
+        [[nodiscard]] auto operator>(const ObjectBase& other) const -> bool override {
+            return flat_view() > other.as_string();
         }
 
         /// BEGIN StringBase overrides
 
         [[nodiscard]] auto is_empty() const noexcept -> bool override {
-            return m_data.empty();
+            return get_length() == 0;
         }
 
         [[nodiscard]] auto get_length() const noexcept -> int override {
-            return m_data.size();
+            return (m_rope) ? m_rope->length : m_data.size();
         }
 
         void append_front(const std::string& s) override {
+            detach_rope();
+
             std::string old_data = std::move(m_data);
             m_data = s;
             m_data.append_range(old_data);
+            m_hash.reset();
         }
 
         void append_back(const std::string& s) override {
+            detach_rope();
             m_data.append_range(s);
+            m_hash.reset();
         }
 
         /// NOTE: This is for String.prototype.indexOf()
@@ -224,8 +445,25 @@ export namespace DerkJS {
             return -1; // TODO: implement!
         }
 
-        [[nodiscard]] auto as_str_view() const noexcept -> std::string_view override {
-            return std::string_view {m_data.c_str(), m_data.c_str() + m_data.length()};
+        [[nodiscard]] auto as_str_view() const -> std::string_view override {
+            return flat_view();
+        }
+
+        [[nodiscard]] auto get_hash() const -> std::size_t override {
+            if (!m_hash) {
+                m_hash = std::hash<std::string_view> {}(as_str_view());
+            }
+
+            return *m_hash;
         }
     };
+
+    /// NOTE: Gets any value's text as a rope, sharing the text of strings that already are ropes.
+    [[nodiscard]] auto rope_of(Value& value) -> RopePtr {
+        if (auto str_p = dynamic_cast<DynamicString*>(value.to_object()); str_p) {
+            return str_p->share_rope();
+        }
+
+        return make_rope_leaf(value.to_string());
+    }
 }
\ No newline at end of file
@@ -2,10 +2,18 @@ module;
 
 #include <cstddef>
 #include <utility>
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <string_view>
 
+//? NOTE: The opt-in compact layout (see `DERKJS_COMPACT_VALUE` in CMakeLists.txt) packs the payload union right before the tag & flags, so `Value` is 12 bytes instead of 16.
+#ifdef DERKJS_COMPACT_VALUE
+    #define DERKJS_VALUE_LAYOUT [[gnu::packed, gnu::aligned(4)]]
+#else
+    #define DERKJS_VALUE_LAYOUT
+#endif
+
 export module runtime.value;
 
 export import runtime.objects;
@@ -23,7 +31,8 @@ export namespace DerkJS {
         proto_key
     };
 
-    class Value {
+    /// NOTE: In the compact layout, doubles & pointers in the payload may be only 4-byte aligned. Compilers emit unaligned loads & stores for them, which are cheap on x86-64 & ARM64. Never take the address of a payload member!
+    class DERKJS_VALUE_LAYOUT Value {
     public:
         static constexpr auto dud_member_v = '\x00';
 
@@ -218,7 +227,7 @@ export namespace DerkJS {
             return m_tag == ValueTag::num_nan;
         }
 
-        [[nodiscard]] constexpr auto compare_as_object(const Value& other) const noexcept -> bool {
+        [[nodiscard]] constexpr auto compare_as_object(const Value& other) const -> bool {
             if (const auto self_tag = get_tag(), other_tag = other.get_tag(); self_tag != ValueTag::object || other_tag != ValueTag::object) {
                 return false;
             }
@@ -226,7 +235,16 @@ export namespace DerkJS {
             return m_data.obj_p->operator==(*other.m_data.obj_p);
         }
 
-        [[nodiscard]] constexpr auto operator==(const Value& other) const noexcept -> bool {
+        /// NOTE: Compares a stored property key against a lookup key. Interned lookup keys only need a pointer check since every string key stored in an object is canonical, but other keys still compare by content.
+        [[nodiscard]] constexpr auto is_same_key(const Value& key) const -> bool {
+            if (key.get_tag() == ValueTag::object && key.flag<AttrMask::interned>()) {
+                return m_tag == ValueTag::object && m_data.obj_p == key.m_data.obj_p;
+            }
+
+            return *this == key || compare_as_object(key);
+        }
+
+        [[nodiscard]] constexpr auto operator==(const Value& other) const -> bool {
             const auto self_v = (is_reference()) ? deep_clone() : *this;
             const auto other_v = (other.is_reference()) ? other.deep_clone() : other;
 
@@ -256,7 +274,7 @@ export namespace DerkJS {
             return false;
         }
 
-        [[nodiscard]] constexpr auto operator!=(const Value& other) const noexcept -> bool {
+        [[nodiscard]] constexpr auto operator!=(const Value& other) const -> bool {
             return !(this->operator==(other));
         }
 
@@ -533,6 +551,43 @@ export namespace DerkJS {
             }
         }
 
+        /// NOTE: Quickened opcodes call this directly once both tags are known to be `num_i32`. Like JS, an overflowing result becomes a `num_f64`.
+        constexpr void add_i32(int rhs_i32) noexcept {
+            if (int sum_i32 = 0; !__builtin_add_overflow(m_data.i, rhs_i32, &sum_i32)) {
+                m_data.i = sum_i32;
+            } else {
+                m_data.d = static_cast<double>(m_data.i) + rhs_i32;
+                m_tag = ValueTag::num_f64;
+            }
+        }
+
+        /// NOTE: See `add_i32()`.
+        constexpr void sub_i32(int rhs_i32) noexcept {
+            if (int diff_i32 = 0; !__builtin_sub_overflow(m_data.i, rhs_i32, &diff_i32)) {
+                m_data.i = diff_i32;
+            } else {
+                m_data.d = static_cast<double>(m_data.i) - rhs_i32;
+                m_tag = ValueTag::num_f64;
+            }
+        }
+
+        /// NOTE: Unchecked reads for quickened opcodes, which MUST check the tag first.
+        [[nodiscard]] constexpr auto as_i32_unchecked() const noexcept -> int {
+            return m_data.i;
+        }
+
+        [[nodiscard]] constexpr auto as_f64_unchecked() const noexcept -> double {
+            return m_data.d;
+        }
+
+        constexpr void add_f64(double rhs_f64) noexcept {
+            m_data.d += rhs_f64;
+        }
+
+        constexpr void sub_f64(double rhs_f64) noexcept {
+            m_data.d -= rhs_f64;
+        }
+
         [[maybe_unused]] constexpr auto operator+=(const Value& other) noexcept -> Value& {
             const auto lhs_tag = get_tag();
             const auto rhs_tag = other.get_tag();
@@ -541,7 +596,7 @@ export namespace DerkJS {
                 m_data.dud = dud_member_v;
                 m_tag = ValueTag::num_nan;
             } else if (lhs_tag == ValueTag::num_i32) {
-                m_data.i += other.to_num_i32().value();
+                add_i32(other.to_num_i32().value());
             } else if (lhs_tag == ValueTag::num_f64) {
                 m_data.d += other.to_num_f64().value();
             } else if (lhs_tag == ValueTag::val_ref) {
@@ -579,7 +634,7 @@ export namespace DerkJS {
                 m_data.dud = dud_member_v;
                 m_tag = ValueTag::num_nan;
             } else if (lhs_tag == ValueTag::num_i32) {
-                m_data.i -= other.to_num_i32().value();
+                sub_i32(other.to_num_i32().value());
             } else if (lhs_tag == ValueTag::num_f64) {
                 m_data.d -= other.to_num_f64().value();
             } else if (m_tag == ValueTag::val_ref) {
@@ -680,4 +735,77 @@ export namespace DerkJS {
             }
         }
     };
+
+#ifdef DERKJS_COMPACT_VALUE
+    static_assert(sizeof(Value) == 12 && alignof(Value) == 4, "The compact Value layout should be 12 bytes.");
+#else
+    static_assert(sizeof(Value) == 16, "The default Value layout should be 16 bytes.");
+#endif
+
+    /// NOTE: Gives the text of a string property key for `PropShape` transitions. Other kinds of keys yield nothing, which leaves the owning object shapeless.
+    [[nodiscard]] auto shape_key_text(Value key) -> std::optional<std::string_view> {
+        if (auto key_str_p = dynamic_cast<const StringBase*>(key.to_object()); key_str_p) {
+            return key_str_p->as_str_view();
+        }
+
+        return {};
+    }
+
+    /// NOTE: Gives the cached text hash of a string property key for `PropIndex` probes.
+    [[nodiscard]] auto prop_key_hash(Value key) -> std::optional<std::size_t> {
+        if (auto key_str_p = dynamic_cast<const StringBase*>(key.to_object()); key_str_p) {
+            return key_str_p->get_hash();
+        }
+
+        return {};
+    }
+
+    void index_prop_slot(PropPool<Value, Value>& props, PropIndex& index, int slot) {
+        if (auto key_hash = prop_key_hash(props[slot].key); key_hash) {
+            index.insert(*key_hash, slot);
+        }
+    }
+
+    /// NOTE: Indexes the newest entry of `props` for dictionary mode, building the whole index once the pool reaches `PropIndex::dictionary_threshold`. Returns `true` if the object is in dictionary mode.
+    [[maybe_unused]] auto index_last_prop(PropPool<Value, Value>& props, PropIndex& index) -> bool {
+        const int prop_count = props.size();
+
+        if (index.is_active()) {
+            index_prop_slot(props, index, prop_count - 1);
+            return true;
+        } else if (prop_count < PropIndex::dictionary_threshold) {
+            return false;
+        }
+
+        index.activate();
+
+        for (int slot = 0; slot < prop_count; slot++) {
+            index_prop_slot(props, index, slot);
+        }
+
+        return true;
+    }
+
+    /// NOTE: Finds an own property entry by key, probing the dictionary index if there is one. Only string keys are indexed, so other keys still take a linear search.
+    [[nodiscard]] auto find_own_prop(PropPool<Value, Value>& props, const PropIndex& index, const Value& key) -> PropEntry<Value, Value>* {
+        const auto matches_key = [&key](const PropEntry<Value, Value>& prop) -> bool {
+            return prop.key.is_same_key(key);
+        };
+
+        if (index.is_active()) {
+            if (auto key_hash = prop_key_hash(key); key_hash) {
+                const int slot = index.find_slot(*key_hash, [&props, &matches_key](int candidate_slot) -> bool {
+                    return matches_key(props[candidate_slot]);
+                });
+
+                return (slot != -1) ? &props[slot] : nullptr;
+            }
+        }
+
+        if (auto prop_it = std::find_if(props.begin(), props.end(), matches_key); prop_it != props.end()) {
+            return &*prop_it;
+        }
+
+        return nullptr;
+    }
 }
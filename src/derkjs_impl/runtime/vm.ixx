@@ -3,7 +3,14 @@ module;
 #include <cstdint>
 #include <utility>
 #include <algorithm>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
+#include <flat_map>
 
 export module runtime.vm;
 
@@ -12,6 +19,14 @@ import runtime.bytecode;
 export import runtime.op_handlers;
 
 namespace DerkJS {
+    /// NOTE: How far `VM::run_slice()` got: `running` has more work right away, but `waiting` only has timers due later.
+    export enum class SliceStatus : uint8_t {
+        running,
+        waiting,
+        done,
+        failed
+    };
+
     /**
      * @brief Provides the general bytecode VM type.
      */
@@ -20,10 +35,80 @@ namespace DerkJS {
         /// NOTE: Only modify this from DerkJS native functions.
         ExternVMCtx m_ctx;
 
+    private:
+        /// NOTE: Maps top-level variable names to their local slots, for `call()`.
+        std::flat_map<std::string, int16_t, std::less<>> m_global_slots;
+
+        /// NOTE: The top-level frame & its `globalThis`, which are restored after the top-level code returns for later calls & jobs.
+        CallFrame m_global_frame;
+        Value m_global_this;
+
+        /// NOTE: The stack top just past the top-level variables once the VM is warm, or -1 before that.
+        int32_t m_global_top;
+
+        /// NOTE: Whether a job callback is suspended mid-way by its time slice.
+        bool m_job_running;
+
+        /// NOTE: Puts back the top-level frame & its variables, which the top-level return had left in place except for its result over `globalThis`.
+        void restore_globals() {
+            int16_t global_extent = 0;
+
+            for (const auto& [global_name, global_slot] : m_global_slots) {
+                global_extent = std::max(global_extent, global_slot);
+            }
+
+            m_ctx.stack[0] = m_global_this;
+            m_ctx.frames.emplace_back(m_global_frame);
+            m_ctx.rsbp = m_global_frame.m_callee_sbp;
+            m_ctx.rsp = m_ctx.rsbp + global_extent;
+            m_global_top = m_ctx.rsp;
+        }
+
+        /// NOTE: Calls a job's callback above the top-level variables as `callback.call(globalThis)`. Its dispatch is the host's, so it may be suspended like the top-level code.
+        void start_job(ObjectBase<Value>* callback_p) {
+            m_ctx.stack[++m_ctx.rsp] = m_global_this;
+            m_ctx.stack[++m_ctx.rsp] = Value {callback_p};
+            m_ctx.ending_frame_depth = m_ctx.frames.size();
+            m_ctx.slice_frame_depth = m_ctx.ending_frame_depth;
+            m_ctx.status = VMErrcode::pending;
+
+            if (!callback_p->call(&m_ctx, 0, true)) {
+                if (m_ctx.status != VMErrcode::stack_overflow) {
+                    m_ctx.status = VMErrcode::bad_operation;
+                }
+
+                return;
+            }
+
+            //? NOTE: Native callbacks already returned, but bytecode ones just pushed their frame.
+            if (m_ctx.frames.size() > m_ctx.ending_frame_depth) {
+                dispatch_op(m_ctx);
+            }
+        }
+
+        void finish_job() {
+            m_ctx.ending_frame_depth = 0;
+            m_ctx.slice_frame_depth = 0;
+            m_ctx.rsbp = m_global_frame.m_callee_sbp;
+            m_ctx.rsp = m_global_top;
+            m_ctx.status = VMErrcode::ok;
+            m_job_running = false;
+        }
+
+    public:
         explicit VM(Program& prgm, std::size_t stack_length_limit, std::size_t call_frame_limit, std::size_t gc_threshold, void* lexer_ptr, void* parser_ptr, void* compile_state_ptr, ExternVMCtx::compile_snippet_fn compile_proc_ptr)
-        : m_ctx {prgm, stack_length_limit, call_frame_limit, gc_threshold, lexer_ptr, parser_ptr, compile_state_ptr, compile_proc_ptr} {
+        : m_ctx {prgm, stack_length_limit, call_frame_limit, gc_threshold, lexer_ptr, parser_ptr, compile_state_ptr, compile_proc_ptr}, m_global_slots {}, m_global_frame {}, m_global_this {}, m_global_top {-1}, m_job_running {false} {
             //? Mark all contiguous object slots in the fresh heap as permanently tenured to prevent GC sweeps of built-ins or string constants.
             m_ctx.heap.tenure_items();
+
+            if (!m_ctx.frames.empty()) {
+                m_global_frame = m_ctx.frames.front();
+                m_global_this = m_ctx.stack[0];
+            }
+
+            for (const auto& [global_name, global_loc] : prgm.globals) {
+                m_global_slots[global_name] = global_loc.n;
+            }
         }
 
         [[nodiscard]] auto peek_final_result() const noexcept -> const Value& {
@@ -38,8 +123,146 @@ namespace DerkJS {
             return Value {m_ctx.current_error};
         }
 
+        /// NOTE: Makes the VM yield to the host after this many safepoints (backward jumps, calls, & finished jobs) per `run_slice()`, or never for 0.
+        void set_time_slice(int32_t slice_budget) noexcept {
+            m_ctx.slice_budget = std::max(slice_budget, 0);
+        }
+
+        [[nodiscard]] auto get_profiler() noexcept -> OpProfiler& {
+            return m_ctx.profiler;
+        }
+
+        void set_output_policy(FlushPolicy policy, std::size_t flush_threshold) noexcept {
+            m_ctx.console.set_policy(policy, flush_threshold);
+        }
+
+        /// NOTE: Writes out any buffered console output, e.g before the host prints its own messages.
+        void flush_output() {
+            m_ctx.console.flush();
+        }
+
+        /// NOTE: Prints the GC's stats & heap census to stderr, after any buffered output.
+        void dump_gc_stats() {
+            m_ctx.console.flush();
+            m_ctx.gc.print_report(m_ctx.heap);
+        }
+
+        /// NOTE: When the earliest timer is due, if any. Hosts can sleep until then after `SliceStatus::waiting`.
+        [[nodiscard]] auto next_wake_time() const noexcept -> std::optional<std::chrono::steady_clock::time_point> {
+            return m_ctx.next_timer_due();
+        }
+
         inline void run() {
             return dispatch_op(m_ctx);
         }
+
+        /**
+         * @brief Runs the top-level code like `run()`, but then keeps its frame & variables for later `call()`s. The objects surviving the top-level code become tenured, so each call's garbage resets back to just them.
+         * @return Whether the top-level code finished OK.
+         */
+        [[nodiscard]] auto run_persistent() -> bool {
+            if (m_ctx.frames.empty()) {
+                return false;
+            }
+
+            run();
+
+            if (m_ctx.status != VMErrcode::ok) {
+                return false;
+            }
+
+            restore_globals();
+
+            m_ctx.collect_young({});
+            m_ctx.heap.tenure_items();
+
+            return true;
+        }
+
+        /**
+         * @brief Runs the script for up to one time slice: first the top-level code, and then the queued microtasks & due timers. Suspended code resumes on the next call.
+         * @return `running` if the slice ran out, `waiting` if only later timers are left, `done` once no jobs are left, or `failed` on any error (see `peek_status()`).
+         */
+        [[nodiscard]] auto run_slice() -> SliceStatus {
+            m_ctx.dispatch_allowance = m_ctx.slice_budget;
+
+            if (m_global_top < 0) {
+                if (m_ctx.frames.empty()) {
+                    return SliceStatus::failed;
+                }
+
+                if (m_ctx.status == VMErrcode::suspended) {
+                    m_ctx.status = VMErrcode::pending;
+                }
+
+                run();
+
+                if (m_ctx.status == VMErrcode::suspended) {
+                    return SliceStatus::running;
+                } else if (m_ctx.status != VMErrcode::ok) {
+                    return SliceStatus::failed;
+                }
+
+                restore_globals();
+            }
+
+            for (;;) {
+                if (m_job_running) {
+                    m_ctx.status = VMErrcode::pending;
+                    dispatch_op(m_ctx);
+                } else if (auto job_p = m_ctx.take_ready_job(std::chrono::steady_clock::now()); job_p) {
+                    start_job(job_p);
+                } else {
+                    return (m_ctx.next_timer_due()) ? SliceStatus::waiting : SliceStatus::done;
+                }
+
+                if (m_ctx.status == VMErrcode::suspended) {
+                    m_job_running = true;
+                    return SliceStatus::running;
+                } else if (m_ctx.status != VMErrcode::ok && m_ctx.status != VMErrcode::pending) {
+                    return SliceStatus::failed;
+                }
+
+                finish_job();
+
+                //? NOTE: Jobs count as safepoints too, so chains of short jobs still yield.
+                if (m_ctx.slice_budget > 0 && --m_ctx.dispatch_allowance <= 0) {
+                    return SliceStatus::running;
+                }
+            }
+        }
+
+        /**
+         * @brief Calls a top-level script function of a VM warmed up by `run_persistent()`, reusing its stack & frames. The previous call's unreachable objects are reaped first.
+         * @return The function's result, which (if an object) is only valid until the next call. Any failure gives nothing, leaving its status & any uncaught error to peek at.
+         */
+        [[nodiscard]] auto call(std::string_view function_name, std::span<const Value> args) -> std::optional<Value> {
+            auto global_slot_it = m_global_slots.find(function_name);
+
+            if (m_global_top < 0 || global_slot_it == m_global_slots.end()) {
+                return {};
+            }
+
+            m_ctx.status = VMErrcode::ok;
+            m_ctx.current_error = nullptr;
+            m_ctx.collect_young(args);
+
+            auto callee_p = m_ctx.stack[m_ctx.rsbp + global_slot_it->second].to_object();
+            auto result = call_reentrant(m_ctx, callee_p, m_global_this, args);
+
+            if (!result) {
+                //? NOTE: Errors may have left the callee's frames, so unwind back to the top-level.
+                m_ctx.frames.resize(1);
+                m_ctx.ending_frame_depth = 0;
+                m_ctx.rsbp = m_global_frame.m_callee_sbp;
+                m_ctx.rsp = m_global_top;
+
+                if (m_ctx.status == VMErrcode::ok || m_ctx.status == VMErrcode::pending) {
+                    m_ctx.status = VMErrcode::bad_operation;
+                }
+            }
+
+            return result;
+        }
     };
 }
@@ -1,7 +1,11 @@
+#include <charconv>
+#include <algorithm>
 #include <string>
 #include <string_view>
 #include <array>
+#include <vector>
 #include <variant>
+#include <optional>
 #include <print>
 #include <iostream>
 
@@ -10,48 +14,41 @@ import derkjs_impl;
 constexpr std::string_view fancy_name = " _              __\n"
                                         "| \\ _   _|    |(_\n"
                                         "|_/(/_ | |< \\_|__)\n";
-constexpr std::size_t derkjs_gc_threshold = 144000; // ~ 2K heap objects
-constexpr int derkjs_heap_count = 4096;
-
-int main(int argc, char* argv[]) {
-    using namespace DerkJS;
-    namespace DerkJSNatives = DerkJS::Runtime::Intrinsics;
-
-    if (argc < 2 || argc > 3) {
-        std::println(std::cerr, "usage: ./derkjs [-v | [-d | -r] <script name>]");
-        return 1;
+constexpr std::size_t derkjs_gc_threshold = 144000; // default heap bytes before a GC cycle, see `--gc-threshold`
+constexpr int derkjs_heap_count = 4096; // default initial heap slots, see `--heap-slots`
+
+/// NOTE: Set by `--flush`, or else each driver picks its default by whether stdout is a terminal. Isolates' drivers are set up apart from `main()`'s, so `setup_driver()` applies this to each of them.
+std::optional<DerkJS::FlushPolicy> derkjs_flush_policy;
+
+/// NOTE: Parses one `--name=value` tunable or `--gc-stats`, which go before the mode flag.
+[[nodiscard]] auto parse_tunable(std::string_view option, std::size_t& gc_threshold, int& heap_slot_count, bool& show_gc_stats) -> bool {
+    constexpr std::string_view gc_threshold_prefix = "--gc-threshold=";
+    constexpr std::string_view heap_slots_prefix = "--heap-slots=";
+
+    if (option == "--gc-stats") {
+        show_gc_stats = true;
+        return true;
+    } else if (option == "--flush=line") {
+        derkjs_flush_policy = DerkJS::FlushPolicy::by_newline;
+        return true;
+    } else if (option == "--flush=size") {
+        derkjs_flush_policy = DerkJS::FlushPolicy::by_size;
+        return true;
+    } else if (option.starts_with(gc_threshold_prefix)) {
+        option.remove_prefix(gc_threshold_prefix.size());
+        return std::from_chars(option.data(), option.data() + option.size(), gc_threshold).ec == std::errc {} && gc_threshold > 0;
+    } else if (option.starts_with(heap_slots_prefix)) {
+        option.remove_prefix(heap_slots_prefix.size());
+        return std::from_chars(option.data(), option.data() + option.size(), heap_slot_count).ec == std::errc {} && heap_slot_count > 0;
     }
 
-    Core::Driver driver {
-        Core::DriverInfo {
-            .name = fancy_name,
-            .author = "DrkWithT (GitHub)",
-            .version_major = 0,
-            .version_minor = 6,
-            .version_patch = 1
-        },
-        derkjs_heap_count // increase object count limit for VM if needed
-    };
-
-    std::string source_path;
-    std::string_view arg_1 = argv[1];
+    return false;
+}
 
-    if (arg_1 == "-h") {
-        std::println(std::cerr, "usage: ./derkjs [-h | -v | [-d | -r] <script name>]\n\t-h: show help\n\t-v: show version & author");
-        return 0;
-    } else if (arg_1 == "-v") {
-        const auto& [app_name, author_name, major, minor, patch] = driver.get_info();
-        std::println("\x1b[1;93m{}\x1b[0m\nv{}.{}.{}\tBy: {}", app_name, major, minor, patch, author_name);
-        return 0;
-    } else if (arg_1 == "-d") {
-        source_path = argv[2];
-        driver.enable_bc_dump(true);
-    } else if (arg_1 == "-r") {
-        source_path = argv[2];
-    } else {
-        std::println(std::cerr, "usage: ./derkjs [-h | -v | [-d | -r] <script name>]\n\t-h: show help\n\t-v: show version & author");
-        return 1;
-    }
+/// NOTE: Registers the lexicals, emitters, & natives of a driver. Isolates each call this on their own thread, so every call makes new native objects.
+void setup_driver(DerkJS::Core::Driver& driver) {
+    using namespace DerkJS;
+    namespace DerkJSNatives = DerkJS::Runtime::Intrinsics;
 
     /// 2. Register keywords, operators, etc. for parser's lexer. This makes the lexer's configuration flexible. ///
     driver.add_js_lexical("var", TokenTag::keyword_var);
@@ -330,6 +327,106 @@ int main(int argc, char* argv[]) {
                 driver.get_length_key_str_p(),
                 Value {1}
             )
+        },
+        Core::NativePropertyStub {
+            .name_str = "forEach",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_for_each,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "map",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_map,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "filter",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_filter,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "some",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_some,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "reduce",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_reduce,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "indexOf",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_index_of,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "shift",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_shift,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {0}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "unshift",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_unshift,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "splice",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_splice,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {2}
+            )
+        },
+        Core::NativePropertyStub {
+            .name_str = "sort",
+            .item = std::make_unique<NativeFunction>(
+                function_prototype_p,
+                DerkJSNatives::native_array_sort,
+                function_prototype_p,
+                driver.get_length_key_str_p(),
+                Value {1}
+            )
         }
     };
 
@@ -440,6 +537,24 @@ int main(int argc, char* argv[]) {
         Value {0}
     );
 
+    auto native_flush_fn_p = driver.add_native_object<NativeFunction>(
+        "",
+        function_prototype_p,
+        DerkJSNatives::native_flush,
+        function_prototype_p,
+        driver.get_length_key_str_p(),
+        Value {0}
+    );
+
+    auto dump_gc_stats_fn_p = driver.add_native_object<NativeFunction>(
+        "",
+        function_prototype_p,
+        DerkJSNatives::native_dump_gc_stats,
+        function_prototype_p,
+        driver.get_length_key_str_p(),
+        Value {0}
+    );
+
     auto native_to_int32_p = driver.add_native_object<NativeFunction>(
         "",
         function_prototype_p,
@@ -449,6 +564,24 @@ int main(int argc, char* argv[]) {
         Value {1}
     );
 
+    auto queue_microtask_fn_p = driver.add_native_object<NativeFunction>(
+        "",
+        function_prototype_p,
+        DerkJSNatives::native_queue_microtask,
+        function_prototype_p,
+        driver.get_length_key_str_p(),
+        Value {1}
+    );
+
+    auto set_timeout_fn_p = driver.add_native_object<NativeFunction>(
+        "",
+        function_prototype_p,
+        DerkJSNatives::native_set_timeout,
+        function_prototype_p,
+        driver.get_length_key_str_p(),
+        Value {2}
+    );
+
     /// Patch prototypes & alias built-in globals ///
 
     driver.patch_native_object(object_prototype_p, string_prototype_p, std::to_array(std::move(object_prototype_props)));
@@ -479,9 +612,128 @@ int main(int argc, char* argv[]) {
     driver.add_native_object_alias("parseFloat", parse_float_fn_p);
     driver.add_native_object_alias("nativePrint", native_print_fn_p);
     driver.add_native_object_alias("nativeReadLine", native_read_line_fn_p);
+    driver.add_native_object_alias("nativeFlush", native_flush_fn_p);
+    driver.add_native_object_alias("dumpGCStats", dump_gc_stats_fn_p);
     driver.add_native_object_alias("toInt32", native_to_int32_p);
+    driver.add_native_object_alias("queueMicrotask", queue_microtask_fn_p);
+    driver.add_native_object_alias("setTimeout", set_timeout_fn_p);
+
+    if (derkjs_flush_policy) {
+        driver.set_output_policy(*derkjs_flush_policy);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    using namespace DerkJS;
+    namespace DerkJSNatives = DerkJS::Runtime::Intrinsics;
+
+    std::size_t gc_threshold = derkjs_gc_threshold;
+    int heap_slot_count = derkjs_heap_count;
+    bool show_gc_stats = false;
+
+    //? NOTE: Skipping the tunables keeps the mode flag & its arguments at their usual places.
+    while (argc > 1 && std::string_view {argv[1]}.starts_with("--")) {
+        if (!parse_tunable(argv[1], gc_threshold, heap_slot_count, show_gc_stats)) {
+            std::println(std::cerr, "Invalid tunable '{}', see -h for usage.", argv[1]);
+            return 1;
+        }
+
+        ++argv;
+        --argc;
+    }
+
+    if (argc < 2 || (argc > 4 && std::string_view {argv[1]} != "-m")) {
+        std::println(std::cerr, "usage: ./derkjs [tunables...] [-v | [-d | -p | -r] <script name> [snapshot name] | -c <script name> <cache name> | -b <cache name> | -s <snapshot name> | -j <run count> <script name> | -m <script names...>]");
+        return 1;
+    }
+
+    Core::Driver driver {
+        Core::DriverInfo {
+            .name = fancy_name,
+            .author = "DrkWithT (GitHub)",
+            .version_major = 0,
+            .version_minor = 6,
+            .version_patch = 1
+        },
+        heap_slot_count // initial heap slot count, which grows as needed
+    };
+
+    std::string source_path;
+    std::string cache_path;
+    std::string snapshot_path;
+    std::vector<std::string> sliced_paths;
+    std::size_t isolate_run_count = 0;
+    std::string_view arg_1 = argv[1];
+
+    if (arg_1 == "-h") {
+        std::println(std::cerr, "usage: ./derkjs [tunables...] [-h | -v | [-d | -p | -r] <script name> [snapshot name] | -c <script name> <cache name> | -b <cache name> | -s <snapshot name> | -j <run count> <script name> | -m <script names...>]\n\t-h: show help\n\t-v: show version & author\n\t-p: dump bytecode, then run script & report its hot opcodes & functions\n\t-c: compile script to a bytecode cache\n\t-b: run a bytecode cache\n\t-s: compile the built-in prelude to a snapshot, which -d, -p, & -r can take after the script\n\t-j: compile script once, then run it that many times in isolates across threads\n\t-m: run scripts in isolates interleaved by time slices on one thread\ntunables:\n\t--gc-threshold=<bytes>: heap bytes which start a GC cycle\n\t--heap-slots=<count>: initial heap slot count, which grows as needed\n\t--gc-stats: print GC stats & a heap census after the script\n\t--flush=<line | size>: write console output per line, or only once buffered output is large (defaults to per line on terminals)");
+        return 0;
+    } else if (arg_1 == "-v") {
+        const auto& [app_name, author_name, major, minor, patch] = driver.get_info();
+        std::println("\x1b[1;93m{}\x1b[0m\nv{}.{}.{}\tBy: {}", app_name, major, minor, patch, author_name);
+        return 0;
+    } else if (arg_1 == "-d") {
+        source_path = argv[2];
+        driver.enable_bc_dump(true);
+    } else if (arg_1 == "-p") {
+        source_path = argv[2];
+        driver.enable_bc_dump(true);
+        driver.enable_profile_report(true);
+    } else if (arg_1 == "-r") {
+        source_path = argv[2];
+    } else if (arg_1 == "-s" && argc == 3) {
+        snapshot_path = argv[2];
+    } else if (arg_1 == "-c" && argc == 4) {
+        source_path = argv[2];
+        cache_path = argv[3];
+    } else if (arg_1 == "-b" && argc == 3) {
+        cache_path = argv[2];
+    } else if (std::string_view run_count_arg = (argc == 4) ? argv[2] : ""; arg_1 == "-j" && std::from_chars(run_count_arg.data(), run_count_arg.data() + run_count_arg.size(), isolate_run_count).ec == std::errc {} && isolate_run_count > 0) {
+        source_path = argv[3];
+    } else if (arg_1 == "-m" && argc >= 3) {
+        sliced_paths.assign(argv + 2, argv + argc);
+    } else {
+        std::println(std::cerr, "usage: ./derkjs [tunables...] [-h | -v | [-d | -p | -r] <script name> [snapshot name] | -c <script name> <cache name> | -b <cache name> | -s <snapshot name> | -j <run count> <script name> | -m <script names...>]\n\t-h: show help\n\t-v: show version & author\n\t-p: dump bytecode, then run script & report its hot opcodes & functions\n\t-c: compile script to a bytecode cache\n\t-b: run a bytecode cache\n\t-s: compile the built-in prelude to a snapshot, which -d, -p, & -r can take after the script\n\t-j: compile script once, then run it that many times in isolates across threads\n\t-m: run scripts in isolates interleaved by time slices on one thread\ntunables:\n\t--gc-threshold=<bytes>: heap bytes which start a GC cycle\n\t--heap-slots=<count>: initial heap slot count, which grows as needed\n\t--gc-stats: print GC stats & a heap census after the script\n\t--flush=<line | size>: write console output per line, or only once buffered output is large (defaults to per line on terminals)");
+        return 1;
+    }
+
+    if ((arg_1 == "-d" || arg_1 == "-p" || arg_1 == "-r") && argc == 4) {
+        driver.use_prelude_snapshot(argv[3]);
+    }
+
+    if (isolate_run_count > 0) {
+        Core::IsolatePool isolate_pool {driver.get_info(), setup_driver, heap_slot_count};
+        const auto run_statuses = isolate_pool.run(isolate_pool.compile(source_path), isolate_run_count, gc_threshold);
+
+        return (std::ranges::all_of(run_statuses, [](int status) noexcept { return status == 0; })) ? 0 : 1;
+    }
+
+    if (!sliced_paths.empty()) {
+        Core::IsolateScheduler isolate_scheduler {driver.get_info(), setup_driver, heap_slot_count};
+
+        for (const auto& sliced_path : sliced_paths) {
+            if (!isolate_scheduler.add(sliced_path, gc_threshold)) {
+                return 1;
+            }
+        }
+
+        const auto run_statuses = isolate_scheduler.run_all();
+
+        return (std::ranges::all_of(run_statuses, [](int status) noexcept { return status == 0; })) ? 0 : 1;
+    }
+
+    setup_driver(driver);
+    driver.enable_gc_report(show_gc_stats);
 
     /// 6. Run the script after all configuration. ///
 
-    return driver.run(source_path, derkjs_gc_threshold);
+    if (!snapshot_path.empty()) {
+        return driver.emit_prelude_snapshot(snapshot_path);
+    } else if (!cache_path.empty() && source_path.empty()) {
+        return driver.run_cached(cache_path, gc_threshold);
+    } else if (!cache_path.empty()) {
+        return driver.emit_cache(source_path, cache_path);
+    }
+
+    return driver.run(source_path, gc_threshold);
 }
@@ -0,0 +1,42 @@
+/*
+    fused_ops.js
+    Tests that fused compare & jump, local & constant arithmetic, and constant key accesses behave like their unfused sequences.
+*/
+
+var point = {x: 3, y: 4};
+var sum = 0;
+var diff = 0;
+var hits = 0;
+
+for (var i = 0; i < 10; i = i + 1) {
+    sum = sum + 2;
+    diff = diff - 1;
+
+    if (i >= 5) {
+        hits = hits + point.x;
+    }
+
+    if (i === 9) {
+        hits = hits + point.y;
+    }
+}
+
+var ok = 0;
+
+if (sum === 20 && diff === -10) {
+    ++ok;
+} else {
+    console.log("Unexpected sum / diff:", sum, diff);
+}
+
+if (hits === 19) {
+    ++ok;
+} else {
+    console.log("Unexpected hits:", hits);
+}
+
+if (ok === 2) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,75 @@
+/*
+    optimized_code.js
+    Tests that folded constants, threaded jumps, and removed dead code behave like the unoptimized bytecode.
+*/
+
+function early(n) {
+    if (n > 2) {
+        return 2 * 3 + 1;
+    } else {
+        return n - 1;
+    }
+
+    return 100;
+}
+
+function fails() {
+    throw new Error("fails");
+    return 1;
+}
+
+var ok = 0;
+var folded = (1 + 2) * 3 - 8 / 4;
+
+if (folded === 7) {
+    ++ok;
+} else {
+    console.log("Unexpected folded value:", folded);
+}
+
+if (early(5) === 7 && early(1) === 0) {
+    ++ok;
+} else {
+    console.log("Unexpected early returns:", early(5), early(1));
+}
+
+var steps = 0;
+
+for (var i = 0; i < 10; i = i + 1) {
+    if (i % 2 === 0) {
+        continue;
+    }
+
+    if (i > 7) {
+        break;
+    }
+
+    steps = steps + 1;
+}
+
+if (steps === 4) {
+    ++ok;
+} else {
+    console.log("Unexpected loop steps:", steps);
+}
+
+var caught = 0;
+
+try {
+    fails();
+    caught = 100;
+} catch (err) {
+    caught = caught + 1;
+}
+
+if (caught === 1) {
+    ++ok;
+} else {
+    console.log("Unexpected catch result:", caught);
+}
+
+if (ok === 4) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
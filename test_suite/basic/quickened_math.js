@@ -0,0 +1,45 @@
+/*
+    quickened_math.js
+    Tests that arithmetic & comparison sites still compute correctly after switching operand types, plus i32 overflow promotion.
+*/
+
+function addUp(a, b) {
+    return a + b;
+}
+
+function takeAway(a, b) {
+    return a - b;
+}
+
+var ok = 0;
+var intTotal = 0;
+
+for (var i = 0; i < 50; i = i + 1) {
+    intTotal = addUp(intTotal, i);
+}
+
+if (intTotal === 1225 && addUp(0.5, 0.25) === 0.75 && addUp(1, 2) === 3) {
+    ++ok;
+} else {
+    console.log("Unexpected add results:", intTotal, addUp(0.5, 0.25), addUp(1, 2));
+}
+
+if (takeAway(10, 4) === 6 && takeAway(2.5, 0.5) === 2.0 && takeAway(7, 10) === -3) {
+    ++ok;
+} else {
+    console.log("Unexpected subtract results:", takeAway(10, 4), takeAway(2.5, 0.5), takeAway(7, 10));
+}
+
+var big = 2147483647;
+
+if (addUp(big, 1) === 2147483648.0) {
+    ++ok;
+} else {
+    console.log("Unexpected overflow result:", addUp(big, 1));
+}
+
+if (ok === 3) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,27 @@
+// Test tail calls reusing frames for deep recursion, and non-tail recursion growing the VM stack.
+
+var countDown = function(n, acc) {
+    if (n === 0) {
+        return acc;
+    }
+
+    return countDown(n - 1, acc + 1);
+};
+
+var depthOf = function(n) {
+    if (n === 0) {
+        return 0;
+    }
+
+    return 1 + depthOf(n - 1);
+};
+
+var tailCount = countDown(100000, 0);
+var depth = depthOf(20000);
+
+if (tailCount === 100000 && depth === 20000) {
+    console.log("PASS");
+} else {
+    console.log("Results:", tailCount, depth);
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,29 @@
+/*
+    arrays_numeric.js
+    Array numeric loops: filling, summing, & scaling number arrays.
+*/
+
+var beginMs = Date.now();
+var nums = [];
+
+for (var i = 0; i < 5000; ++i) {
+    nums.push(i);
+}
+
+var total = 0;
+
+for (var round = 0; round < 4; ++round) {
+    for (var j = 0; j < nums.length; ++j) {
+        nums[j] = nums[j] + 1;
+        total = total + nums[j];
+    }
+}
+
+var elapsedMs = Date.now() - beginMs;
+
+// Each round adds 1 to all 5000 items, so round r sums (0 + ... + 4999) + 5000 * (r + 1).
+if (total !== 12497500 * 4 + 5000 * 10) {
+    throw new Error("Unexpected array total.");
+}
+
+console.log("BENCH_MS", elapsedMs);
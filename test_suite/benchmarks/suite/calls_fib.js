@@ -0,0 +1,22 @@
+/*
+    calls_fib.js
+    Call-heavy: recursive fibonacci.
+*/
+
+function fib(n) {
+    if (n < 2) {
+        return n;
+    }
+
+    return fib(n - 1) + fib(n - 2);
+}
+
+var beginMs = Date.now();
+var ans = fib(25);
+var elapsedMs = Date.now() - beginMs;
+
+if (ans !== 75025) {
+    throw new Error("Unexpected fib(25) result.");
+}
+
+console.log("BENCH_MS", elapsedMs);
@@ -0,0 +1,27 @@
+/*
+    closures_make.js
+    Closure creation: making & calling a fresh capturing function per iteration.
+*/
+
+function makeAdder(base) {
+    return function (n) {
+        return base + n;
+    };
+}
+
+var beginMs = Date.now();
+var total = 0;
+
+for (var i = 0; i < 5000; ++i) {
+    var addI = makeAdder(i);
+
+    total = total + addI(1);
+}
+
+var elapsedMs = Date.now() - beginMs;
+
+if (total !== 12502500) {
+    throw new Error("Unexpected closure total.");
+}
+
+console.log("BENCH_MS", elapsedMs);
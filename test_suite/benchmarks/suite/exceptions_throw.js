@@ -0,0 +1,31 @@
+/*
+    exceptions_throw.js
+    Exception throw & catch across a call.
+*/
+
+function failIfOdd(n) {
+    if (n % 2 === 1) {
+        throw new Error("odd");
+    }
+
+    return n;
+}
+
+var beginMs = Date.now();
+var caught = 0;
+
+for (var i = 0; i < 4000; ++i) {
+    try {
+        failIfOdd(i);
+    } catch (err) {
+        ++caught;
+    }
+}
+
+var elapsedMs = Date.now() - beginMs;
+
+if (caught !== 2000) {
+    throw new Error("Unexpected count of caught errors.");
+}
+
+console.log("BENCH_MS", elapsedMs);
@@ -0,0 +1,31 @@
+/*
+    gc_churn.js
+    GC churn: many short-lived objects & arrays, with a few kept alive.
+*/
+
+var beginMs = Date.now();
+var kept = [];
+var total = 0;
+
+for (var i = 0; i < 20000; ++i) {
+    var temp = {id: i, tags: [i, i + 1]};
+
+    total = total + temp.tags[1] - temp.id;
+
+    if (i % 1000 === 0) {
+        kept.push(temp);
+    }
+}
+
+var elapsedMs = Date.now() - beginMs;
+var keptIds = 0;
+
+for (var k = 0; k < kept.length; ++k) {
+    keptIds = keptIds + kept[k].id + kept[k].tags[1] - kept[k].tags[0];
+}
+
+if (total !== 20000 || kept.length !== 20 || keptIds !== 190020) {
+    throw new Error("Unexpected churn results.");
+}
+
+console.log("BENCH_MS", elapsedMs);
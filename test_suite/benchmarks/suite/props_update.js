@@ -0,0 +1,32 @@
+/*
+    props_update.js
+    Property-heavy: repeated field reads & updates on a few objects.
+*/
+
+var points = [];
+
+for (var i = 0; i < 16; ++i) {
+    points.push({x: i, y: 0, dx: 1, dy: 2});
+}
+
+var beginMs = Date.now();
+
+for (var step = 0; step < 20000; ++step) {
+    var p = points[step % 16];
+
+    p.x = p.x + p.dx;
+    p.y = p.y + p.dy;
+}
+
+var elapsedMs = Date.now() - beginMs;
+var sumY = 0;
+
+for (var j = 0; j < 16; ++j) {
+    sumY = sumY + points[j].y;
+}
+
+if (sumY !== 40000) {
+    throw new Error("Unexpected sum of point updates.");
+}
+
+console.log("BENCH_MS", elapsedMs);
@@ -0,0 +1,20 @@
+/*
+    strings_build.js
+    String-building: appending many small pieces, then reading the result.
+*/
+
+var beginMs = Date.now();
+var text = "";
+
+for (var i = 0; i < 5000; ++i) {
+    text = text + "ab";
+}
+
+var checkCode = text.charCodeAt(9999);
+var elapsedMs = Date.now() - beginMs;
+
+if (text.length !== 10000 || checkCode !== 98) {
+    throw new Error("Unexpected built string.");
+}
+
+console.log("BENCH_MS", elapsedMs);
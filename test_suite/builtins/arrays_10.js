@@ -0,0 +1,45 @@
+// Test Array.prototype.reduce, indexOf, shift, unshift, splice, and sort:
+
+var ok = 0;
+var nums = [4, 1, 3];
+
+var total = nums.reduce(function (acc, item, index, items) { return acc + item; }, 10);
+
+if (total === 18 && nums.indexOf(3) === 2 && nums.indexOf(7) === -1) {
+    ++ok;
+} else {
+    console.log("Unexpected reduce / indexOf results:", total, nums.indexOf(3));
+}
+
+var first = nums.shift();
+var newLength = nums.unshift(9, 8);
+
+if (first === 4 && newLength === 4 && nums.join() === "9,8,1,3") {
+    ++ok;
+} else {
+    console.log("Unexpected shift / unshift results:", first, newLength, nums.join());
+}
+
+var removed = nums.splice(1, 2, 5);
+
+if (removed.join() === "8,1" && nums.join() === "9,5,3" && nums.length === 3) {
+    ++ok;
+} else {
+    console.log("Unexpected splice results:", removed.join(), nums.join());
+}
+
+var ascending = [10, 2, 33, 4].sort(function (a, b) { return a - b; });
+var byLength = ["ccc", "a", "bb"].sort(function (a, b) { return a.length - b.length; });
+var byText = [10, 2, 33, 4].sort();
+
+if (ascending.join() === "2,4,10,33" && byLength.join() === "a,bb,ccc" && byText.join() === "10,2,33,4") {
+    ++ok;
+} else {
+    console.log("Unexpected sort results:", ascending.join(), byLength.join(), byText.join());
+}
+
+if (ok === 4) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
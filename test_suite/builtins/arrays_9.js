@@ -0,0 +1,34 @@
+// Test Array.prototype.join() & concat() on packed numeric and mixed arrays:
+
+var ok = 0;
+var smis = [1, 2, 3];
+var mixed = ["a", 2, "c"];
+
+if (smis.join("-") === "1-2-3" && mixed.join() === "a,2,c") {
+    ++ok;
+} else {
+    console.log("Unexpected joins:", smis.join("-"), mixed.join());
+}
+
+var both = [].concat(smis, mixed, 4);
+
+if (both.length === 7 && both[3] === "a" && both[6] === 4) {
+    ++ok;
+} else {
+    console.log("Unexpected concat result:", both.length, both[3], both[6]);
+}
+
+var grown = [5, 6];
+grown.length = 4;
+
+if (grown.length === 4 && grown[3] === undefined && grown.join() === "5,6,,") {
+    ++ok;
+} else {
+    console.log("Unexpected grown array:", grown.length, grown.join());
+}
+
+if (ok === 3) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
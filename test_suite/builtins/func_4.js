@@ -0,0 +1,36 @@
+// Test repeated Function() snippets, which reuse cached compilations:
+
+var ok = 0;
+var total = 0;
+var prevFn = undefined;
+var distinctCount = 0;
+
+for (var i = 0; i < 20; i++) {
+    var addTwo = new Function("a", "b", "return a + b;");
+
+    total = addTwo(total, i);
+
+    if (addTwo !== prevFn) {
+        ++distinctCount;
+    }
+
+    prevFn = addTwo;
+}
+
+if (total === 190) {
+    ++ok;
+} else {
+    console.log("Unexpected total from cached snippets: ", total);
+}
+
+if (distinctCount === 20) {
+    ++ok;
+} else {
+    console.log("Cached snippets should still give distinct functions: ", distinctCount);
+}
+
+if (ok === 2) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,29 @@
+// Test the job queue: microtasks run before timers, and timers run by due time after the top-level code.
+
+var order = "";
+
+setTimeout(function () {
+    order = order + "C";
+}, 20);
+
+setTimeout(function () {
+    order = order + "B";
+
+    queueMicrotask(function () {
+        order = order + "b";
+    });
+}, 0);
+
+queueMicrotask(function () {
+    order = order + "A";
+});
+
+order = order + "0";
+
+setTimeout(function () {
+    if (order === "0ABbC") {
+        console.log("PASS");
+    } else {
+        throw new Error("Unexpected job order: " + order);
+    }
+}, 40);
@@ -0,0 +1,50 @@
+/*
+    strings_ropes.js
+    Tests strings built by repeated concatenation & joins, which are read back as lengths, char codes, keys, and slices.
+*/
+
+var ok = 0;
+var line = "";
+
+for (var i = 0; i < 300; i++) {
+    line = line + "ab";
+}
+
+if (line.length === 600 && line.charCodeAt(599) === 98) {
+    ++ok;
+} else {
+    console.log("Unexpected built line, length:", line.length);
+}
+
+var box = {};
+var key_prefix = "lo";
+box[key_prefix + "g"] = 42;
+
+if (box.log === 42) {
+    ++ok;
+} else {
+    console.log("Unexpected box.log:", box.log);
+}
+
+var joined = ["x", line, "y"].join("-");
+
+if (joined.length === 604 && joined.charCodeAt(1) === 45 && joined.substring(602, 604) === "-y") {
+    ++ok;
+} else {
+    console.log("Unexpected joined length:", joined.length);
+}
+
+var token = line.substring(100, 104);
+var padded = ("  " + line + "  ").trim();
+
+if (token === "abab" && token.charCodeAt(0) === 97 && padded.length === 600 && padded.substr(598, 5) === "ab") {
+    ++ok;
+} else {
+    console.log("Unexpected slices:", token, padded.length);
+}
+
+if (ok === 4) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
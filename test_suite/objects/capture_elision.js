@@ -0,0 +1,33 @@
+/*
+    capture_elision.js
+    Tests that closures still see captured outer variables when other locals in the same functions are never captured.
+*/
+
+function outer(n) {
+    var unused = n * 3;
+    var base = n + 1;
+    var inner = function(k) {
+        var scratch = k * 2;
+        return base + scratch - k;
+    };
+
+    return inner(n) + unused - unused;
+}
+
+function plain(a, b) {
+    var sum = a + b;
+    return sum;
+}
+
+var total = 0;
+
+for (var i = 0; i < 100; ++i) {
+    total = total + outer(i) + plain(i, 1);
+}
+
+if (total === 15050) {
+    console.log("PASS");
+} else {
+    console.log("Unexpected total:", total);
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,46 @@
+/*
+    dictionary_props.js
+    Tests an object growing past the dictionary mode threshold: computed keys, reads of early & late keys, and overwrites after the switch.
+*/
+
+var table = {first: 1};
+var key_count = 100;
+
+for (var i = 0; i < key_count; ++i) {
+    table["k" + i] = i * 2;
+}
+
+table.first = 7;
+table["k50"] = -1;
+
+var sum = 0;
+
+for (var j = 0; j < key_count; ++j) {
+    sum = sum + table["k" + j];
+}
+
+var ok = 0;
+
+if (table.first === 7) {
+    ++ok;
+} else {
+    console.log("Unexpected first value:", table.first);
+}
+
+if (sum === 9799) {
+    ++ok;
+} else {
+    console.log("Unexpected sum of values:", sum);
+}
+
+if (table.missing === undefined) {
+    ++ok;
+} else {
+    console.log("Unexpected missing value:", table.missing);
+}
+
+if (ok === 3) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
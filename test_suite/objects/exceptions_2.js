@@ -0,0 +1,69 @@
+// Test handler tables: nested tries, throws across calls, and returns within try blocks
+
+var ok = 0;
+
+function thrower(n) {
+    if (n > 2) {
+        throw new Error("too big");
+    }
+
+    return n;
+}
+
+function earlyReturn() {
+    try {
+        return thrower(1);
+    } catch (err) {
+        return -1;
+    }
+}
+
+function throwsDeep(depth) {
+    if (depth === 0) {
+        return thrower(5);
+    }
+
+    return throwsDeep(depth - 1);
+}
+
+var caught = 0;
+
+for (var i = 0; i < 50; i++) {
+    try {
+        thrower(i);
+    } catch (err) {
+        ++caught;
+    }
+}
+
+if (caught === 47) {
+    ++ok;
+} else {
+    console.log("Unexpected catch count in loop:", caught);
+}
+
+if (earlyReturn() === 1) {
+    ++ok;
+} else {
+    console.log("Unexpected result of return within try");
+}
+
+try {
+    try {
+        thrower(0);
+    } catch (inner) {
+        console.log("Inner catch should not run");
+    }
+
+    throwsDeep(10);
+} catch (outer) {
+    if (outer.message === "too big") {
+        ++ok;
+    }
+}
+
+if (ok === 3) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
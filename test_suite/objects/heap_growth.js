@@ -0,0 +1,22 @@
+/*
+    heap_growth.js
+    Tests that over 4096 objects can be live at once, since the heap grows past its initial slot count.
+*/
+
+var live = [];
+var total = 0;
+
+for (var i = 0; i < 6000; ++i) {
+    live.push({v: 1});
+}
+
+for (var j = 0; j < live.length; ++j) {
+    total = total + live[j].v;
+}
+
+if (total === 6000) {
+    console.log("PASS");
+} else {
+    console.log("Unexpected count of live objects:", total);
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,37 @@
+/*
+    interned_keys.js
+    Tests computed property keys built at runtime against the same keys written as constants.
+*/
+
+var box = {ab: 1};
+var part = "a";
+var built_key = part + "b";
+
+box[built_key] = box[built_key] + 1;
+box[part + "c"] = 10;
+
+var ok = 0;
+
+if (box.ab === 2) {
+    ++ok;
+} else {
+    console.log("Unexpected box.ab:", box.ab);
+}
+
+if (box.ac === 10) {
+    ++ok;
+} else {
+    console.log("Unexpected box.ac:", box.ac);
+}
+
+if (box["a" + "b"] === box.ab) {
+    ++ok;
+} else {
+    console.log("Mismatched computed & constant keys:", box["a" + "b"], box.ab);
+}
+
+if (ok === 3) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,25 @@
+/*
+    interned_keys_sweep.js
+    Tests that keys built at runtime, while GC cycles & their sweeps run, still resolve to the same properties as literal keys.
+*/
+
+var o = {foo: 0, bar: 0};
+var mismatches = 0;
+
+for (var i = 0; i < 20000; ++i) {
+    var junk = {v: i, tag: "junk" + i};
+
+    o["fo" + "o"] = i;
+    o["b" + "ar"] = o.foo;
+
+    if (o.foo !== i || o["ba" + "r"] !== i || o.bar !== o["f" + "oo"]) {
+        ++mismatches;
+    }
+}
+
+if (mismatches === 0 && o.foo === 19999 && o.bar === 19999) {
+    console.log("PASS");
+} else {
+    console.log("Results:", mismatches, o.foo, o.bar);
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,42 @@
+/*
+    nursery_survivors.js
+    Tests that objects kept alive past many nursery collections survive promotion, both when pushed into an older array and when stored as properties.
+*/
+
+var kept = [];
+var holder = {};
+var total = 0;
+
+for (var i = 0; i < 3000; ++i) {
+    var temp = {v: i};
+    void ("tmp" + i);
+
+    if (i % 100 === 0) {
+        kept.push(temp);
+        holder.last = temp;
+    }
+}
+
+for (var j = 0; j < kept.length; ++j) {
+    total = total + kept[j].v;
+}
+
+var ok = 0;
+
+if (total === 43500) {
+    ++ok;
+} else {
+    console.log("Unexpected total of kept values:", total);
+}
+
+if (holder.last.v === 2900) {
+    ++ok;
+} else {
+    console.log("Unexpected last kept value:", holder.last.v);
+}
+
+if (ok === 2) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,70 @@
+/*
+    shape_caches.js
+    Tests property accesses through cached sites: mixed object layouts, prototype hits, and a later own property shadowing a prototype one.
+*/
+
+var Point = function(x, y) {
+    this.x = x;
+    this.y = y;
+
+    return this;
+};
+
+Point.prototype.sum = function() {
+    return this.x + this.y;
+};
+
+function readX(obj) {
+    return obj.x;
+}
+
+var shapes = [
+    {x: 1, y: 2},
+    {y: 2, x: 3},
+    {x: 5},
+    new Point(7, 1),
+    {w: 0, z: 0, x: 9}
+];
+var total = 0;
+
+for (var i = 0; i < 5; ++i) {
+    total = total + readX(shapes[i]);
+}
+
+var p = new Point(2, 3);
+var sums = 0;
+
+for (var j = 0; j < 3; ++j) {
+    sums = sums + p.sum();
+}
+
+p.sum = function() {
+    return 100;
+};
+
+var shadowed = p.sum();
+var ok = 0;
+
+if (total === 25) {
+    ++ok;
+} else {
+    console.log("Unexpected total of x:", total);
+}
+
+if (sums === 15) {
+    ++ok;
+} else {
+    console.log("Unexpected prototype method sums:", sums);
+}
+
+if (shadowed === 100) {
+    ++ok;
+} else {
+    console.log("Unexpected shadowed method result:", shadowed);
+}
+
+if (ok === 3) {
+    console.log("PASS");
+} else {
+    throw new Error("Test failed, see logs.");
+}
@@ -0,0 +1,20 @@
+// Test a loop whose body ends in a lone `if`, whose conditional jump lands right by the loop's backward jump. Run by time slices, the loop must still yield & resume correctly.
+
+var done = false;
+var n = 0;
+var limit = 200000;
+
+while (!done) {
+    n = n + 1;
+
+    if (n > limit) {
+        done = true;
+    }
+}
+
+if (n === limit + 1) {
+    console.log("PASS");
+} else {
+    console.log("Results:", n);
+    throw new Error("Test failed, see logs.");
+}
@@ -3,7 +3,7 @@
 argc=$#
 
 usage_exit() {
-    printf "\033[1;34mUses:\033[0m\\nutility.sh [help | build | unittest | profile | sloc]\\n\\tutility.sh (re)build [debug | profile | release | any-debug | any-profile | any-release] [CMake generator name]\\n\\tutility.sh test\\n\\tutility.sh profile <JS file path>\\n";
+    printf "\033[1;34mUses:\033[0m\\nutility.sh [help | build | unittest | bench | profile | sloc]\\n\\tutility.sh (re)build [debug | profile | release | any-debug | any-profile | any-release] [CMake generator name]\\n\\tutility.sh test\\n\\tutility.sh bench [run_bench.py options e.g --save-baseline, --node]\\n\\tutility.sh profile <JS file path>\\n";
     printf "\033[1;34mUSAGE NOTES:\033[0m\\n\\tany-* build modes are for compiler-platform setups that are outside Homebrew Clang on macOS.\\n\\tOn Linux platforms, try getting the latest version of GCC / Clang for a better chance of C++ modules and TCO working.\\n";
     exit "$1";
 }
@@ -27,6 +27,9 @@ elif [[ $action = "rebuild" && $argc -eq 3 ]]; then
     cmake --fresh -S . -B build --preset "local-$2-build" -G "$3" && cmake --build build && mv ./build/compile_commands.json .;
 elif [[ $action = "test" ]]; then
     python3 ./utility/run_suite.py
+elif [[ $action = "bench" ]]; then
+    shift;
+    python3 ./utility/run_bench.py "$@";
 elif [[ $action = "profile" && $argc -eq 2 ]]; then
     samply record --save-only -o prof_tco.json -- ./build/derkjs_tco -r "$2";
 elif [[ $action = "sloc" ]]; then
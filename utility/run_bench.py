@@ -0,0 +1,140 @@
+"""
+    run_bench.py
+    By: DrkWithT
+
+    Runs the benchmark workloads with warmups & repeated trials, printing JSON results. Each workload prints `BENCH_MS <elapsed ms>` for just its timed part, so startup & compile times are left out.
+    Results can be saved as a baseline, and later runs fail if any workload's median is slower than the baseline's by more than the tolerance.
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+DERKJS_BENCH_DIR = os.path.relpath('./test_suite/benchmarks/suite')
+DERKJS_BENCH_BASELINE = os.path.relpath('./test_suite/benchmarks/baseline.json')
+DERKJS_BENCH_EXE = './build/derkjs_tco'
+DERKJS_BENCH_WARMUPS = 1
+DERKJS_BENCH_TRIALS = 5
+DERKJS_BENCH_TOLERANCE = 0.10
+DERKJS_BENCH_NOISE_FLOOR_MS = 1.0 # timings under this are clamped, since `Date.now()` may only tick by whole milliseconds
+
+def get_bench_names(bench_path: str = DERKJS_BENCH_DIR) -> list[str]:
+    return sorted(
+        bench_filename
+        for bench_filename
+        in os.listdir(bench_path)
+        if bench_filename.endswith('.js')
+    )
+
+def time_bench_once(engine_cmd: list[str], bench_file_path: str) -> float | None:
+    bench_proc = subprocess.run(engine_cmd + [bench_file_path], capture_output=True, text=True)
+
+    if bench_proc.returncode != 0:
+        print(f'Bench \x1b[1;33m{bench_file_path}\x1b[0m failed:\n{bench_proc.stderr}', file=sys.stderr)
+        return None
+
+    for output_line in reversed(bench_proc.stdout.splitlines()):
+        if output_line.startswith('BENCH_MS'):
+            return float(output_line.split()[1])
+
+    print(f'Bench \x1b[1;33m{bench_file_path}\x1b[0m printed no BENCH_MS line.', file=sys.stderr)
+    return None
+
+def run_bench(engine_cmd: list[str], bench_file_path: str, warmups: int, trials: int) -> dict | None:
+    for _ in range(warmups):
+        if time_bench_once(engine_cmd, bench_file_path) is None:
+            return None
+
+    samples = []
+
+    for _ in range(trials):
+        sample_ms = time_bench_once(engine_cmd, bench_file_path)
+
+        if sample_ms is None:
+            return None
+
+        samples.append(sample_ms)
+
+    return {
+        'median_ms': statistics.median(samples),
+        'min_ms': min(samples),
+        'mean_ms': statistics.fmean(samples),
+        'samples_ms': samples
+    }
+
+def run_engine(engine_cmd: list[str], bench_names: list[str], warmups: int, trials: int) -> dict:
+    return {
+        bench_name: run_bench(engine_cmd, f'{DERKJS_BENCH_DIR}/{bench_name}', warmups, trials)
+        for bench_name
+        in bench_names
+    }
+
+def compare_to_baseline(results: dict, baseline: dict, tolerance: float) -> list[str]:
+    regressions = []
+
+    for bench_name, baseline_stats in baseline.get('derkjs', {}).items():
+        current_stats = results.get(bench_name)
+
+        if not baseline_stats or not current_stats:
+            continue
+
+        ratio = max(current_stats['median_ms'], DERKJS_BENCH_NOISE_FLOOR_MS) / max(baseline_stats['median_ms'], DERKJS_BENCH_NOISE_FLOOR_MS)
+        current_stats['vs_baseline'] = ratio
+
+        if ratio > 1.0 + tolerance:
+            regressions.append(f'{bench_name}: {ratio:.2f}x the baseline median')
+
+    return regressions
+
+if __name__ == '__main__':
+    arg_parser = argparse.ArgumentParser(description='Runs the DerkJS benchmark workloads.')
+    arg_parser.add_argument('--derkjs', default=DERKJS_BENCH_EXE, help='path to the derkjs_tco executable')
+    arg_parser.add_argument('--warmups', type=int, default=DERKJS_BENCH_WARMUPS)
+    arg_parser.add_argument('--trials', type=int, default=DERKJS_BENCH_TRIALS)
+    arg_parser.add_argument('--baseline', default=DERKJS_BENCH_BASELINE, help='baseline JSON to compare against, if it exists')
+    arg_parser.add_argument('--save-baseline', action='store_true', help='overwrite the baseline with these results')
+    arg_parser.add_argument('--tolerance', type=float, default=DERKJS_BENCH_TOLERANCE, help='allowed slowdown ratio over the baseline')
+    arg_parser.add_argument('--node', action='store_true', help='also time `node --jitless` on the same workloads')
+    arg_parser.add_argument('--output', default='', help='also write the JSON results here')
+    args = arg_parser.parse_args()
+
+    if not os.path.exists(args.derkjs):
+        print(f'The executable \x1b[1;33m{args.derkjs}\x1b[0m is missing, please build it first.', file=sys.stderr)
+        exit(1)
+
+    bench_names = get_bench_names()
+    report = {
+        'warmups': args.warmups,
+        'trials': args.trials,
+        'derkjs': run_engine([args.derkjs, '-r'], bench_names, args.warmups, args.trials)
+    }
+
+    if args.node:
+        report['node_jitless'] = run_engine(['node', '--jitless'], bench_names, args.warmups, args.trials)
+
+    failed_benches = [bench_name for bench_name, bench_stats in report['derkjs'].items() if bench_stats is None]
+    regressions = []
+
+    if args.save_baseline:
+        with open(args.baseline, 'w') as baseline_file:
+            json.dump({'derkjs': report['derkjs']}, baseline_file, indent=4)
+    elif os.path.exists(args.baseline):
+        with open(args.baseline) as baseline_file:
+            regressions = compare_to_baseline(report['derkjs'], json.load(baseline_file), args.tolerance)
+    else:
+        print(f'NOTE: no baseline at {args.baseline}, so run with --save-baseline to make one.', file=sys.stderr)
+
+    report_json = json.dumps(report, indent=4)
+    print(report_json)
+
+    if args.output:
+        with open(args.output, 'w') as output_file:
+            output_file.write(report_json)
+
+    for regression in regressions:
+        print(f'\x1b[1;31mREGRESSION\x1b[0m {regression}', file=sys.stderr)
+
+    exit(0 if not failed_benches and not regressions else 1)
@@ -4,11 +4,25 @@
 """
 
 import os
+import struct
 import subprocess
+import tempfile
 
 DERKJS_TEST_SUITE_DIR = os.path.relpath('./test_suite')
 DERKJS_TEST_SUITE_GROUPS = ['basic', 'objects', 'builtins'] # TODO add 'objects' and 'builtins'
+DERKJS_TEST_SLICED_GROUP = 'sliced' # run together as time-sliced isolates
 DERKJS_TEST_PROCESS_COUNT = 4;
+DERKJS_TEST_CACHE_SCRIPT = f'{DERKJS_TEST_SUITE_DIR}/basic/lambda_1.js' # compiled to a cache, then corrupted
+
+# Bytecode cache layout, see ./src/derkjs_impl/backend/bc_cache.ixx
+CACHE_HEADER_FMT = '<4sHHHHiiIIIhh'
+CACHE_ITEM_FMT = '<BiiiiI'
+CACHE_ITEM_LAMBDA = 2
+CACHE_ITEM_STRING = 0
+CACHED_VALUE_SIZE = 10
+CACHED_HANDLER_SIZE = 12
+INSTRUCTION_SIZE = 6
+INSTRUCTION_OPCODE_POS = 4
 
 def get_test_names(test_suite_path: str = DERKJS_TEST_SUITE_DIR, folders: list[str] = DERKJS_TEST_SUITE_GROUPS) -> list[str]:
     all_test_names = []
@@ -49,6 +63,66 @@ def run_tests_by_n(test_file_paths: list[str], worker_count: int = DERKJS_TEST_P
 
     return (total_passed, total_tests - total_passed, total_tests)   
 
+def run_sliced_tests(test_file_paths: list[str]):
+    if not test_file_paths:
+        return (0, 0, 0)
+
+    sliced_passed = subprocess.run(['./build/derkjs_tco', '-m'] + test_file_paths).returncode == 0
+    sliced_verdict = '\x1b[1;32mPASS' if sliced_passed else '\x1b[1;31mFAIL'
+
+    for test_path in test_file_paths:
+        print(f'Test \x1b[1;33m{test_path}\x1b[0m (sliced):  {sliced_verdict}\x1b[0m')
+
+    return (len(test_file_paths), 0, len(test_file_paths)) if sliced_passed else (0, len(test_file_paths), len(test_file_paths))
+
+def find_top_level_code(cache_bytes: bytes) -> int:
+    """Walks a bytecode cache up to its top-level code, giving the code's position."""
+    (_, _, _, _, builtin_count, _, item_count, const_count, _, offset_count, _, _) = struct.unpack_from(CACHE_HEADER_FMT, cache_bytes)
+    pos = struct.calcsize(CACHE_HEADER_FMT)
+
+    for _ in range(item_count):
+        (item_kind, _, _, _, _, data_length) = struct.unpack_from(CACHE_ITEM_FMT, cache_bytes, pos)
+        pos += struct.calcsize(CACHE_ITEM_FMT)
+
+        if item_kind == CACHE_ITEM_LAMBDA:
+            pos += data_length * INSTRUCTION_SIZE
+            (handler_count,) = struct.unpack_from('<I', cache_bytes, pos)
+            pos += 4 + handler_count * CACHED_HANDLER_SIZE
+        elif item_kind == CACHE_ITEM_STRING:
+            pos += data_length
+
+    return pos + builtin_count * 4 + const_count * CACHED_VALUE_SIZE + offset_count * 4
+
+def run_cache_tests(script_path: str = DERKJS_TEST_CACHE_SCRIPT):
+    """Checks that a bytecode cache runs, and that the same cache with an unknown opcode is rejected on loading instead of run."""
+    with tempfile.TemporaryDirectory() as temp_dir:
+        cache_path = f'{temp_dir}/test.djsc'
+        bad_cache_path = f'{temp_dir}/bad_opcode.djsc'
+
+        if subprocess.run(['./build/derkjs_tco', '-c', script_path, cache_path]).returncode != 0:
+            print(f'Test \x1b[1;33m{script_path}\x1b[0m (cache):  \x1b[1;31mFAIL\x1b[0m')
+            return (0, 2, 2)
+
+        with open(cache_path, 'rb') as cache_file:
+            cache_bytes = bytearray(cache_file.read())
+
+        cache_bytes[find_top_level_code(cache_bytes) + INSTRUCTION_OPCODE_POS] = 0xff
+
+        with open(bad_cache_path, 'wb') as bad_cache_file:
+            bad_cache_file.write(cache_bytes)
+
+        cache_passed = subprocess.run(['./build/derkjs_tco', '-b', cache_path]).returncode == 0
+        bad_run = subprocess.run(['./build/derkjs_tco', '-b', bad_cache_path], capture_output=True, text=True)
+        bad_cache_passed = bad_run.returncode == 1 and 'bad instruction' in bad_run.stderr
+
+    for test_name, test_passed in ((f'{script_path} (cache)', cache_passed), (f'{script_path} (bad opcode cache)', bad_cache_passed)):
+        test_verdict = '\x1b[1;32mPASS' if test_passed else '\x1b[1;31mFAIL'
+        print(f'Test \x1b[1;33m{test_name}\x1b[0m:  {test_verdict}\x1b[0m')
+
+    cache_pass_count = int(cache_passed) + int(bad_cache_passed)
+
+    return (cache_pass_count, 2 - cache_pass_count, 2)
+
 if __name__ == '__main__':
     if not os.path.exists("./build/derkjs_tco"):
         print(f'The executable \x1b[1;33m./build/derkjs_tco\x1b[0m is missing, please build it first.')
@@ -57,6 +131,17 @@ if __name__ == '__main__':
     pass_count, fail_count, test_count = run_tests_by_n(
         get_test_names()
     )
+    sliced_pass_count, sliced_fail_count, sliced_test_count = run_sliced_tests(
+        get_test_names(folders=[DERKJS_TEST_SLICED_GROUP])
+    )
+    pass_count += sliced_pass_count
+    fail_count += sliced_fail_count
+    test_count += sliced_test_count
+
+    cache_pass_count, cache_fail_count, cache_test_count = run_cache_tests()
+    pass_count += cache_pass_count
+    fail_count += cache_fail_count
+    test_count += cache_test_count
 
     print(f'\nTEST REPORT:\n\x1b[1;34mPASSED:\x1b[0m {pass_count}/{test_count}\n\x1b[1;34mFAILED:\x1b[0m {fail_count}/{test_count}')
 